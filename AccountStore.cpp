@@ -0,0 +1,308 @@
+#include "AccountStore.h"
+#include <cstdio>
+#include <cstring>
+#include "PersistenceWorker.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+const char STORE_MAGIC[8] = { 'X', 'O', 'N', 'I', 'X', 'A', 'C', 'C' };
+
+struct AccountStore::Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint32_t nextId;
+    uint32_t indexSize;     // power of two
+    uint64_t recordsOffset;
+    uint64_t indexOffset;
+    uint64_t heapOffset;
+    uint64_t heapSize;
+    uint8_t reserved[8];
+};
+
+struct AccountStore::Record
+{
+    int32_t id;
+    int32_t topScore;
+    int32_t totalScore;
+    uint32_t hash;
+    uint32_t nameOffset;        // into the heap
+    uint32_t passwordOffset;
+    uint16_t nameLength;
+    uint16_t passwordLength;
+    uint32_t reserved;
+};
+
+static char lowerChar(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+uint32_t hashUsername(string_view name)
+{
+    uint32_t h = 2166136261u;
+    for (char c : name)
+    {
+        h ^= (unsigned char)lowerChar(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+bool sameUsername(string_view a, string_view b)
+{
+    if (a.length() != b.length())
+        return false;
+    for (size_t i = 0; i < a.length(); i++)
+        if (lowerChar(a[i]) != lowerChar(b[i]))
+            return false;
+    return true;
+}
+
+// -------------------------------------------------------------
+// OPEN / CLOSE
+// -------------------------------------------------------------
+bool AccountStore::open(const string& path)
+{
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart >= (LONGLONG)sizeof(Header))
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    size = (size_t)fileSize.QuadPart;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(Header))
+    {
+        void* mapped = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+            data = (const char*)mapped;
+            size = (size_t)st.st_size;
+        }
+    }
+    ::close(fd);    // the mapping keeps the file alive
+#endif
+    if (!data)
+    {
+        close();
+        return false;
+    }
+
+    // Only the header is read; every section must lie inside the file
+    const Header* h = (const Header*)data;
+    uint64_t recordsEnd = h->recordsOffset + (uint64_t)h->count * sizeof(Record);
+    uint64_t indexEnd = h->indexOffset + (uint64_t)h->indexSize * sizeof(uint32_t);
+    bool valid = memcmp(h->magic, STORE_MAGIC, sizeof(STORE_MAGIC)) == 0
+        && h->version == FORMAT_VERSION
+        && h->indexSize > h->count && (h->indexSize & (h->indexSize - 1)) == 0
+        && h->recordsOffset % alignof(Record) == 0 && h->indexOffset % alignof(uint32_t) == 0
+        && recordsEnd <= size && indexEnd <= size && h->heapOffset + h->heapSize <= size;
+    if (!valid)
+    {
+        close();
+        return false;
+    }
+    header = h;
+    records = (const Record*)(data + h->recordsOffset);
+    index = (const uint32_t*)(data + h->indexOffset);
+    heap = data + h->heapOffset;
+    return true;
+}
+
+void AccountStore::close()
+{
+#ifdef _WIN32
+    if (data)
+        UnmapViewOfFile(data);
+    if (mappingHandle)
+        CloseHandle((HANDLE)mappingHandle);
+    if (fileHandle)
+        CloseHandle((HANDLE)fileHandle);
+    fileHandle = mappingHandle = nullptr;
+#else
+    if (data)
+        munmap((void*)data, size);
+#endif
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+    records = nullptr;
+    index = nullptr;
+    heap = nullptr;
+}
+
+// -------------------------------------------------------------
+// LOOKUPS
+// -------------------------------------------------------------
+int AccountStore::count() const
+{
+    return header ? (int)header->count : 0;
+}
+
+int AccountStore::nextId() const
+{
+    return header ? (int)header->nextId : 1;
+}
+
+int AccountStore::find(string_view username) const
+{
+    if (!header)
+        return -1;
+    uint32_t hash = hashUsername(username);
+    uint32_t mask = header->indexSize - 1;
+    uint32_t i = hash & mask;
+    for (uint32_t probe = 0; probe < header->indexSize; probe++, i = (i + 1) & mask)
+    {
+        uint32_t entry = index[i];
+        if (entry == 0 || entry > header->count)
+            return -1;
+        int record = (int)entry - 1;
+        if (records[record].hash == hash && sameUsername(this->username(record), username))
+            return record;
+    }
+    return -1;
+}
+
+int AccountStore::id(int record) const
+{
+    return records[record].id;
+}
+
+int AccountStore::topScore(int record) const
+{
+    return records[record].topScore;
+}
+
+int AccountStore::totalScore(int record) const
+{
+    return records[record].totalScore;
+}
+
+// Heap positions are checked here rather than at open(), which must not
+// walk every record
+string_view AccountStore::username(int record) const
+{
+    const Record& r = records[record];
+    if ((uint64_t)r.nameOffset + r.nameLength > header->heapSize)
+        return string_view();
+    return string_view(heap + r.nameOffset, r.nameLength);
+}
+
+string_view AccountStore::password(int record) const
+{
+    const Record& r = records[record];
+    if ((uint64_t)r.passwordOffset + r.passwordLength > header->heapSize)
+        return string_view();
+    return string_view(heap + r.passwordOffset, r.passwordLength);
+}
+
+Player AccountStore::player(int record) const
+{
+    Player p;
+    p.id = id(record);
+    p.username = string(username(record));
+    p.password = string(password(record));
+    p.topScore = topScore(record);
+    p.totalScore = totalScore(record);
+    return p;
+}
+
+// -------------------------------------------------------------
+// WRITING
+// -------------------------------------------------------------
+bool AccountStore::build(const vector<Player>& players, int nextId, string& image)
+{
+    static_assert(sizeof(Header) == 64, "store header layout changed");
+    static_assert(sizeof(Record) == 32, "store record layout changed");
+
+    Header h = {};
+    memcpy(h.magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+    h.version = FORMAT_VERSION;
+    h.count = (uint32_t)players.size();
+    h.nextId = (uint32_t)nextId;
+    h.indexSize = 64;
+    while (h.indexSize < h.count * 2 + 1)
+        h.indexSize *= 2;
+
+    vector<Record> recs(players.size());
+    vector<uint32_t> table(h.indexSize, 0);
+    string heapBytes;
+    for (size_t i = 0; i < players.size(); i++)
+    {
+        const Player& p = players[i];
+        if (p.username.size() > 0xFFFF || p.password.size() > 0xFFFF || heapBytes.size() > 0xFFFFFFFFull - 0x20000)
+            return false;
+        Record& r = recs[i];
+        r.id = p.id;
+        r.topScore = p.topScore;
+        r.totalScore = p.totalScore;
+        r.hash = hashUsername(p.username);
+        r.nameOffset = (uint32_t)heapBytes.size();
+        r.nameLength = (uint16_t)p.username.size();
+        heapBytes += p.username;
+        r.passwordOffset = (uint32_t)heapBytes.size();
+        r.passwordLength = (uint16_t)p.password.size();
+        heapBytes += p.password;
+        r.reserved = 0;
+
+        uint32_t mask = h.indexSize - 1;
+        uint32_t slot = r.hash & mask;
+        while (table[slot] != 0)
+            slot = (slot + 1) & mask;
+        table[slot] = (uint32_t)i + 1;
+    }
+    h.recordsOffset = sizeof(Header);
+    h.indexOffset = h.recordsOffset + recs.size() * sizeof(Record);
+    h.heapOffset = h.indexOffset + table.size() * sizeof(uint32_t);
+    h.heapSize = heapBytes.size();
+
+    image.clear();
+    image.reserve(h.heapOffset + h.heapSize);
+    image.append((const char*)&h, sizeof(h));
+    image.append((const char*)recs.data(), recs.size() * sizeof(Record));
+    image.append((const char*)table.data(), table.size() * sizeof(uint32_t));
+    image += heapBytes;
+    return true;
+}
+
+bool AccountStore::write(const string& path, const vector<Player>& players, int nextId)
+{
+    string image;
+    if (!build(players, nextId, image))
+        return false;
+
+    // On disk, not just handed to the OS, before anyone renames it into place
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f)
+        return false;
+    bool ok = fwrite(image.data(), 1, image.size(), f) == image.size();
+    syncFile(f);
+    return fclose(f) == 0 && ok;
+}
@@ -0,0 +1,96 @@
+// --- BINARY ACCOUNT STORE: MEMORY-MAPPED PLAYER RECORDS USED IN PLACE ---
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// -------------------------------------------------------------
+// PLAYER AUTH
+// -------------------------------------------------------------
+struct Player
+{
+    int id;
+    std::string username, password;
+    int topScore = 0;       // best single-player score
+    int totalScore = 0;     // best multiplayer score
+};
+
+// Usernames compare case-insensitively; the hash is FNV-1a over the
+// lower-cased name so "Ali" and "ali" share a bucket
+uint32_t hashUsername(std::string_view name);
+bool sameUsername(std::string_view a, std::string_view b);
+
+// For hash containers keyed by username
+struct UsernameHash
+{
+    size_t operator()(const std::string& name) const { return hashUsername(name); }
+};
+struct UsernameEqual
+{
+    bool operator()(const std::string& a, const std::string& b) const { return sameUsername(a, b); }
+};
+
+// -------------------------------------------------------------
+// ACCOUNT STORE
+// -------------------------------------------------------------
+// Read-only view of a players.dat file. The file is mapped, not parsed:
+//
+//   header    magic, version, counts and section offsets
+//   records   fixed-width id / scores / name and password positions
+//   index     open-addressing table, record number + 1 (0 = empty)
+//   heap      username and password bytes
+//
+// Opening only checks the header, so it costs the same for ten players
+// as for ten million; a lookup touches one index and one record page.
+// Numbers are stored little-endian, as every supported target is.
+class AccountStore
+{
+public:
+    static const uint32_t FORMAT_VERSION = 1;
+
+    AccountStore() = default;
+    ~AccountStore() { close(); }
+    AccountStore(const AccountStore&) = delete;
+    AccountStore& operator=(const AccountStore&) = delete;
+
+    // False when the file is missing or isn't a store of this version
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    int count() const;
+    int nextId() const;
+
+    // Record number, or -1
+    int find(std::string_view username) const;
+
+    int id(int record) const;
+    int topScore(int record) const;
+    int totalScore(int record) const;
+    std::string_view username(int record) const;
+    std::string_view password(int record) const;
+    Player player(int record) const;
+
+    // The bytes of a new store; fails on names or passwords over 65535 bytes
+    static bool build(const std::vector<Player>& players, int nextId, std::string& image);
+    // Builds a new store, writes it and fsyncs it
+    static bool write(const std::string& path, const std::vector<Player>& players, int nextId);
+
+private:
+    struct Header;
+    struct Record;
+
+    const char* data = nullptr;
+    size_t size = 0;
+    const Header* header = nullptr;
+    const Record* records = nullptr;
+    const uint32_t* index = nullptr;
+    const char* heap = nullptr;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,535 @@
+#include "AuthManager.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+using namespace std;
+
+const size_t MIN_INDEX_SIZE = 64;
+const int COMPACT_MIN_RECORDS = 4096;  // never compact a journal shorter than this
+
+static string journalFile(const string& file)
+{
+    return file + ".journal";
+}
+
+AuthManager::AuthManager(const string& file, const string& legacyCsv)
+    : file(file), legacyCsv(legacyCsv)
+{
+    rebuildIndex(MIN_INDEX_SIZE);
+    load();
+}
+
+AuthManager::~AuthManager()
+{
+    sync();
+    if (journal)
+        fclose(journal);
+    if (persistence)
+        persistence->flush();
+}
+
+void AuthManager::setPersistence(PersistenceWorker* worker)
+{
+    if (persistence)
+    {
+        // A compaction the old worker wrote is finished through it
+        persistence->flush();
+        update();
+        persistence->flush();
+    }
+    persistence = worker;
+
+    // Exactly one of the worker and our own handle writes the journal
+    if (journal)
+    {
+        fclose(journal);
+        journal = nullptr;
+    }
+    if (!persistence && writable)
+        journal = fopen(journalFile(file).c_str(), "ab");
+}
+
+void AuthManager::load()
+{
+    if (file.empty())
+        return;
+
+    int imported = 0;
+    if (!store.open(file))
+    {
+        // Something that isn't a store of this version is left untouched:
+        // without a journal nothing is ever written over it
+        if (ifstream(file).is_open())
+            return;
+        if (!legacyCsv.empty())
+            imported = readCsv(legacyCsv);
+    }
+    nextID = max(nextID, store.nextId());
+    writable = true;
+
+    replayJournal();
+    if (imported > 0 || journalFull())
+        compact();
+    else if (!journal)
+        journal = fopen(journalFile(file).c_str(), "ab");
+}
+
+void AuthManager::compact()
+{
+    if (!writable || compacting)
+        return;
+
+#ifndef _WIN32
+    if (persistence)
+    {
+        // Only the overlay is copied here. The worker merges it with the old
+        // snapshot, which stays mapped and unchanged until update(), then
+        // builds, writes, syncs and renames the new one.
+        compacting = true;
+        compaction = COMPACTION_RUNNING;
+        sinceCompaction.clear();
+        const AccountStore* old = &store;
+        int next = nextID;
+        persistence->buildFile(file, [old, overlay = players, table = index, next](string& image)
+        {
+            return AccountStore::build(mergePlayers(*old, overlay, table), next, image);
+        }, true, [this](bool written)
+        {
+            compaction = written ? COMPACTION_WRITTEN : COMPACTION_FAILED;
+        });
+        return;
+    }
+#endif
+
+    // Records still queued must land before the journal is emptied
+    if (persistence)
+        persistence->flush();
+
+    // Write the new snapshot beside the old one and swap it in, so a crash
+    // leaves either the old snapshot plus journal or the new snapshot. Both
+    // the file and the rename are synced before the journal is emptied, or a
+    // crash could keep the empty journal and lose the snapshot it replaced.
+    string tmpFile = file + ".tmp";
+    if (!AccountStore::write(tmpFile, allPlayers(), nextID))
+        return;
+    store.close();
+#ifdef _WIN32
+    remove(file.c_str());
+#endif
+    bool renamed = rename(tmpFile.c_str(), file.c_str()) == 0;
+    store.open(file);
+    if (!renamed)
+        return;
+    syncDirectoryOf(file);
+    clearOverlay();
+
+    // Every journal record is idempotent, so replaying a journal that a
+    // crash left behind after the rename does no harm
+    if (journal)
+        fclose(journal);
+    journal = nullptr;
+    if (persistence)
+        persistence->writeFile(journalFile(file), "");
+    else
+        journal = fopen(journalFile(file).c_str(), "wb");
+    journalRecords = 0;
+    unsynced = 0;
+}
+
+void AuthManager::update()
+{
+    if (!compacting || compaction == COMPACTION_RUNNING)
+        return;
+    compacting = false;
+    string since = move(sinceCompaction);
+    sinceCompaction.clear();
+    if (compaction == COMPACTION_FAILED)
+        return;     // the old snapshot and the whole journal still stand
+
+    // The new snapshot has everything up to compact(); only the records
+    // since then stay in the overlay and in the journal. The worker writes
+    // the shorter journal after the snapshot is in place, and any append
+    // still queued for the old one is among these records.
+    store.close();
+    store.open(file);
+    clearOverlay();
+    journalRecords = replayRecords(since);
+    persistence->writeFile(journalFile(file), move(since), true);
+}
+
+void AuthManager::clearOverlay()
+{
+    players.clear();
+    index.assign(MIN_INDEX_SIZE, IndexEntry{ 0, -1 });
+    newPlayers = 0;
+}
+
+// -------------------------------------------------------------
+// CSV IMPORT / EXPORT
+// -------------------------------------------------------------
+int AuthManager::importCsv(const string& path)
+{
+    int added = readCsv(path);
+    if (added > 0)
+        compact();
+    return added;
+}
+
+int AuthManager::readCsv(const string& path)
+{
+    ifstream f(path);
+    string line;
+    int added = 0;
+    while (getline(f, line))
+        added += loadPlayerRow(line);
+    return added;
+}
+
+bool AuthManager::exportCsv(const string& path) const
+{
+    ofstream f(path, ios::trunc);
+    for (const Player& p : allPlayers())
+        f << p.id << "," << p.username << "," << p.password << "," << p.topScore << "," << p.totalScore << "\n";
+    f.flush();
+    return (bool)f;
+}
+
+// One CSV row; rows for names already known are ignored
+bool AuthManager::loadPlayerRow(const string& row)
+{
+    if (row.empty())
+        return false;
+    Player p;
+    istringstream iss(row);
+    char delim;
+    iss >> p.id >> delim;
+    getline(iss, p.username, ',');
+    getline(iss, p.password, ',');
+    string scoreStr;
+    if (getline(iss, scoreStr, ','))
+        p.topScore = p.totalScore = atoi(scoreStr.c_str());
+    if (getline(iss, scoreStr))
+        p.totalScore = atoi(scoreStr.c_str());
+    if (p.username.empty() || exists(p.username))
+        return false;
+    addPlayer(p);
+    newPlayers++;
+    nextID = max(nextID, p.id + 1);
+    return true;
+}
+
+// -------------------------------------------------------------
+// JOURNAL
+// -------------------------------------------------------------
+// One record per line:
+//   R,id,username,password     registration
+//   T,username,score           new top score
+//   S,username,score           new total score
+// A line cut short by a crash has no newline and is dropped on replay.
+void AuthManager::replayJournal()
+{
+    ifstream f(journalFile(file), ios::binary);
+    if (!f.is_open())
+        return;
+    string contents((istreambuf_iterator<char>(f)), istreambuf_iterator<char>());
+    journalRecords += replayRecords(contents);
+}
+
+// Applies every complete line; returns how many there were
+int AuthManager::replayRecords(const string& contents)
+{
+    int records = 0;
+    size_t start = 0;
+    for (size_t end = contents.find('\n'); end != string::npos; end = contents.find('\n', start))
+    {
+        applyRecord(contents.substr(start, end - start));
+        records++;
+        start = end + 1;
+    }
+    return records;
+}
+
+void AuthManager::applyRecord(const string& record)
+{
+    if (record.size() < 2 || record[1] != ',')
+        return;
+    if (record[0] == 'R')
+    {
+        loadPlayerRow(record.substr(2));
+        return;
+    }
+    size_t comma = record.rfind(',');
+    int slot = editableSlot(record.substr(2, comma - 2));
+    if (slot < 0)
+        return;
+    int score = atoi(record.c_str() + comma + 1);
+    if (record[0] == 'T')
+        players[slot].topScore = score;
+    else if (record[0] == 'S')
+        players[slot].totalScore = score;
+}
+
+void AuthManager::appendRecord(const string& record)
+{
+    update();
+    if (persistence && writable)
+    {
+        persistence->appendFile(journalFile(file), record + "\n");
+        if (compacting)
+            sinceCompaction += record + "\n";
+    }
+    else if (journal)
+    {
+        fputs(record.c_str(), journal);
+        fputc('\n', journal);
+        fflush(journal);
+    }
+    else
+        return;
+    journalRecords++;
+    unsynced++;
+    if (syncEvery > 0 && unsynced >= syncEvery)
+        sync();
+    if (journalFull())
+        compact();
+}
+
+// Compacting once the journal is longer than the snapshot keeps the
+// rewrite cost amortized to O(1) per record
+bool AuthManager::journalFull() const
+{
+    return journalRecords > max(COMPACT_MIN_RECORDS, playerCount());
+}
+
+void AuthManager::sync()
+{
+    if (unsynced == 0)
+        return;
+    if (persistence && writable)
+    {
+        persistence->appendFile(journalFile(file), "", true);
+        unsynced = 0;
+        return;
+    }
+    if (!journal)
+        return;
+    syncFile(journal);
+    unsynced = 0;
+}
+
+bool AuthManager::registerPlayer(const string& u, const string& p, string& msg)
+{
+    if (u.length() < 3)
+    {
+        msg = "Username too short";
+        return false;
+    }
+    if (p.length() < 6)
+    {
+        msg = "Password too short";
+        return false;
+    }
+    if (exists(u))
+    {
+        msg = "Username exists";
+        return false;
+    }
+    Player pl;
+    pl.id = nextID++;
+    pl.username = u;
+    pl.password = p;
+    addPlayer(pl);
+    newPlayers++;
+    appendRecord("R," + to_string(pl.id) + "," + pl.username + "," + pl.password);
+    return true;
+}
+
+bool AuthManager::loginPlayer(const string& u, const string& p, string& msg) const
+{
+    int slot = findSlot(u);
+    int record = slot < 0 ? store.find(u) : -1;
+    if (slot < 0 && record < 0)
+    {
+        msg = "User not found";
+        return false;
+    }
+    if (slot >= 0 ? players[slot].password == p : store.password(record) == p)
+        return true;
+    msg = "Wrong password";
+    return false;
+}
+
+int AuthManager::getPlayerTopScore(const string& username) const
+{
+    int slot = findSlot(username);
+    if (slot >= 0)
+        return players[slot].topScore;
+    int record = store.find(username);
+    return record >= 0 ? store.topScore(record) : 0;
+}
+
+void AuthManager::updatePlayerTopScore(const string& username, int newScore)
+{
+    if (newScore <= getPlayerTopScore(username))
+        return;
+    int slot = editableSlot(username);
+    if (slot >= 0)
+    {
+        players[slot].topScore = newScore;
+        appendRecord("T," + players[slot].username + "," + to_string(newScore));
+    }
+}
+
+int AuthManager::getPlayerScore(const string& username) const
+{
+    int slot = findSlot(username);
+    if (slot >= 0)
+        return players[slot].totalScore;
+    int record = store.find(username);
+    return record >= 0 ? store.totalScore(record) : 0;
+}
+
+void AuthManager::updatePlayerScore(const string& username, int newScore)
+{
+    if (newScore <= getPlayerScore(username))
+        return;
+    int slot = editableSlot(username);
+    if (slot >= 0)
+    {
+        players[slot].totalScore = newScore;
+        appendRecord("S," + players[slot].username + "," + to_string(newScore));
+    }
+}
+
+bool AuthManager::findPlayer(const string& username, Player& out) const
+{
+    int slot = findSlot(username);
+    if (slot >= 0)
+    {
+        out = players[slot];
+        return true;
+    }
+    int record = store.find(username);
+    if (record < 0)
+        return false;
+    out = store.player(record);
+    return true;
+}
+
+void AuthManager::forEachPlayer(const function<void(const Player&)>& visit) const
+{
+    for (const Player& p : allPlayers())
+        visit(p);
+}
+
+void AuthManager::reserve(int expectedPlayers)
+{
+    players.reserve(expectedPlayers);
+    size_t tableSize = index.size();
+    while (tableSize < (size_t)expectedPlayers * 2)
+        tableSize *= 2;
+    if (tableSize != index.size())
+        rebuildIndex(tableSize);
+}
+
+// -------------------------------------------------------------
+// USERNAME INDEX
+// -------------------------------------------------------------
+int AuthManager::findSlot(string_view username) const
+{
+    return findSlotIn(players, index, username);
+}
+
+int AuthManager::findSlotIn(const vector<Player>& overlay, const vector<IndexEntry>& index, string_view username)
+{
+    uint32_t hash = hashUsername(username);
+    size_t mask = index.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask)
+    {
+        const IndexEntry& entry = index[i];
+        if (entry.slot < 0)
+            return -1;
+        if (entry.hash == hash && sameUsername(overlay[entry.slot].username, username))
+            return entry.slot;
+    }
+}
+
+bool AuthManager::exists(string_view username) const
+{
+    return findSlot(username) >= 0 || store.find(username) >= 0;
+}
+
+// Overlay slot for a player, copying a stored one in on first change
+int AuthManager::editableSlot(string_view username)
+{
+    int slot = findSlot(username);
+    if (slot >= 0)
+        return slot;
+    int record = store.find(username);
+    if (record < 0)
+        return -1;
+    addPlayer(store.player(record));
+    return (int)players.size() - 1;
+}
+
+// Stored players in record order, overlay copies replacing their originals,
+// then the players registered since
+vector<Player> AuthManager::allPlayers() const
+{
+    return mergePlayers(store, players, index);
+}
+
+// Stored players in store order, overlay copies in place of the originals,
+// then the overlay's new players. Static, so a compaction can run it on the
+// worker over a copy of the overlay.
+vector<Player> AuthManager::mergePlayers(const AccountStore& store, const vector<Player>& overlay,
+                                         const vector<IndexEntry>& index)
+{
+    vector<Player> all;
+    all.reserve(store.count() + overlay.size());
+    vector<bool> merged(overlay.size(), false);
+    for (int record = 0; record < store.count(); record++)
+    {
+        int slot = findSlotIn(overlay, index, store.username(record));
+        if (slot >= 0)
+        {
+            all.push_back(overlay[slot]);
+            merged[slot] = true;
+        }
+        else
+            all.push_back(store.player(record));
+    }
+    for (size_t slot = 0; slot < overlay.size(); slot++)
+        if (!merged[slot])
+            all.push_back(overlay[slot]);
+    return all;
+}
+
+void AuthManager::addPlayer(const Player& player)
+{
+    if ((players.size() + 1) * 2 > index.size())
+        rebuildIndex(index.size() * 2);
+    players.push_back(player);
+    insertIndex(hashUsername(player.username), (int)players.size() - 1);
+}
+
+void AuthManager::insertIndex(uint32_t hash, int slot)
+{
+    size_t mask = index.size() - 1;
+    size_t i = hash & mask;
+    while (index[i].slot >= 0)
+        i = (i + 1) & mask;
+    index[i].hash = hash;
+    index[i].slot = slot;
+}
+
+void AuthManager::rebuildIndex(size_t tableSize)
+{
+    vector<IndexEntry> old(max(tableSize, MIN_INDEX_SIZE), IndexEntry{ 0, -1 });
+    old.swap(index);
+    for (const IndexEntry& entry : old)
+        if (entry.slot >= 0)
+            insertIndex(entry.hash, entry.slot);
+}
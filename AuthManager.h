@@ -0,0 +1,131 @@
+// --- PLAYER ACCOUNTS: REGISTRATION, LOGIN AND PER-PLAYER SCORES ---
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "AccountStore.h"
+#include "PersistenceWorker.h"
+
+// -------------------------------------------------------------
+// AUTH MANAGER
+// -------------------------------------------------------------
+// The accounts from the last snapshot are read in place from the mapped
+// players.dat (AccountStore). Players registered or changed since then
+// live in an in-memory overlay: one vector plus an open-addressing table
+// from the lower-cased username to its slot, consulted before the store.
+// Either way a lookup costs one probe sequence however many players are
+// registered. Usernames compare case-insensitively. An empty file name
+// keeps the accounts in memory only (benchmarks, servers that persist
+// elsewhere).
+//
+// Changes are not written to players.dat directly: each one is appended
+// as a single line to the journal players.dat.journal, and load() replays
+// it into the overlay. Once the journal outgrows the snapshot, compact()
+// writes a new players.dat and empties the journal, so a change costs
+// O(1) amortized instead of a full rewrite. With a PersistenceWorker the
+// frame thread only copies the overlay: the worker merges it with the
+// mapped snapshot, builds, writes and renames the new one, and update()
+// swaps it in once that is done.
+class AuthManager
+{
+public:
+    // A missing store is created from legacyCsv (the old players.txt) if there is one
+    explicit AuthManager(const std::string& file = "players.dat", const std::string& legacyCsv = "players.txt");
+    ~AuthManager();
+    AuthManager(const AuthManager&) = delete;
+    AuthManager& operator=(const AuthManager&) = delete;
+
+    void load();
+
+    // Writes every player to a new players.dat and starts an empty journal.
+    // With a worker it returns once the write is queued; the journal is
+    // emptied, except for what came since, by the update() after it lands.
+    void compact();
+    // Swaps in a snapshot the worker has finished writing; call once a frame
+    void update();
+
+    // CSV rows are "id,username,password,topScore,totalScore"; older
+    // four-column rows carry one score that seeds both. Importing skips
+    // names that already exist and returns how many players were added.
+    int importCsv(const std::string& path);
+    bool exportCsv(const std::string& path) const;
+
+    // Hands journal appends and snapshot writes to a background worker
+    // instead of writing them on the caller's thread; the worker must
+    // outlive this AuthManager. On Windows, where a mapped file can't be
+    // renamed over, compaction still runs here once the worker has drained.
+    void setPersistence(PersistenceWorker* worker);
+
+    // fsync the journal after this many appends (0 = leave flushing to the OS)
+    void setSyncEvery(int records) { syncEvery = records; }
+    // fsync whatever has been appended since the last sync
+    void sync();
+
+    bool registerPlayer(const std::string& u, const std::string& p, std::string& msg);
+    bool loginPlayer(const std::string& u, const std::string& p, std::string& msg) const;
+
+    int getPlayerTopScore(const std::string& username) const;
+    void updatePlayerTopScore(const std::string& username, int newScore);
+    int getPlayerScore(const std::string& username) const;
+    void updatePlayerScore(const std::string& username, int newScore);
+
+    // False when no such player
+    bool findPlayer(const std::string& username, Player& out) const;
+    int playerCount() const { return store.count() + newPlayers; }
+    void forEachPlayer(const std::function<void(const Player&)>& visit) const;
+    void reserve(int expectedPlayers);
+
+private:
+    struct IndexEntry
+    {
+        uint32_t hash;
+        int32_t slot;   // index into players, -1 when empty
+    };
+
+    AccountStore store;
+    std::vector<Player> players;    // overlay: new players and changed copies of stored ones
+    std::vector<IndexEntry> index;  // power-of-two size, at most half full
+    int newPlayers = 0;             // overlay players the store doesn't have
+    int nextID = 1;
+    std::string file;
+    std::string legacyCsv;
+    bool writable = false;      // the store file is ours to replace
+
+    FILE* journal = nullptr;    // unused while a worker writes the journal
+    PersistenceWorker* persistence = nullptr;
+    int journalRecords = 0;     // records since the last compaction
+    int syncEvery = 0;
+    int unsynced = 0;
+
+    // A snapshot the worker is writing, and the journal records since it
+    // was taken: the overlay and journal the new snapshot leaves behind
+    enum CompactionState { COMPACTION_RUNNING, COMPACTION_WRITTEN, COMPACTION_FAILED };
+    bool compacting = false;
+    std::atomic<int> compaction{ COMPACTION_RUNNING };
+    std::string sinceCompaction;
+
+    int findSlot(std::string_view username) const;
+    static int findSlotIn(const std::vector<Player>& overlay, const std::vector<IndexEntry>& index,
+                          std::string_view username);
+    static std::vector<Player> mergePlayers(const AccountStore& store, const std::vector<Player>& overlay,
+                                            const std::vector<IndexEntry>& index);
+    int editableSlot(std::string_view username);
+    bool exists(std::string_view username) const;
+    std::vector<Player> allPlayers() const;
+    int readCsv(const std::string& path);
+    bool loadPlayerRow(const std::string& row);
+    void replayJournal();
+    int replayRecords(const std::string& contents);
+    void applyRecord(const std::string& record);
+    void appendRecord(const std::string& record);
+    bool journalFull() const;
+    void addPlayer(const Player& player);
+    void clearOverlay();
+    void insertIndex(uint32_t hash, int slot);
+    void rebuildIndex(size_t tableSize);
+};
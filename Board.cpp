@@ -0,0 +1,340 @@
+#include "Board.h"
+#include "CaptureKernel.h"
+#include <cstring>
+
+using namespace std;
+
+// -------------------------------------------------------------
+// BIT HELPERS
+// -------------------------------------------------------------
+static int popCount(Board::Word w)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(w);
+#else
+    int n = 0;
+    for (; w; w &= w - 1)
+        n++;
+    return n;
+#endif
+}
+
+static int lowestBit(Board::Word w)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(w);
+#else
+    int n = 0;
+    while (!(w & 1))
+    {
+        w >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static int highestBit(Board::Word w)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(w);
+#else
+    int n = 63;
+    while (!(w >> 63))
+    {
+        w <<= 1;
+        n--;
+    }
+    return n;
+#endif
+}
+
+// Bits [from, to] of word w (columns relative to the word), all others zero
+static Board::Word rangeMask(int w, int left, int right)
+{
+    int lo = max(left - w * Board::WORD_BITS, 0);
+    int hi = min(right - w * Board::WORD_BITS, Board::WORD_BITS - 1);
+    if (lo > hi)
+        return 0;
+    Board::Word upper = (hi == Board::WORD_BITS - 1) ? ~Board::Word(0) : ((Board::Word(1) << (hi + 1)) - 1);
+    return upper & ~((Board::Word(1) << lo) - 1);
+}
+
+// -------------------------------------------------------------
+// BOARD
+// -------------------------------------------------------------
+Board::Board(int rows, int cols)
+{
+    rowCount = max(3, rows);
+    colCount = max(3, cols);
+    wordsPerRow = (colCount + WORD_BITS - 1) / WORD_BITS;
+    stride = (wordsPerRow + WORDS_PER_LINE - 1) / WORDS_PER_LINE * WORDS_PER_LINE;
+    planeWords = (size_t)rowCount * stride;
+    planes.assign(PLANE_COUNT * planeWords, 0);
+
+    colMask.resize(stride);
+    for (int w = 0; w < stride; w++)
+        colMask[w] = rangeMask(w, 0, colCount - 1);
+    emptyScratch.resize(wordsPerRow);
+    rowIsDirty.assign(rowCount, 0);
+    stack.reserve((size_t)rowCount * (colCount / 2 + 1));
+    clear();
+}
+
+void Board::clear()
+{
+    fill(planes.begin(), planes.end(), 0);
+    for (int i = 0; i < rowCount; i++)
+    {
+        Word* blue = row(PLANE_BLUE, i);
+        bool edgeRow = (i == 0 || i == rowCount - 1);
+        for (int w = 0; w < stride; w++)
+            blue[w] = edgeRow ? ~Word(0) : ~colMask[w];  // padding past the last column acts as wall
+        setBit(blue, 0);
+        setBit(blue, colCount - 1);
+
+        Word* dirty = row(PLANE_DIRTY, i);
+        for (int w = 0; w < wordsPerRow; w++)
+            dirty[w] = colMask[w];
+        markRowDirty(i);
+    }
+}
+
+int Board::get(int r, int col) const
+{
+    if (testBit(row(PLANE_BLUE, r), col))
+        return TILE_BLUE;
+    if (testBit(row(PLANE_TRAIL_P1, r), col))
+        return TILE_TRAIL_P1;
+    if (testBit(row(PLANE_TRAIL_P2, r), col))
+        return TILE_TRAIL_P2;
+    return TILE_EMPTY;
+}
+
+int Board::planeFor(int tile) const
+{
+    if (tile == TILE_BLUE)
+        return PLANE_BLUE;
+    if (tile == TILE_TRAIL_P1)
+        return PLANE_TRAIL_P1;
+    if (tile == TILE_TRAIL_P2)
+        return PLANE_TRAIL_P2;
+    return -1;
+}
+
+void Board::set(int r, int col, int tile)
+{
+    if (get(r, col) == tile)
+        return;
+    setBit(row(PLANE_DIRTY, r), col);
+    markRowDirty(r);
+
+    clearBit(row(PLANE_BLUE, r), col);
+    clearBit(row(PLANE_TRAIL_P1, r), col);
+    clearBit(row(PLANE_TRAIL_P2, r), col);
+    int plane = planeFor(tile);
+    if (plane >= 0)
+        setBit(row(plane, r), col);
+}
+
+int Board::count(int tile) const
+{
+    int plane = planeFor(tile);
+    int n = 0;
+    for (int i = 0; i < rowCount; i++)
+        for (int w = 0; w < wordsPerRow; w++)
+            n += popCount(plane < 0 ? emptyWord(i, w) : row(plane, i)[w] & colMask[w]);
+    return n;
+}
+
+// -------------------------------------------------------------
+// WORD-PARALLEL SCANLINE FILL
+// -------------------------------------------------------------
+// Same span-filling scheme as ScanlineFill, but the extent of a run is found
+// with bit scans over the empty plane and each run is marked a word at a time.
+void Board::markReachable(int r, int col)
+{
+    if (r < 0 || r >= rowCount || col < 0 || col >= colCount)
+        return;
+    if (!((emptyWord(r, col / WORD_BITS) >> (col % WORD_BITS)) & 1) || testBit(row(PLANE_REACH, r), col))
+        return;
+
+    Word* empty = emptyScratch.data();
+    stack.clear();
+    stack.push_back({ r, col });
+    while (!stack.empty())
+    {
+        Seed s = stack.back();
+        stack.pop_back();
+        Word* reach = row(PLANE_REACH, s.row);
+        if (testBit(reach, s.col))
+            continue;   // already filled through another run
+        for (int w = 0; w < wordsPerRow; w++)
+            empty[w] = emptyWord(s.row, w);
+
+        // Left end: highest non-empty column below the seed, plus one
+        int w = s.col / WORD_BITS, b = s.col % WORD_BITS;
+        int left = 0;
+        Word blocked = ~empty[w] & ((b == 0) ? 0 : ((Word(1) << b) - 1));
+        for (int k = w; k >= 0; k--)
+        {
+            if (k < w)
+                blocked = ~empty[k];
+            if (blocked)
+            {
+                left = k * WORD_BITS + highestBit(blocked) + 1;
+                break;
+            }
+        }
+
+        // Right end: lowest non-empty column above the seed, minus one
+        int right = colCount - 1;
+        blocked = (b == WORD_BITS - 1) ? 0 : ~empty[w] & ~((Word(2) << b) - 1);
+        for (int k = w; k < wordsPerRow; k++)
+        {
+            if (k > w)
+                blocked = ~empty[k];
+            if (blocked)
+            {
+                right = min(colCount - 1, k * WORD_BITS + lowestBit(blocked) - 1);
+                break;
+            }
+        }
+
+        for (int k = left / WORD_BITS; k <= right / WORD_BITS; k++)
+            reach[k] |= rangeMask(k, left, right);
+
+        if (s.row > 0)
+            pushRuns(s.row - 1, left, right);
+        if (s.row < rowCount - 1)
+            pushRuns(s.row + 1, left, right);
+    }
+}
+
+// Pushes one seed for every run of unreached empty cells in [left, right] of a row
+void Board::pushRuns(int r, int left, int right)
+{
+    const Word* reach = row(PLANE_REACH, r);
+    Word carry = 0;     // top candidate bit of the previous word
+    for (int k = left / WORD_BITS; k <= right / WORD_BITS; k++)
+    {
+        Word candidates = emptyWord(r, k) & ~reach[k] & rangeMask(k, left, right);
+        Word starts = candidates & ~((candidates << 1) | carry);
+        carry = candidates >> (WORD_BITS - 1);
+        while (starts)
+        {
+            stack.push_back({ r, k * WORD_BITS + lowestBit(starts) });
+            starts &= starts - 1;
+        }
+    }
+}
+
+// -------------------------------------------------------------
+// CAPTURE
+// -------------------------------------------------------------
+int Board::captureEnclosed(int trailTile, int& emptyLeft)
+{
+    // One call over whole planes: rows are padded to a cache line, so even
+    // the classic 40 columns give the vector loops 8 words per row to chew on.
+    // Padding words are blue and stay untouched.
+    int own = planeFor(trailTile);
+    int other = own == PLANE_TRAIL_P1 ? PLANE_TRAIL_P2 : PLANE_TRAIL_P1;
+    int captured = captureKernel()(row(PLANE_BLUE, 0), row(own, 0), row(other, 0), row(PLANE_REACH, 0),
+                                   row(PLANE_DIRTY, 0), planeWords, emptyLeft);
+    if (captured == 0)
+        return 0;
+
+    // Rows the capture changed are the ones now holding dirty bits
+    for (int r = 0; r < rowCount; r++)
+    {
+        if (rowIsDirty[r])
+            continue;
+        const Word* dirty = row(PLANE_DIRTY, r);
+        for (int w = 0; w < wordsPerRow; w++)
+            if (dirty[w])
+            {
+                markRowDirty(r);
+                break;
+            }
+    }
+    return captured;
+}
+
+// -------------------------------------------------------------
+// CHANGE TRACKING
+// -------------------------------------------------------------
+void Board::markRowDirty(int r)
+{
+    if (rowIsDirty[r])
+        return;
+    rowIsDirty[r] = 1;
+    dirtyRows.push_back(r);
+}
+
+void Board::collectDirty(vector<int>& cells) const
+{
+    for (int r : dirtyRows)
+    {
+        const Word* dirty = row(PLANE_DIRTY, r);
+        for (int w = 0; w < wordsPerRow; w++)
+            for (Word bits = dirty[w] & colMask[w]; bits; bits &= bits - 1)
+                cells.push_back(r * colCount + w * WORD_BITS + lowestBit(bits));
+    }
+}
+
+void Board::clearDirty()
+{
+    for (int r : dirtyRows)
+    {
+        Word* dirty = row(PLANE_DIRTY, r);
+        for (int w = 0; w < wordsPerRow; w++)
+            dirty[w] = 0;
+        rowIsDirty[r] = 0;
+    }
+    dirtyRows.clear();
+}
+
+// -------------------------------------------------------------
+// SNAPSHOTS
+// -------------------------------------------------------------
+// The blue and both trail planes come first in `planes`, so a snapshot is one
+// contiguous copy; the reach and dirty planes are scratch and not kept.
+void Board::saveTiles(vector<Word>& out) const
+{
+    out.assign(planes.begin(), planes.begin() + PLANE_REACH * planeWords);
+}
+
+bool Board::restoreTiles(const vector<Word>& tiles, int rows, int cols, bool& changed)
+{
+    changed = false;
+    if (rows != rowCount || cols != colCount || tiles.size() != PLANE_REACH * planeWords)
+        return false;
+    for (int r = 0; r < rowCount; r++)
+    {
+        size_t offset = (size_t)r * stride;
+        Word* dirty = row(PLANE_DIRTY, r);
+        bool rowChanged = false;
+        for (int w = 0; w < wordsPerRow; w++)
+        {
+            Word diff = 0;
+            for (int plane = 0; plane < PLANE_REACH; plane++)
+            {
+                size_t at = plane * planeWords + offset + w;
+                diff |= planes[at] ^ tiles[at];
+            }
+            diff &= colMask[w];
+            if (diff)
+            {
+                dirty[w] |= diff;
+                rowChanged = true;
+            }
+        }
+        if (rowChanged)
+        {
+            markRowDirty(r);
+            changed = true;
+        }
+    }
+    copy(tiles.begin(), tiles.end(), planes.begin());
+    return true;
+}
@@ -0,0 +1,134 @@
+// --- BIT-PLANE BOARD: ONE BITSET PER TILE STATE, ROWS PACKED INTO WORDS ---
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// Size of the classic arena; any other size can be passed at runtime
+const int DEFAULT_ROWS = 25;
+const int DEFAULT_COLS = 40;
+
+// -------------------------------------------------------------
+// TILE VALUES
+// -------------------------------------------------------------
+const int TILE_EMPTY = 0;
+const int TILE_BLUE = 1;            // border / captured, safe for players
+const int TILE_TRAIL_P1 = 2;        // player 1 constructing
+const int TILE_TRAIL_P2 = 3;        // player 2 constructing
+
+// -------------------------------------------------------------
+// CACHE-LINE ALIGNED STORAGE
+// -------------------------------------------------------------
+const size_t CACHE_LINE_BYTES = 64;
+
+template <typename T>
+struct CacheAlignedAllocator
+{
+    typedef T value_type;
+
+    CacheAlignedAllocator() {}
+    template <typename U>
+    CacheAlignedAllocator(const CacheAlignedAllocator<U>&) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(CACHE_LINE_BYTES))); }
+    void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(CACHE_LINE_BYTES)); }
+
+    template <typename U>
+    bool operator==(const CacheAlignedAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const CacheAlignedAllocator<U>&) const { return false; }
+};
+
+// Each tile state is a separate bit plane; a cell is empty when no plane has
+// its bit set. Capture, counting and conversion then work on 64 cells at a time.
+// Every row starts on a cache line: rows are padded to a whole number of lines.
+class Board
+{
+public:
+    typedef uint64_t Word;
+    static const int WORD_BITS = 64;
+    static const int WORDS_PER_LINE = (int)(CACHE_LINE_BYTES / sizeof(Word));
+
+    explicit Board(int rows = DEFAULT_ROWS, int cols = DEFAULT_COLS);
+
+    int rows() const { return rowCount; }
+    int cols() const { return colCount; }
+
+    // Blue border, empty interior; marks every cell dirty
+    void clear();
+
+    int get(int row, int col) const;
+    void set(int row, int col, int tile);
+    bool isBlue(int row, int col) const { return testBit(blueRow(row), col); }
+
+    // Number of cells holding the given tile value
+    int count(int tile) const;
+
+    // Marks the empty area 4-connected to (row, col) as enemy-reachable
+    void markReachable(int row, int col);
+
+    // Turns the given trail and every empty cell not marked reachable into
+    // blue, clears the marks and returns the number of cells captured.
+    // emptyLeft receives the number of empty cells remaining.
+    int captureEnclosed(int trailTile, int& emptyLeft);
+
+    // Change tracking: appends row * cols() + col of every cell whose tile
+    // changed since the last clearDirty(). Only rows with changes are visited,
+    // so the cost follows the amount of change rather than the board area.
+    void collectDirty(std::vector<int>& cells) const;
+    const std::vector<int>& dirtyRowList() const { return dirtyRows; }
+    void clearDirty();
+
+    // Snapshots: copies the tile planes out, or back in from a board of the
+    // same size. Restoring marks every cell it changes dirty and sets changed
+    // if any did; tiles from a board of another size, rows or columns, are
+    // refused (false) and leave the board untouched. The word count alone
+    // can't tell: rows are padded, so 40 and 400 columns take as many words.
+    void saveTiles(std::vector<Word>& out) const;
+    bool restoreTiles(const std::vector<Word>& tiles, int rows, int cols, bool& changed);
+
+private:
+    enum Plane
+    {
+        PLANE_BLUE,     // padding bits past the last column are always set
+        PLANE_TRAIL_P1,
+        PLANE_TRAIL_P2,
+        PLANE_REACH,    // scratch plane used during a capture
+        PLANE_DIRTY,    // cells changed since the last clearDirty()
+        PLANE_COUNT
+    };
+
+    int rowCount, colCount;
+    int wordsPerRow;    // words holding real columns
+    int stride;         // words per row including the cache-line padding
+    size_t planeWords;
+    std::vector<Word, CacheAlignedAllocator<Word> > planes;
+    std::vector<Word> colMask;      // bits of real columns in each word of a row
+    std::vector<int> dirtyRows;     // rows with at least one dirty bit, in no order
+    std::vector<char> rowIsDirty;
+
+    struct Seed
+    {
+        int row, col;
+    };
+    std::vector<Seed> stack;
+    std::vector<Word> emptyScratch;
+
+    Word* row(int plane, int r) { return planes.data() + plane * planeWords + (size_t)r * stride; }
+    const Word* row(int plane, int r) const { return planes.data() + plane * planeWords + (size_t)r * stride; }
+    const Word* blueRow(int r) const { return row(PLANE_BLUE, r); }
+
+    static bool testBit(const Word* row, int col) { return (row[col / WORD_BITS] >> (col % WORD_BITS)) & 1; }
+    static void setBit(Word* row, int col) { row[col / WORD_BITS] |= Word(1) << (col % WORD_BITS); }
+    static void clearBit(Word* row, int col) { row[col / WORD_BITS] &= ~(Word(1) << (col % WORD_BITS)); }
+
+    Word emptyWord(int r, int w) const
+    {
+        return ~(row(PLANE_BLUE, r)[w] | row(PLANE_TRAIL_P1, r)[w] | row(PLANE_TRAIL_P2, r)[w]) & colMask[w];
+    }
+    int planeFor(int tile) const;
+    void markRowDirty(int r);
+    void pushRuns(int r, int left, int right);
+};
@@ -0,0 +1,210 @@
+#include "CaptureKernel.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define XONIX_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define XONIX_TARGET(isa) __attribute__((target(isa)))
+#else
+#define XONIX_TARGET(isa)
+#endif
+
+using namespace std;
+
+// -------------------------------------------------------------
+// SCALAR
+// -------------------------------------------------------------
+static int popCount(uint64_t w)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(w);
+#else
+    w = w - ((w >> 1) & 0x5555555555555555ULL);
+    w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+    w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((w * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+int captureKernelScalar(uint64_t* blue, uint64_t* own, const uint64_t* other, uint64_t* reach,
+                        uint64_t* dirty, size_t n, int& emptyLeft)
+{
+    int captured = 0;
+    int left = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t empty = ~(blue[i] | own[i] | other[i]);
+        uint64_t gained = own[i] | (empty & ~reach[i]);
+        captured += popCount(gained);
+        left += popCount(empty & reach[i]);
+        blue[i] |= gained;
+        dirty[i] |= gained;
+        own[i] = 0;
+        reach[i] = 0;
+    }
+    emptyLeft = left;
+    return captured;
+}
+
+#ifdef XONIX_X86
+// -------------------------------------------------------------
+// SSE2: two words per step, SWAR popcount summed with psadbw
+// -------------------------------------------------------------
+XONIX_TARGET("sse2")
+static __m128i byteCounts128(__m128i v)
+{
+    const __m128i m1 = _mm_set1_epi8(0x55);
+    const __m128i m2 = _mm_set1_epi8(0x33);
+    const __m128i m4 = _mm_set1_epi8(0x0F);
+    v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi64(v, 1), m1));
+    v = _mm_add_epi8(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi64(v, 2), m2));
+    return _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi64(v, 4)), m4);
+}
+
+XONIX_TARGET("sse2")
+static int captureSSE2(uint64_t* blue, uint64_t* own, const uint64_t* other, uint64_t* reach,
+                       uint64_t* dirty, size_t n, int& emptyLeft)
+{
+    const __m128i ones = _mm_set1_epi32(-1);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i capturedSum = zero, leftSum = zero;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128i b = _mm_loadu_si128((const __m128i*)(blue + i));
+        __m128i o = _mm_loadu_si128((const __m128i*)(own + i));
+        __m128i t = _mm_loadu_si128((const __m128i*)(other + i));
+        __m128i r = _mm_loadu_si128((const __m128i*)(reach + i));
+        __m128i empty = _mm_xor_si128(_mm_or_si128(_mm_or_si128(b, o), t), ones);
+        __m128i gained = _mm_or_si128(o, _mm_andnot_si128(r, empty));
+        capturedSum = _mm_add_epi64(capturedSum, _mm_sad_epu8(byteCounts128(gained), zero));
+        leftSum = _mm_add_epi64(leftSum, _mm_sad_epu8(byteCounts128(_mm_and_si128(empty, r)), zero));
+        _mm_storeu_si128((__m128i*)(blue + i), _mm_or_si128(b, gained));
+        _mm_storeu_si128((__m128i*)(dirty + i), _mm_or_si128(_mm_loadu_si128((const __m128i*)(dirty + i)), gained));
+        _mm_storeu_si128((__m128i*)(own + i), zero);
+        _mm_storeu_si128((__m128i*)(reach + i), zero);
+    }
+
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, capturedSum);
+    int captured = (int)(lanes[0] + lanes[1]);
+    _mm_storeu_si128((__m128i*)lanes, leftSum);
+    int left = (int)(lanes[0] + lanes[1]);
+
+    int tailLeft = 0;
+    captured += captureKernelScalar(blue + i, own + i, other + i, reach + i, dirty + i, n - i, tailLeft);
+    emptyLeft = left + tailLeft;
+    return captured;
+}
+
+// -------------------------------------------------------------
+// AVX2: four words per step, nibble-table popcount summed with vpsadbw
+// -------------------------------------------------------------
+XONIX_TARGET("avx2")
+static __m256i byteCounts256(__m256i v)
+{
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low));
+    __m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+    return _mm256_add_epi8(lo, hi);
+}
+
+XONIX_TARGET("avx2")
+static int captureAVX2(uint64_t* blue, uint64_t* own, const uint64_t* other, uint64_t* reach,
+                       uint64_t* dirty, size_t n, int& emptyLeft)
+{
+    const __m256i ones = _mm256_set1_epi32(-1);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i capturedSum = zero, leftSum = zero;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i b = _mm256_loadu_si256((const __m256i*)(blue + i));
+        __m256i o = _mm256_loadu_si256((const __m256i*)(own + i));
+        __m256i t = _mm256_loadu_si256((const __m256i*)(other + i));
+        __m256i r = _mm256_loadu_si256((const __m256i*)(reach + i));
+        __m256i empty = _mm256_xor_si256(_mm256_or_si256(_mm256_or_si256(b, o), t), ones);
+        __m256i gained = _mm256_or_si256(o, _mm256_andnot_si256(r, empty));
+        capturedSum = _mm256_add_epi64(capturedSum, _mm256_sad_epu8(byteCounts256(gained), zero));
+        leftSum = _mm256_add_epi64(leftSum, _mm256_sad_epu8(byteCounts256(_mm256_and_si256(empty, r)), zero));
+        _mm256_storeu_si256((__m256i*)(blue + i), _mm256_or_si256(b, gained));
+        _mm256_storeu_si256((__m256i*)(dirty + i), _mm256_or_si256(_mm256_loadu_si256((const __m256i*)(dirty + i)), gained));
+        _mm256_storeu_si256((__m256i*)(own + i), zero);
+        _mm256_storeu_si256((__m256i*)(reach + i), zero);
+    }
+
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, capturedSum);
+    int captured = (int)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    _mm256_storeu_si256((__m256i*)lanes, leftSum);
+    int left = (int)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+
+    int tailLeft = 0;
+    captured += captureKernelScalar(blue + i, own + i, other + i, reach + i, dirty + i, n - i, tailLeft);
+    emptyLeft = left + tailLeft;
+    return captured;
+}
+
+static bool cpuHasAVX2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) && ((_xgetbv(0) & 6) == 6);
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5));
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+// -------------------------------------------------------------
+// DISPATCH
+// -------------------------------------------------------------
+CaptureKernelFn captureKernelSSE2()
+{
+#ifdef XONIX_X86
+    return captureSSE2;     // part of the x86-64 baseline
+#else
+    return nullptr;
+#endif
+}
+
+CaptureKernelFn captureKernelAVX2()
+{
+#ifdef XONIX_X86
+    static const bool supported = cpuHasAVX2();
+    return supported ? captureAVX2 : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+CaptureKernelFn captureKernel()
+{
+    static const CaptureKernelFn best = captureKernelAVX2() ? captureKernelAVX2()
+                                      : captureKernelSSE2() ? captureKernelSSE2()
+                                      : captureKernelScalar;
+    return best;
+}
+
+const char* captureKernelName()
+{
+    CaptureKernelFn k = captureKernel();
+    if (k == captureKernelAVX2())
+        return "avx2";
+    if (k == captureKernelSSE2())
+        return "sse2";
+    return "scalar";
+}
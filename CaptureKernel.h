@@ -0,0 +1,27 @@
+// --- FUSED CAPTURE KERNEL: COUNT AND CONVERT A CAPTURE IN ONE PASS OVER THE BIT PLANES ---
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// One pass over n words of the board's bit planes. For every word:
+//   empty     = ~(blue | own | other)
+//   enclosed  = empty & ~reach
+//   blue     |= own | enclosed,  own = 0,  reach = 0
+//   dirty    |= own | enclosed   (cells whose tile changed)
+// Returns the number of cells captured (own trail + enclosed) and stores
+// the number of cells left empty in emptyLeft. Padding bits past the last
+// column must be set in blue so they never count as empty.
+typedef int (*CaptureKernelFn)(uint64_t* blue, uint64_t* own, const uint64_t* other, uint64_t* reach,
+                               uint64_t* dirty, size_t n, int& emptyLeft);
+
+int captureKernelScalar(uint64_t* blue, uint64_t* own, const uint64_t* other, uint64_t* reach,
+                        uint64_t* dirty, size_t n, int& emptyLeft);
+
+// Only available on x86; null elsewhere or when the CPU lacks the extension
+CaptureKernelFn captureKernelSSE2();
+CaptureKernelFn captureKernelAVX2();
+
+// Best kernel for this CPU, chosen once at first use
+CaptureKernelFn captureKernel();
+const char* captureKernelName();
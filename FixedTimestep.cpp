@@ -0,0 +1,21 @@
+#include "FixedTimestep.h"
+#include <algorithm>
+
+using namespace std;
+
+int FixedTimestep::run(GameSimulation& sim, float dt)
+{
+    pending = min(pending + max(0.0f, dt), maxCatchUp * SIM_TICK_SECONDS);
+    int ticks = 0;
+    for (; pending >= SIM_TICK_SECONDS && !sim.isOver(); pending -= SIM_TICK_SECONDS)
+    {
+        sim.tick();
+        ticks++;
+    }
+    return ticks;
+}
+
+float FixedTimestep::alpha() const
+{
+    return min(1.0f, pending / SIM_TICK_SECONDS);
+}
@@ -0,0 +1,29 @@
+// --- FIXED TIMESTEP: REAL FRAME TIME IN, WHOLE SIMULATION TICKS OUT ---
+#pragma once
+
+#include "GameSimulation.h"
+
+const int MAX_CATCHUP_TICKS = 8;        // most ticks one frame runs to catch up after a hitch
+
+// Turns however long each frame took into whole GameSimulation ticks. Time
+// left over is carried into the next frame, so the match runs at
+// SIM_TICKS_PER_SECOND whether frames come at 30, 60 or 240 per second, and
+// alpha() says how far into the next tick the frame is drawn. A hitch longer
+// than maxCatchUp ticks is dropped rather than played back in one burst.
+class FixedTimestep
+{
+public:
+    explicit FixedTimestep(int maxCatchUp = MAX_CATCHUP_TICKS) : maxCatchUp(maxCatchUp) {}
+
+    // Runs every tick dt more seconds make due (none once the match is over)
+    // and returns how many ran
+    int run(GameSimulation& sim, float dt);
+
+    // 0..1: time since the latest tick, in ticks
+    float alpha() const;
+    void reset() { pending = 0; }
+
+private:
+    int maxCatchUp;
+    float pending = 0;      // seconds not yet simulated
+};
@@ -0,0 +1,63 @@
+#include "FloodFill.h"
+
+using namespace std;
+
+void ScanlineFill::reserve(int rows, int cols)
+{
+    // At most one run starts every other cell; the stack keeps its capacity
+    // between fills and only grows if a board ever needs more
+    stack.reserve((size_t)rows * (cols / 2 + 1));
+}
+
+int ScanlineFill::fill(int* cells, int rows, int cols, int row, int col, int from, int to)
+{
+    if (row < 0 || row >= rows || col < 0 || col >= cols || from == to)
+        return 0;
+    if (cells[row * cols + col] != from)
+        return 0;
+
+    int filled = 0;
+    stack.clear();
+    stack.push_back({ row, col });
+    while (!stack.empty())
+    {
+        Seed s = stack.back();
+        stack.pop_back();
+        int* rowCells = cells + s.row * cols;
+        if (rowCells[s.col] != from)
+            continue;   // already filled through another run
+
+        // Grow the seed into the whole horizontal run and mark it
+        int left = s.col, right = s.col;
+        while (left > 0 && rowCells[left - 1] == from)
+            left--;
+        while (right < cols - 1 && rowCells[right + 1] == from)
+            right++;
+        for (int c = left; c <= right; c++)
+            rowCells[c] = to;
+        filled += right - left + 1;
+
+        if (s.row > 0)
+            pushRuns(rowCells - cols, s.row - 1, left, right, from);
+        if (s.row < rows - 1)
+            pushRuns(rowCells + cols, s.row + 1, left, right, from);
+    }
+    return filled;
+}
+
+// Pushes one seed for every run of `from` cells in [left, right] of a neighbouring row
+void ScanlineFill::pushRuns(const int* rowCells, int row, int left, int right, int from)
+{
+    bool inRun = false;
+    for (int c = left; c <= right; c++)
+    {
+        if (rowCells[c] == from)
+        {
+            if (!inRun)
+                stack.push_back({ row, c });
+            inRun = true;
+        }
+        else
+            inRun = false;
+    }
+}
@@ -0,0 +1,28 @@
+// --- ITERATIVE SCANLINE FLOOD FILL ---
+#pragma once
+
+#include <vector>
+
+// Span-filling flood fill over a row-major grid of ints. Whole horizontal
+// runs are marked at once and only one seed per run of the rows above and
+// below is pushed, onto an explicit stack that is allocated once and reused,
+// so there is no recursion and no allocation per fill.
+class ScanlineFill
+{
+public:
+    // Reserves stack space for grids of up to rows * cols cells
+    void reserve(int rows, int cols);
+
+    // Changes every cell equal to `from` that is 4-connected to (row, col)
+    // into `to`. Returns the number of cells changed.
+    int fill(int* cells, int rows, int cols, int row, int col, int from, int to);
+
+private:
+    struct Seed
+    {
+        int row, col;
+    };
+    std::vector<Seed> stack;
+
+    void pushRuns(const int* rowCells, int row, int left, int right, int from);
+};
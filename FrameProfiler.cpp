@@ -0,0 +1,111 @@
+#include "FrameProfiler.h"
+#include <algorithm>
+
+using namespace std;
+
+const char* phaseName(int phase)
+{
+    static const char* names[PHASE_COUNT] = { "events", "input", "simulation", "capture", "draw", "frame" };
+    return (phase >= 0 && phase < PHASE_COUNT) ? names[phase] : "?";
+}
+
+static double microsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+}
+
+void FrameProfiler::beginFrame()
+{
+    if (history[0].empty())
+        for (int p = 0; p < PHASE_COUNT; p++)
+            history[p].assign(HISTORY_FRAMES, 0);
+    fill(current, current + PHASE_COUNT, 0.0);
+    frameStart = Clock::now();
+}
+
+void FrameProfiler::endFrame()
+{
+    current[PHASE_FRAME] = microsSince(frameStart);
+    for (int p = 0; p < PHASE_COUNT; p++)
+        history[p][next] = current[p];
+    next = (next + 1) % HISTORY_FRAMES;
+    filled = min(filled + 1, HISTORY_FRAMES);
+    frameNumber++;
+
+    if (csv.is_open())
+    {
+        csv << frameNumber;
+        for (int p = 0; p < PHASE_COUNT; p++)
+            csv << ',' << current[p];
+        csv << '\n';
+    }
+
+    if (frameNumber % SUMMARY_INTERVAL == 0)
+        refreshSummary();
+}
+
+void FrameProfiler::begin(int phase)
+{
+    phaseStart[phase] = Clock::now();
+}
+
+void FrameProfiler::end(int phase)
+{
+    current[phase] += microsSince(phaseStart[phase]);
+}
+
+void FrameProfiler::add(int phase, double micros)
+{
+    current[phase] += micros;
+}
+
+void FrameProfiler::refreshSummary()
+{
+    for (int p = 0; p < PHASE_COUNT; p++)
+    {
+        scratch.assign(history[p].begin(), history[p].begin() + filled);
+        if (scratch.empty())
+            continue;
+        for (int k = 0; k < 2; k++)
+        {
+            size_t rank = (size_t)((scratch.size() - 1) * (k == 0 ? 0.50 : 0.99));
+            nth_element(scratch.begin(), scratch.begin() + rank, scratch.end());
+            summary[p][k] = scratch[rank];
+        }
+    }
+}
+
+bool FrameProfiler::startCsv(const string& path)
+{
+    stopCsv();
+    csv.open(path);
+    if (!csv.is_open())
+        return false;
+    csv << "frame";
+    for (int p = 0; p < PHASE_COUNT; p++)
+        csv << ',' << phaseName(p) << "_us";
+    csv << '\n';
+    return true;
+}
+
+void FrameProfiler::stopCsv()
+{
+    if (csv.is_open())
+        csv.close();
+}
+
+// -------------------------------------------------------------
+// SCOPED PHASE
+// -------------------------------------------------------------
+ScopedPhase::ScopedPhase(FrameProfiler* profiler, int phase)
+    : profiler(profiler), phase(phase)
+{
+    if (profiler)
+        start = chrono::steady_clock::now();
+}
+
+ScopedPhase::~ScopedPhase()
+{
+    if (profiler)
+        profiler->add(phase, microsSince(start));
+}
@@ -0,0 +1,77 @@
+// --- FRAME PROFILER: PER-PHASE FRAME TIMES, PERCENTILES AND CSV EXPORT ---
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+enum ProfilePhase
+{
+    PHASE_EVENTS,       // window.pollEvent loop
+    PHASE_INPUT,        // Keyboard::isKeyPressed polling
+    PHASE_SIMULATION,   // GameSimulation::tick, capture included
+    PHASE_CAPTURE,      // captures only (measured inside the simulation)
+    PHASE_DRAW,         // window.clear() up to window.display()
+    PHASE_FRAME,        // whole frame, including the frame limiter's sleep
+    PHASE_COUNT
+};
+
+const char* phaseName(int phase);
+
+// Collects how long each phase of the main loop took, frame by frame. The
+// last HISTORY_FRAMES frames are kept for percentiles, which are refreshed
+// every SUMMARY_INTERVAL frames; every frame can also be appended to a CSV.
+class FrameProfiler
+{
+public:
+    static const int HISTORY_FRAMES = 600;      // ten seconds at 60 FPS
+    static const int SUMMARY_INTERVAL = 30;
+
+    bool showOverlay = false;
+
+    void beginFrame();
+    void endFrame();
+
+    // Time between begin() and end() is added to the phase for this frame
+    void begin(int phase);
+    void end(int phase);
+    void add(int phase, double micros);
+
+    // Percentiles in microseconds over the recent history, as of the last refresh
+    double p50(int phase) const { return summary[phase][0]; }
+    double p99(int phase) const { return summary[phase][1]; }
+    int framesRecorded() const { return filled; }
+
+    bool startCsv(const std::string& path);
+    void stopCsv();
+    bool recordingCsv() const { return csv.is_open(); }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point frameStart;
+    Clock::time_point phaseStart[PHASE_COUNT];
+    double current[PHASE_COUNT] = {};
+    std::vector<double> history[PHASE_COUNT];
+    int next = 0, filled = 0;
+    long long frameNumber = 0;
+    double summary[PHASE_COUNT][2] = {};
+    std::vector<double> scratch;
+    std::ofstream csv;
+
+    void refreshSummary();
+};
+
+// Adds the lifetime of the scope to a phase; does nothing without a profiler
+class ScopedPhase
+{
+public:
+    ScopedPhase(FrameProfiler* profiler, int phase);
+    ~ScopedPhase();
+
+private:
+    FrameProfiler* profiler;
+    int phase;
+    std::chrono::steady_clock::time_point start;
+};
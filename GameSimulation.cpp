@@ -0,0 +1,380 @@
+#include "GameSimulation.h"
+#include <algorithm>
+
+using namespace std;
+
+// -------------------------------------------------------------
+// ENEMY
+// -------------------------------------------------------------
+Enemy::Enemy()
+{
+    posX = posY = lastX = lastY = 300;
+    velX = velY = 0;
+}
+
+Enemy::Enemy(SimRandom& random)
+{
+    posX = posY = lastX = lastY = 300;
+    velX = 4 - random.below(8);
+    velY = 4 - random.below(8);
+}
+
+void Enemy::move(const Board& board)
+{
+    posX += velX;
+    if (board.isBlue(posY / TILE_SIZE_PIXELS, posX / TILE_SIZE_PIXELS))
+    {
+        velX = -velX;
+        posX += velX;
+    }
+    posY += velY;
+    if (board.isBlue(posY / TILE_SIZE_PIXELS, posX / TILE_SIZE_PIXELS))
+    {
+        velY = -velY;
+        posY += velY;
+    }
+}
+
+// -------------------------------------------------------------
+// GAME SIMULATION
+// -------------------------------------------------------------
+GameSimulation::GameSimulation(int rows, int cols, uint64_t seed)
+    : board(rows, cols), random(seed)
+{
+    reset(1, enemyCount);
+}
+
+void GameSimulation::resize(int rows, int cols)
+{
+    board = Board(rows, cols);
+    reset(playerCount, enemyCount);
+}
+
+void GameSimulation::reset(int numPlayers, int numEnemies, uint64_t matchSeed)
+{
+    random.reseed(matchSeed);
+    reset(numPlayers, numEnemies);
+}
+
+void GameSimulation::reset(int numPlayers, int numEnemies)
+{
+    playerCount = max(1, min(MAX_PLAYERS, numPlayers));
+    enemyCount = max(0, min(MAX_ENEMIES, numEnemies));
+
+    board.clear();
+    if (captureMode == CAPTURE_INCREMENTAL)
+        regions.reset(board);
+
+    for (int p = 0; p < MAX_PLAYERS; p++)
+    {
+        players[p] = SimPlayer();
+        trailCells[p].clear();
+    }
+    players[0].col = min(10, cols() - 1);
+    players[1].col = min(15, cols() - 1);
+
+    // Enemies start at pixel (300, 300), or in the middle of boards too small for that
+    int spawn = 300;
+    if (spawn / TILE_SIZE_PIXELS >= min(rows(), cols()) - 1)
+        spawn = min(rows(), cols()) / 2 * TILE_SIZE_PIXELS;
+    for (int i = 0; i < enemyCount; i++)
+    {
+        enemies[i] = Enemy(random);
+        enemies[i].posX = enemies[i].posY = enemies[i].lastX = enemies[i].lastY = spawn;
+    }
+
+    stepTicks = 0;
+    enemyFreezeTicks = 0;
+}
+
+void GameSimulation::setCaptureMode(CaptureMode mode)
+{
+    if (mode == CAPTURE_INCREMENTAL && captureMode != CAPTURE_INCREMENTAL)
+        regions.reset(board);
+    captureMode = mode;
+}
+
+void GameSimulation::setDirection(int player, int dirRow, int dirCol)
+{
+    players[player].dirRow = dirRow;
+    players[player].dirCol = dirCol;
+}
+
+bool GameSimulation::usePowerUp(int player)
+{
+    SimPlayer& pl = players[player];
+    if (!pl.running || pl.availablePowerUps <= 0)
+        return false;
+
+    if (playerCount == 1)
+    {
+        // Single player: freeze the enemies
+        if (enemyFreezeTicks > 0)
+            return false;
+        enemyFreezeTicks = FREEZE_TICKS;
+    }
+    else
+    {
+        // Multiplayer: freeze the opponent (and with them the enemies)
+        if (pl.frozenTicks > 0)
+            return false;
+        players[1 - player].frozenTicks = FREEZE_TICKS;
+    }
+    pl.availablePowerUps--;
+    return true;
+}
+
+bool GameSimulation::isOver() const
+{
+    for (int p = 0; p < playerCount; p++)
+        if (!players[p].running)
+            return true;
+    return false;
+}
+
+bool GameSimulation::enemiesFrozen() const
+{
+    if (enemyFreezeTicks > 0)
+        return true;
+    for (int p = 0; p < playerCount; p++)
+        if (players[p].frozenTicks > 0)
+            return true;
+    return false;
+}
+
+// FNV-1a, fed one int at a time
+static void hashInt(uint32_t& hash, int value)
+{
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        hash ^= (uint32_t)(value >> shift) & 0xFF;
+        hash *= 16777619u;
+    }
+}
+
+uint32_t GameSimulation::checksum() const
+{
+    uint32_t hash = 2166136261u;
+    for (int r = 0; r < rows(); r++)
+        for (int c = 0; c < cols(); c++)
+            hashInt(hash, board.get(r, c));
+    for (int p = 0; p < playerCount; p++)
+    {
+        const SimPlayer& pl = players[p];
+        int fields[] = { pl.row, pl.col, pl.dirRow, pl.dirCol, pl.running, pl.score, pl.rewardComboCount,
+                         pl.availablePowerUps, pl.lastPowerUpAwardScore, pl.frozenTicks };
+        for (int value : fields)
+            hashInt(hash, value);
+    }
+    for (int i = 0; i < enemyCount; i++)
+    {
+        int fields[] = { enemies[i].posX, enemies[i].posY, enemies[i].velX, enemies[i].velY };
+        for (int value : fields)
+            hashInt(hash, value);
+    }
+    hashInt(hash, stepTicks);
+    hashInt(hash, enemyFreezeTicks);
+    return hash;
+}
+
+void GameSimulation::save(SimSnapshot& snapshot) const
+{
+    board.saveTiles(snapshot.tiles);
+    snapshot.rows = board.rows();
+    snapshot.cols = board.cols();
+    for (int p = 0; p < MAX_PLAYERS; p++)
+    {
+        snapshot.players[p] = players[p];
+        snapshot.trailCells[p] = trailCells[p];
+    }
+    for (int i = 0; i < MAX_ENEMIES; i++)
+        snapshot.enemies[i] = enemies[i];
+    snapshot.playerCount = playerCount;
+    snapshot.enemyCount = enemyCount;
+    snapshot.stepTicks = stepTicks;
+    snapshot.enemyFreezeTicks = enemyFreezeTicks;
+}
+
+bool GameSimulation::restore(const SimSnapshot& snapshot)
+{
+    bool tilesChanged;
+    if (!board.restoreTiles(snapshot.tiles, snapshot.rows, snapshot.cols, tilesChanged))
+        return false;
+    // Regions only ever split, so cells that are empty again need a relabel;
+    // a rollback over ticks that laid no trail and captured nothing skips it
+    if (tilesChanged && captureMode == CAPTURE_INCREMENTAL)
+        regions.reset(board);
+    for (int p = 0; p < MAX_PLAYERS; p++)
+    {
+        players[p] = snapshot.players[p];
+        trailCells[p] = snapshot.trailCells[p];
+    }
+    for (int i = 0; i < MAX_ENEMIES; i++)
+        enemies[i] = snapshot.enemies[i];
+    playerCount = snapshot.playerCount;
+    enemyCount = snapshot.enemyCount;
+    stepTicks = snapshot.stepTicks;
+    enemyFreezeTicks = snapshot.enemyFreezeTicks;
+    return true;
+}
+
+void GameSimulation::tick()
+{
+    if (isOver())
+        return;
+
+    for (int i = 0; i < enemyCount; i++)
+    {
+        enemies[i].lastX = enemies[i].posX;
+        enemies[i].lastY = enemies[i].posY;
+    }
+    enemyFreezeTicks = max(0, enemyFreezeTicks - 1);
+    for (int p = 0; p < playerCount; p++)
+        players[p].frozenTicks = max(0, players[p].frozenTicks - 1);
+
+    if (++stepTicks >= PLAYER_STEP_TICKS)
+    {
+        for (int p = 0; p < playerCount && !isOver(); p++)
+            if (players[p].frozenTicks == 0)
+                stepPlayer(p);
+        stepTicks = 0;
+    }
+
+    if (!enemiesFrozen() && !isOver())
+        for (int i = 0; i < enemyCount; i++)
+            enemies[i].move(board);
+
+    for (int p = 0; p < playerCount && !isOver(); p++)
+        if (board.isBlue(players[p].row, players[p].col))
+            capture(p);
+
+    checkEnemyContacts();
+}
+
+void GameSimulation::eliminate(int player, const char* reason)
+{
+    players[player].running = false;
+    if (players[player].deathReason.empty())
+        players[player].deathReason = reason;
+}
+
+void GameSimulation::stepPlayer(int player)
+{
+    SimPlayer& pl = players[player];
+    pl.col = max(0, min(cols() - 1, pl.col + pl.dirCol));
+    pl.row = max(0, min(rows() - 1, pl.row + pl.dirRow));
+
+    if (playerCount == 2 && players[0].row == players[1].row && players[0].col == players[1].col)
+        resolveCollision();
+
+    int tile = board.get(pl.row, pl.col);
+    if (tile == trailTile(player))
+        eliminate(player, "Stepped on own constructing tile");
+    else if (player == 1 && tile == TILE_TRAIL_P1)
+        eliminate(player, "Stepped on Player 1's constructing tile");
+    if (tile == TILE_EMPTY)
+    {
+        board.set(pl.row, pl.col, trailTile(player));
+        trailCells[player].push_back(pl.row * cols() + pl.col);
+        if (captureMode == CAPTURE_INCREMENTAL)
+            regions.removeCell(pl.row, pl.col);
+    }
+}
+
+// Head-on collision: whoever is constructing loses
+void GameSimulation::resolveCollision()
+{
+    bool p1Constructing = players[0].isConstructing();
+    bool p2Constructing = players[1].isConstructing();
+
+    if (p1Constructing && p2Constructing)
+    {
+        eliminate(0, "Collided with Player 2 while both constructing");
+        eliminate(1, "Collided with Player 1 while both constructing");
+    }
+    else if (p1Constructing)
+        eliminate(0, "Collided with Player 2 while constructing");
+    else if (p2Constructing)
+        eliminate(1, "Collided with Player 1 while constructing");
+}
+
+void GameSimulation::capture(int player)
+{
+    SimPlayer& pl = players[player];
+    pl.dirCol = pl.dirRow = 0;
+
+    // Only process if the player actually had a path
+    if (trailCells[player].empty())
+        return;
+
+    ScopedPhase timer(profiler, PHASE_CAPTURE);
+    int emptyTiles = 0;
+    int tilesCaptured = captureMode == CAPTURE_INCREMENTAL ? captureIncremental(player, emptyTiles)
+                                                           : captureFullScan(player, emptyTiles);
+    trailCells[player].clear();
+
+    int multiplier = 1;
+    if (tilesCaptured > 10)
+        multiplier = 2;
+    if (pl.rewardComboCount >= 3 && tilesCaptured > 5)
+        multiplier = 2;
+    if (pl.rewardComboCount >= 5 && tilesCaptured > 5)
+        multiplier = 4;
+    pl.score += tilesCaptured * multiplier;
+    if (multiplier > 1)
+        pl.rewardComboCount++;
+
+    // Award a power-up every 50 points
+    if (pl.score - pl.lastPowerUpAwardScore >= 50)
+    {
+        pl.availablePowerUps++;
+        pl.lastPowerUpAwardScore = pl.score;
+    }
+
+    // Grid completely filled: the match is over for everyone
+    if (emptyTiles == 0)
+        for (int p = 0; p < playerCount; p++)
+            players[p].running = false;
+}
+
+// Path plus enclosed empty cells that aren't enemy-connected become blue
+int GameSimulation::captureFullScan(int player, int& emptyLeft)
+{
+    // Flood fill from enemies to mark their connected area
+    for (int i = 0; i < enemyCount; i++)
+        board.markReachable(enemies[i].row(), enemies[i].col());
+    return board.captureEnclosed(trailTile(player), emptyLeft);
+}
+
+// Same result, but only the trail and the regions without an enemy are touched
+int GameSimulation::captureIncremental(int player, int& emptyLeft)
+{
+    for (int cell : trailCells[player])
+        board.set(cell / cols(), cell % cols(), TILE_BLUE);
+
+    int rows[MAX_ENEMIES], cols[MAX_ENEMIES];
+    for (int i = 0; i < enemyCount; i++)
+    {
+        rows[i] = enemies[i].row();
+        cols[i] = enemies[i].col();
+    }
+    int enclosed = regions.captureUnreached(board, rows, cols, enemyCount);
+    emptyLeft = regions.emptyCount();
+    return (int)trailCells[player].size() + enclosed;
+}
+
+void GameSimulation::checkEnemyContacts()
+{
+    for (int i = 0; i < enemyCount; i++)
+    {
+        int row = enemies[i].row();
+        int col = enemies[i].col();
+        if (col < 0 || col >= cols() || row < 0 || row >= rows())
+            continue;
+        int tile = board.get(row, col);
+        if (tile == TILE_TRAIL_P1)
+            eliminate(0, "Enemy touched Player 1's constructing tile");
+        if (tile == TILE_TRAIL_P2 && playerCount == 2)
+            eliminate(1, "Enemy touched Player 2's constructing tile");
+    }
+}
@@ -0,0 +1,170 @@
+// --- XONIX HEADLESS SIMULATION: GRID, PLAYERS, ENEMIES AND CAPTURE RULES ---
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Board.h"
+#include "RegionTracker.h"
+#include "FrameProfiler.h"
+#include "SimRandom.h"
+
+const int TILE_SIZE_PIXELS = 18;    // enemy positions are in pixels of this size
+
+const int MAX_PLAYERS = 2;
+const int MAX_ENEMIES = 10;
+
+// The simulation only ever advances in whole ticks of this length, and every
+// timer counts ticks, so a match never depends on how fast frames come
+const int SIM_TICKS_PER_SECOND = 60;
+const float SIM_TICK_SECONDS = 1.0f / SIM_TICKS_PER_SECOND;
+const int PLAYER_STEP_TICKS = 5;        // ticks between player steps (0.07 s, rounded up as the old float timer did)
+const int FREEZE_TICKS = 3 * SIM_TICKS_PER_SECOND;  // a power-up freeze lasts 3 seconds
+
+const uint64_t DEFAULT_SIM_SEED = 1;
+
+// How a capture finds the area cut off from the enemies
+enum CaptureMode
+{
+    CAPTURE_FULL_SCAN,      // fill from every enemy, then one pass over the whole board
+    CAPTURE_INCREMENTAL     // region labels kept up to date as trails are laid;
+                            // not for rollback, see restore()
+};
+
+// -------------------------------------------------------------
+// ENEMY
+// -------------------------------------------------------------
+struct Enemy
+{
+    int posX, posY;    // pixel coordinates
+    int velX, velY;    // velocity in pixels per tick
+    int lastX, lastY;  // position before the latest tick, only for drawing
+    Enemy();
+    // At (300, 300) with a random velocity of -3..4 pixels per tick on each axis
+    explicit Enemy(SimRandom& random);
+    void move(const Board& board);
+    int row() const { return posY / TILE_SIZE_PIXELS; }
+    int col() const { return posX / TILE_SIZE_PIXELS; }
+
+    // Where to draw the enemy when alpha (0..1) of the next tick has passed:
+    // between its last two positions, so motion is smooth at any frame rate
+    float drawX(float alpha) const { return lastX + (posX - lastX) * alpha; }
+    float drawY(float alpha) const { return lastY + (posY - lastY) * alpha; }
+};
+
+// -------------------------------------------------------------
+// PLAYER STATE
+// -------------------------------------------------------------
+struct SimPlayer
+{
+    int row = 0, col = 0;
+    int dirRow = 0, dirCol = 0;
+    bool running = true;
+    int score = 0, rewardComboCount = 0, availablePowerUps = 0, lastPowerUpAwardScore = 0;
+    int frozenTicks = 0;        // ticks left while frozen by the opponent's power-up
+    std::string deathReason;
+
+    bool isConstructing() const { return dirRow != 0 || dirCol != 0; }
+};
+
+// -------------------------------------------------------------
+// SNAPSHOT
+// -------------------------------------------------------------
+// Everything a tick reads or writes. Restoring one and replaying the same
+// inputs reproduces the same match. A snapshot that is saved into again
+// reuses its buffers, so once warmed up saving allocates nothing.
+struct SimSnapshot
+{
+    std::vector<Board::Word> tiles;
+    int rows = 0, cols = 0;     // of the board the tiles came from
+    SimPlayer players[MAX_PLAYERS];
+    Enemy enemies[MAX_ENEMIES];
+    std::vector<int> trailCells[MAX_PLAYERS];
+    int playerCount = 0, enemyCount = 0;
+    int stepTicks = 0, enemyFreezeTicks = 0;
+};
+
+// -------------------------------------------------------------
+// GAME SIMULATION
+// -------------------------------------------------------------
+// Owns the grid, players and enemies of one match and advances it
+// without any window, clock or keyboard. The caller feeds directions
+// and power-up presses, then calls tick() once per SIM_TICK_SECONDS.
+// Nothing outside the object is read: the same seed and the same inputs
+// on the same ticks always play out the same match.
+class GameSimulation
+{
+public:
+    SimPlayer players[MAX_PLAYERS];
+    Enemy enemies[MAX_ENEMIES];
+    int playerCount = 1;
+    int enemyCount = 4;
+
+    explicit GameSimulation(int rows = DEFAULT_ROWS, int cols = DEFAULT_COLS, uint64_t seed = DEFAULT_SIM_SEED);
+
+    // Replaces the board with one of the given size; takes effect immediately
+    void resize(int rows, int cols);
+    int rows() const { return board.rows(); }
+    int cols() const { return board.cols(); }
+    const Board& getBoard() const { return board; }
+
+    // Cells changed since the last clearDirty() are listed by
+    // getBoard().collectDirty(); the frame owner clears once every
+    // consumer (renderer, network, replay) has read them
+    void clearDirty() { board.clearDirty(); }
+
+    // Clears the board and starts a new match (1 = single player, 2 = multiplayer).
+    // Without a seed the enemies take the next numbers from the simulation's
+    // generator, so a series of matches follows from the constructor's seed.
+    void reset(int numPlayers, int numEnemies);
+    void reset(int numPlayers, int numEnemies, uint64_t matchSeed);
+
+    void setDirection(int player, int dirRow, int dirCol);
+    bool usePowerUp(int player);
+
+    // Advances the match by one tick of SIM_TICK_SECONDS
+    void tick();
+
+    // Switching to incremental labels the current board from scratch
+    void setCaptureMode(CaptureMode mode);
+    CaptureMode getCaptureMode() const { return captureMode; }
+
+    // Captures are timed under PHASE_CAPTURE while a profiler is attached
+    void setProfiler(FrameProfiler* frameProfiler) { profiler = frameProfiler; }
+
+    bool isOver() const;
+    bool enemiesFrozen() const;
+    int tileAt(int row, int col) const { return board.get(row, col); }
+
+    // Hash of the board, players, enemies and timers: two simulations fed
+    // the same inputs must agree on it tick for tick
+    uint32_t checksum() const;
+
+    // Copies the match state out, or puts a copy back. A snapshot of a board
+    // of another size is refused (false) and nothing is restored. Restoring
+    // marks the changed cells dirty. The region labels of incremental capture
+    // only ever split, so a restore that changed tiles relabels the whole
+    // board, slower than the full scan capture it replaces: a rolled back
+    // match (RollbackSession) should keep the default CAPTURE_FULL_SCAN.
+    void save(SimSnapshot& snapshot) const;
+    bool restore(const SimSnapshot& snapshot);
+
+private:
+    Board board;
+    RegionTracker regions;
+    CaptureMode captureMode = CAPTURE_FULL_SCAN;
+    FrameProfiler* profiler = nullptr;
+    std::vector<int> trailCells[MAX_PLAYERS];   // row * cols() + col of every trail tile laid
+    SimRandom random;
+    int stepTicks = 0;
+    int enemyFreezeTicks = 0;   // single player power-up
+
+    int trailTile(int player) const { return player == 0 ? TILE_TRAIL_P1 : TILE_TRAIL_P2; }
+    void eliminate(int player, const char* reason);
+    void stepPlayer(int player);
+    void resolveCollision();
+    void capture(int player);
+    int captureFullScan(int player, int& emptyLeft);
+    int captureIncremental(int player, int& emptyLeft);
+    void checkEnemyContacts();
+};
@@ -0,0 +1,260 @@
+#include "Leaderboard.h"
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+// -------------------------------------------------------------
+// TOP-K LEADERBOARD
+// -------------------------------------------------------------
+TopKLeaderboard::TopKLeaderboard(int capacity)
+    : maxEntries(max(1, capacity))
+{
+}
+
+bool TopKLeaderboard::ranksAbove(const Ranked& a, const Ranked& b)
+{
+    if (a.entry.score != b.entry.score)
+        return a.entry.score > b.entry.score;
+    if (a.entry.level != b.entry.level)
+        return a.entry.level < b.entry.level;
+    return a.sequence < b.sequence;
+}
+
+// With ranksAbove as the heap's "less", the front is the entry that
+// ranks above nothing else: the worst one
+void TopKLeaderboard::setCapacity(int capacity)
+{
+    maxEntries = max(1, capacity);
+    if ((int)heap.size() <= maxEntries)
+        return;
+    while ((int)heap.size() > maxEntries)
+    {
+        pop_heap(heap.begin(), heap.end(), ranksAbove);
+        heap.pop_back();
+    }
+    changes++;
+    sortedValid = false;
+}
+
+bool TopKLeaderboard::insert(const LeaderboardEntry& entry)
+{
+    Ranked ranked = { entry, nextSequence++ };
+    if (isFull())
+    {
+        if (!ranksAbove(ranked, heap.front()))
+            return false;
+        pop_heap(heap.begin(), heap.end(), ranksAbove);
+        heap.back() = move(ranked);
+    }
+    else
+        heap.push_back(move(ranked));
+    push_heap(heap.begin(), heap.end(), ranksAbove);
+    changes++;
+    sortedValid = false;
+    return true;
+}
+
+void TopKLeaderboard::clear()
+{
+    heap.clear();
+    changes++;
+    sortedValid = false;
+}
+
+const vector<LeaderboardEntry>& TopKLeaderboard::sorted() const
+{
+    if (!sortedValid)
+    {
+        sortScratch.assign(heap.begin(), heap.end());
+        sort(sortScratch.begin(), sortScratch.end(), ranksAbove);
+        sortedView.resize(sortScratch.size());
+        for (size_t i = 0; i < sortScratch.size(); i++)
+            sortedView[i] = sortScratch[i].entry;
+        sortedValid = true;
+    }
+    return sortedView;
+}
+
+// -------------------------------------------------------------
+// WINDOWED LEADERBOARD
+// -------------------------------------------------------------
+const int64_t SECONDS_PER_DAY = 86400;
+
+const char* windowName(LeaderboardWindow window)
+{
+    static const char* names[WINDOW_COUNT] = { "alltime", "weekly", "daily" };
+    return (window >= 0 && window < WINDOW_COUNT) ? names[window] : "?";
+}
+
+WindowedLeaderboard::WindowedLeaderboard(LeaderboardWindow window, int capacity)
+    : kind(window), entries(capacity)
+{
+    if (kind == WINDOW_ALL_TIME)
+        currentPeriod = 0;
+}
+
+int64_t WindowedLeaderboard::periodOf(LeaderboardWindow window, int64_t time)
+{
+    int64_t day = time >= 0 ? time / SECONDS_PER_DAY : (time - SECONDS_PER_DAY + 1) / SECONDS_PER_DAY;
+    if (window == WINDOW_DAILY)
+        return day;
+    if (window == WINDOW_WEEKLY)
+        return (day + 3) / 7;   // day 0, 1 Jan 1970, was a Thursday
+    return 0;
+}
+
+void WindowedLeaderboard::startPeriod(int64_t period)
+{
+    entries.clear();
+    currentPeriod = period;
+}
+
+bool WindowedLeaderboard::insert(const LeaderboardEntry& entry)
+{
+    int64_t period = periodOf(kind, entry.time);
+    if (period < currentPeriod)
+        return false;
+    if (period > currentPeriod)
+        startPeriod(period);
+    return entries.insert(entry);
+}
+
+void WindowedLeaderboard::restore(int64_t period, const LeaderboardEntry& entry)
+{
+    if (period > currentPeriod)
+        startPeriod(period);
+    if (period == currentPeriod)
+        entries.insert(entry);
+}
+
+const vector<LeaderboardEntry>& WindowedLeaderboard::sorted(int64_t now) const
+{
+    static const vector<LeaderboardEntry> noEntries;
+    if (periodOf(kind, now) != currentPeriod)
+        return noEntries;
+    return entries.sorted();
+}
+
+// -------------------------------------------------------------
+// LEADERBOARD MANAGER
+// -------------------------------------------------------------
+LeaderboardManager::LeaderboardManager(int capacity, const string& file, int levelCount)
+    : file(file), levels(max(0, levelCount))
+{
+    for (int level = 0; level <= levels; level++)
+        for (int w = 0; w < WINDOW_COUNT; w++)
+            boards.emplace_back((LeaderboardWindow)w, capacity);
+    load();
+}
+
+string LeaderboardManager::boardFile(int level, LeaderboardWindow window) const
+{
+    if (level == 0 && window == WINDOW_ALL_TIME)
+        return file;
+    size_t dot = file.rfind('.');
+    string stem = dot == string::npos ? file : file.substr(0, dot);
+    string extension = dot == string::npos ? "" : file.substr(dot);
+    return stem + "_" + (level == 0 ? string("all") : "level" + to_string(level)) + "_" + windowName(window) + extension;
+}
+
+void LeaderboardManager::load()
+{
+    for (int level = 0; level <= levels; level++)
+        for (int w = 0; w < WINDOW_COUNT; w++)
+            loadBoard(level, (LeaderboardWindow)w);
+    for (const LeaderboardEntry& entry : overall().board().sorted())
+        ranks.update(entry.username, entry.score);
+}
+
+void LeaderboardManager::loadBoard(int level, LeaderboardWindow window)
+{
+    ifstream f(boardFile(level, window));
+    if (!f.is_open())
+        return;
+    WindowedLeaderboard& board = boards[boardIndex(level, window)];
+    int64_t period = 0;
+    string line;
+    while (getline(f, line))
+    {
+        if (line.compare(0, 8, "#period,") == 0)
+        {
+            period = atoll(line.c_str() + 8);
+            continue;
+        }
+        LeaderboardEntry entry;
+        istringstream iss(line);
+        char delim;
+        iss >> entry.score >> delim;
+        getline(iss, entry.username, ',');
+        iss >> entry.level;
+        if (iss >> delim)
+            iss >> entry.time;
+        board.restore(period, entry);
+    }
+}
+
+void LeaderboardManager::save() const
+{
+    for (int level = 0; level <= levels; level++)
+        for (int w = 0; w < WINDOW_COUNT; w++)
+            saveBoard(level, (LeaderboardWindow)w);
+}
+
+void LeaderboardManager::saveBoard(int level, LeaderboardWindow window) const
+{
+    const WindowedLeaderboard& board = boards[boardIndex(level, window)];
+    ostringstream f;
+    if (window != WINDOW_ALL_TIME)
+        f << "#period," << board.period() << "\n";
+    for (const LeaderboardEntry& entry : board.board().sorted())
+        f << entry.score << "," << entry.username << "," << entry.level << "," << entry.time << "\n";
+    if (persistence)
+        persistence->writeFile(boardFile(level, window), f.str());
+    else
+        ofstream(boardFile(level, window)) << f.str();
+}
+
+bool LeaderboardManager::isHighScore(int score) const
+{
+    if (!overall().board().isFull())
+        return true;
+    return score > overall().board().minScore();
+}
+
+void LeaderboardManager::addScore(const string& username, int score, int level)
+{
+    addScore(username, score, level, (int64_t)std::time(nullptr));
+}
+
+// Only the boards the score made are saved again
+void LeaderboardManager::addScore(const string& username, int score, int level, int64_t time)
+{
+    LeaderboardEntry entry;
+    entry.username = username;
+    entry.score = score;
+    entry.level = level;
+    entry.time = time;
+    ranks.update(username, score);
+    const int targets[2] = { 0, level };
+    int targetCount = (level >= 1 && level <= levels) ? 2 : 1;
+    for (int i = 0; i < targetCount; i++)
+        for (int w = 0; w < WINDOW_COUNT; w++)
+            if (boards[boardIndex(targets[i], (LeaderboardWindow)w)].insert(entry))
+                saveBoard(targets[i], (LeaderboardWindow)w);
+}
+
+const vector<LeaderboardEntry>& LeaderboardManager::getLeaderboard(int level, LeaderboardWindow window) const
+{
+    return getLeaderboard(level, window, (int64_t)std::time(nullptr));
+}
+
+const vector<LeaderboardEntry>& LeaderboardManager::getLeaderboard(int level, LeaderboardWindow window, int64_t now) const
+{
+    static const vector<LeaderboardEntry> noEntries;
+    if (level < 0 || level > levels || window < 0 || window >= WINDOW_COUNT)
+        return noEntries;
+    return boards[boardIndex(level, window)].sorted(now);
+}
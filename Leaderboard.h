@@ -0,0 +1,173 @@
+// --- LEADERBOARDS: BOUNDED TOP-K SCORE TABLES AND THEIR FILES ---
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "PersistenceWorker.h"
+#include "RankIndex.h"
+
+const int DEFAULT_LEADERBOARD_SIZE = 1000;
+const int DEFAULT_LEVEL_COUNT = 3;      // Easy, Medium, Hard
+
+struct LeaderboardEntry
+{
+    std::string username;
+    int score;
+    int level;
+    int64_t time = 0;   // seconds since the epoch; 0 for scores from before it was kept
+};
+
+// Periods are UTC days and Monday-to-Sunday UTC weeks
+enum LeaderboardWindow
+{
+    WINDOW_ALL_TIME,
+    WINDOW_WEEKLY,
+    WINDOW_DAILY,
+    WINDOW_COUNT
+};
+
+const char* windowName(LeaderboardWindow window);
+
+// -------------------------------------------------------------
+// TOP-K LEADERBOARD
+// -------------------------------------------------------------
+// Keeps the best `capacity` entries in a min-heap with the worst entry at
+// the front, so a new score is accepted or rejected in O(log K). Higher
+// scores rank first; equal scores go to the lower level, then to whoever
+// got there first. The best-first view is sorted in O(K log K) the first
+// time it is asked for after a change and reused until the next one.
+class TopKLeaderboard
+{
+public:
+    explicit TopKLeaderboard(int capacity = DEFAULT_LEADERBOARD_SIZE);
+
+    // Shrinking drops the lowest entries
+    void setCapacity(int capacity);
+    int capacity() const { return maxEntries; }
+    int size() const { return (int)heap.size(); }
+    bool isFull() const { return (int)heap.size() >= maxEntries; }
+    int minScore() const { return heap.empty() ? 0 : heap.front().entry.score; }
+
+    // False when the entry doesn't make the board
+    bool insert(const LeaderboardEntry& entry);
+    void clear();
+
+    // Best first
+    const std::vector<LeaderboardEntry>& sorted() const;
+
+    // Changes whenever the contents do
+    uint64_t version() const { return changes; }
+
+private:
+    struct Ranked
+    {
+        LeaderboardEntry entry;
+        uint64_t sequence;      // insertion order, the last tie-break
+    };
+
+    std::vector<Ranked> heap;
+    int maxEntries;
+    uint64_t nextSequence = 0;
+    uint64_t changes = 0;
+    mutable std::vector<LeaderboardEntry> sortedView;
+    mutable std::vector<Ranked> sortScratch;
+    mutable bool sortedValid = true;
+
+    static bool ranksAbove(const Ranked& a, const Ranked& b);
+};
+
+// -------------------------------------------------------------
+// WINDOWED LEADERBOARD
+// -------------------------------------------------------------
+// A top-K board that only counts scores from the current day or week.
+// It remembers which period its entries belong to; the first score of a
+// new period empties it, and until then reads for a later time see an
+// empty board, so rolling over never looks at old scores again.
+class WindowedLeaderboard
+{
+public:
+    WindowedLeaderboard(LeaderboardWindow window, int capacity);
+
+    static int64_t periodOf(LeaderboardWindow window, int64_t time);
+
+    LeaderboardWindow window() const { return kind; }
+    int64_t period() const { return currentPeriod; }
+
+    // False for scores that don't make the board or belong to a past period
+    bool insert(const LeaderboardEntry& entry);
+    // Puts back a saved entry of the given period
+    void restore(int64_t period, const LeaderboardEntry& entry);
+
+    // Best first, as of `now`
+    const std::vector<LeaderboardEntry>& sorted(int64_t now) const;
+    const TopKLeaderboard& board() const { return entries; }
+
+private:
+    LeaderboardWindow kind;
+    int64_t currentPeriod = -1;
+    TopKLeaderboard entries;
+
+    void startPeriod(int64_t period);
+};
+
+// -------------------------------------------------------------
+// LEADERBOARD MANAGER
+// -------------------------------------------------------------
+// The leaderboards shown in game: one per level (0 = all levels) and
+// window, each bounded to `capacity` entries and saved to its own file.
+// The all-levels all-time board is leaderboard.txt, rows of
+// "score,username,level,time" best first; the others add the level and
+// window to the name (leaderboard_level2_daily.txt) and start with a
+// "#period,N" line. Alongside the boards it ranks every player's best
+// score, for "your rank" and percentile queries; that index lives in
+// memory and is seeded at startup from the accounts' best scores
+// (seedBestScore) plus leaderboard.txt.
+class LeaderboardManager
+{
+public:
+    explicit LeaderboardManager(int capacity = DEFAULT_LEADERBOARD_SIZE, const std::string& file = "leaderboard.txt",
+                                int levelCount = DEFAULT_LEVEL_COUNT);
+
+    // Saves are handed to the worker instead of written on this thread
+    void setPersistence(PersistenceWorker* worker) { persistence = worker; }
+
+    void load();
+    void save() const;
+
+    bool isHighScore(int score) const;
+    // Stamped with the current time; levels outside 1..levelCount only reach the all-levels boards
+    void addScore(const std::string& username, int score, int level);
+    void addScore(const std::string& username, int score, int level, int64_t time);
+
+    // Best first; the reference stays valid until the next addScore()
+    const std::vector<LeaderboardEntry>& getLeaderboard() const { return getLeaderboard(0, WINDOW_ALL_TIME); }
+    const std::vector<LeaderboardEntry>& getLeaderboard(int level, LeaderboardWindow window) const;
+    const std::vector<LeaderboardEntry>& getLeaderboard(int level, LeaderboardWindow window, int64_t now) const;
+    int getCount() const { return overall().board().size(); }
+    uint64_t getVersion() const { return overall().board().version(); }
+    int levelCount() const { return levels; }
+
+    // Adds a best score to the rank index only
+    void seedBestScore(const std::string& username, int score) { ranks.update(username, score); }
+
+    // Whole-population queries, O(log N)
+    int rankOf(const std::string& username) const { return ranks.rankOf(username); }
+    int bestScore(const std::string& username) const { return ranks.bestScore(username); }
+    int rankedPlayers() const { return ranks.size(); }
+    double percentile(int score) const { return ranks.percentile(score); }
+    std::vector<RankedPlayer> topRange(int offset, int count) const { return ranks.topRange(offset, count); }
+
+private:
+    std::vector<WindowedLeaderboard> boards;    // (levelCount + 1) * WINDOW_COUNT
+    RankIndex ranks;
+    std::string file;
+    int levels;
+    PersistenceWorker* persistence = nullptr;
+
+    int boardIndex(int level, LeaderboardWindow window) const { return level * WINDOW_COUNT + window; }
+    const WindowedLeaderboard& overall() const { return boards[boardIndex(0, WINDOW_ALL_TIME)]; }
+    std::string boardFile(int level, LeaderboardWindow window) const;
+    void loadBoard(int level, LeaderboardWindow window);
+    void saveBoard(int level, LeaderboardWindow window) const;
+};
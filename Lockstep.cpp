@@ -0,0 +1,147 @@
+#include "Lockstep.h"
+#include <algorithm>
+
+using namespace std;
+
+// -------------------------------------------------------------
+// INPUT BYTES
+// -------------------------------------------------------------
+uint8_t directionInput(int dirRow, int dirCol)
+{
+    if (dirRow < 0)
+        return INPUT_UP;
+    if (dirRow > 0)
+        return INPUT_DOWN;
+    if (dirCol < 0)
+        return INPUT_LEFT;
+    if (dirCol > 0)
+        return INPUT_RIGHT;
+    return INPUT_KEEP;
+}
+
+void applyInput(GameSimulation& sim, int player, uint8_t input)
+{
+    switch (input & INPUT_DIRECTION_MASK)
+    {
+    case INPUT_UP:
+        sim.setDirection(player, -1, 0);
+        break;
+    case INPUT_DOWN:
+        sim.setDirection(player, 1, 0);
+        break;
+    case INPUT_LEFT:
+        sim.setDirection(player, 0, -1);
+        break;
+    case INPUT_RIGHT:
+        sim.setDirection(player, 0, 1);
+        break;
+    }
+    if (input & INPUT_POWER_UP)
+        sim.usePowerUp(player);
+}
+
+// -------------------------------------------------------------
+// LOCKSTEP SESSION
+// -------------------------------------------------------------
+LockstepSession::LockstepSession(int inputDelay)
+    : delay(max(1, min(MAX_INPUT_DELAY, inputDelay)))
+{
+    fill(localInputs, localInputs + WINDOW, INPUT_KEEP);
+    fill(remoteInputs, remoteInputs + WINDOW, INPUT_KEEP);
+    fill(remoteKnown, remoteKnown + WINDOW, false);
+}
+
+void LockstepSession::start(GameSimulation& sim, int localSeat, uint32_t seed, int numEnemies)
+{
+    seat = localSeat == 1 ? 1 : 0;
+    sim.reset(2, numEnemies, seed);
+
+    // Nobody can have pressed anything for the first `delay` ticks
+    fill(localInputs, localInputs + WINDOW, INPUT_KEEP);
+    fill(remoteInputs, remoteInputs + WINDOW, INPUT_KEEP);
+    fill(remoteKnown, remoteKnown + WINDOW, false);
+    fill(remoteKnown, remoteKnown + delay, true);
+    simTick = 0;
+    nextLocal = delay;
+    pendingInput = INPUT_KEEP;
+    outgoing.clear();
+    outgoingFirst = nextLocal;
+    accumulator = 0;
+    waiting = false;
+    stalls = 0;
+}
+
+void LockstepSession::setLocalInput(uint8_t input)
+{
+    uint8_t direction = input & INPUT_DIRECTION_MASK;
+    if (direction != INPUT_KEEP)
+        pendingInput = (pendingInput & ~INPUT_DIRECTION_MASK) | direction;
+    pendingInput |= input & INPUT_POWER_UP;
+}
+
+bool LockstepSession::receive(uint32_t firstTick, const uint8_t* inputs, size_t count)
+{
+    // Ticks already played, or so far ahead they'd overwrite ones not yet played
+    if (firstTick < simTick || firstTick - simTick + count > (size_t)WINDOW)
+        return false;
+    for (size_t i = 0; i < count; i++)
+    {
+        int slot = (firstTick + i) & (WINDOW - 1);
+        remoteInputs[slot] = inputs[i];
+        remoteKnown[slot] = true;
+    }
+    return true;
+}
+
+int LockstepSession::update(GameSimulation& sim, float dt)
+{
+    // A long stall isn't paid back all at once: the match just runs late
+    accumulator = min(accumulator + dt, MAX_CATCHUP_TICKS * LOCKSTEP_TICK_SECONDS);
+
+    // Both sides stop on the same tick: the one the match ended on
+    int simulated = 0;
+    while (accumulator >= LOCKSTEP_TICK_SECONDS && !sim.isOver())
+    {
+        // What was pressed so far goes out for the tick `delay` ahead
+        if (nextLocal == simTick + delay)
+        {
+            if (outgoing.empty())
+                outgoingFirst = nextLocal;
+            localInputs[nextLocal & (WINDOW - 1)] = pendingInput;
+            outgoing.push_back(pendingInput);
+            pendingInput = INPUT_KEEP;
+            nextLocal++;
+        }
+
+        int slot = simTick & (WINDOW - 1);
+        if (!remoteKnown[slot])
+        {
+            if (!waiting)
+                stalls++;
+            waiting = true;
+            break;
+        }
+        waiting = false;
+
+        // Seat order, so both machines apply the same inputs the same way
+        for (int player = 0; player < 2; player++)
+            applyInput(sim, player, player == seat ? localInputs[slot] : remoteInputs[slot]);
+        sim.tick();
+
+        remoteKnown[slot] = false;
+        simTick++;
+        accumulator -= LOCKSTEP_TICK_SECONDS;
+        simulated++;
+    }
+    return simulated;
+}
+
+bool LockstepSession::takeOutgoing(uint32_t& firstTick, vector<uint8_t>& inputs)
+{
+    if (outgoing.empty())
+        return false;
+    firstTick = outgoingFirst;
+    inputs.swap(outgoing);
+    outgoing.clear();
+    return true;
+}
@@ -0,0 +1,95 @@
+// --- LOCKSTEP: TWO MACHINES ADVANCE ONE SIMULATION BY EXCHANGING ONLY INPUTS ---
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "GameSimulation.h"
+#include "FixedTimestep.h"
+
+const float LOCKSTEP_TICK_SECONDS = SIM_TICK_SECONDS;    // every tick of a networked match
+const int DEFAULT_INPUT_DELAY = 6;      // ticks between pressing a key and it taking effect
+const int MAX_INPUT_DELAY = 60;
+const int LOCKSTEP_ENEMIES = 4;         // both sides must agree, so online matches use the classic count
+
+// -------------------------------------------------------------
+// INPUT BYTES
+// -------------------------------------------------------------
+// One player's input for one tick. Most ticks are INPUT_KEEP: only direction
+// changes and power-up presses carry anything.
+const uint8_t INPUT_KEEP = 0;
+const uint8_t INPUT_UP = 1;
+const uint8_t INPUT_DOWN = 2;
+const uint8_t INPUT_LEFT = 3;
+const uint8_t INPUT_RIGHT = 4;
+const uint8_t INPUT_DIRECTION_MASK = 7;
+const uint8_t INPUT_POWER_UP = 8;
+
+uint8_t directionInput(int dirRow, int dirCol);
+// Feeds one input byte to the simulation, as the keyboard code would
+void applyInput(GameSimulation& sim, int player, uint8_t input);
+
+// -------------------------------------------------------------
+// LOCKSTEP SESSION
+// -------------------------------------------------------------
+// Runs this machine's side of a two-player match. Local input is scheduled
+// inputDelay ticks ahead and handed out by takeOutgoing() for the caller to
+// send; tick N is only simulated once the opponent's input for tick N has
+// been passed to receive(). Both sides start from the same seed and apply
+// the same inputs in seat order at fixed LOCKSTEP_TICK_SECONDS steps, so
+// they stay identical without ever sending game state. A round trip longer
+// than inputDelay ticks shows up as stalls rather than as divergence.
+class LockstepSession
+{
+public:
+    explicit LockstepSession(int inputDelay = DEFAULT_INPUT_DELAY);
+
+    // Resets the simulation for a new match and forgets every input
+    void start(GameSimulation& sim, int localSeat, uint32_t seed, int numEnemies);
+
+    // Combines with anything set since the last scheduled tick: the latest
+    // direction wins and a power-up press is kept until it is sent
+    void setLocalInput(uint8_t input);
+
+    // The opponent's inputs for ticks firstTick, firstTick + 1, ...; false
+    // (and nothing stored) if they fall outside the window being played
+    bool receive(uint32_t firstTick, const uint8_t* inputs, size_t count);
+
+    // Adds dt seconds of play and simulates every tick that is due and whose
+    // inputs are both known; returns the number of ticks simulated
+    int update(GameSimulation& sim, float dt);
+
+    // Local inputs scheduled since the last call, starting at firstTick;
+    // false when there are none
+    bool takeOutgoing(uint32_t& firstTick, std::vector<uint8_t>& inputs);
+
+    // Every tick is final here: the match is over when the simulation is
+    bool over(const GameSimulation& sim) const { return sim.isOver(); }
+
+    int localSeat() const { return seat; }
+    int inputDelay() const { return delay; }
+    uint32_t tick() const { return simTick; }
+    // How far (0..1) the clock is into the next tick, for drawing between ticks
+    float tickFraction() const { return std::min(1.0f, accumulator / LOCKSTEP_TICK_SECONDS); }
+    uint32_t confirmedTick() const { return simTick; }
+    // True while the next tick is due but the opponent's input for it isn't here
+    bool stalled() const { return waiting; }
+    int stallCount() const { return stalls; }
+
+private:
+    static const int WINDOW = 256;      // ticks of input kept, a power of two
+
+    int delay;
+    int seat = 0;
+    uint32_t simTick = 0;       // next tick to simulate
+    uint32_t nextLocal = 0;     // next tick to schedule local input for
+    uint8_t pendingInput = INPUT_KEEP;
+    uint8_t localInputs[WINDOW];
+    uint8_t remoteInputs[WINDOW];
+    bool remoteKnown[WINDOW];
+    std::vector<uint8_t> outgoing;
+    uint32_t outgoingFirst = 0;
+    float accumulator = 0;
+    bool waiting = false;
+    int stalls = 0;
+};
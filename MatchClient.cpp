@@ -0,0 +1,251 @@
+#include "MatchClient.h"
+#include <algorithm>
+#include <thread>
+
+using namespace std;
+using namespace sf;
+
+bool parseServerAddress(const string& text, string& host, unsigned short& port)
+{
+    size_t colon = text.rfind(':');
+    host = text.substr(0, colon);
+    port = DEFAULT_MATCH_PORT;
+    if (colon == string::npos)
+        return !host.empty();
+    string digits = text.substr(colon + 1);
+    if (digits.empty() || digits.size() > 5 || digits.find_first_not_of("0123456789") != string::npos)
+        return false;
+    int value = stoi(digits);
+    if (value <= 0 || value > 65535)
+        return false;
+    port = (unsigned short)value;
+    return !host.empty();
+}
+
+void MatchClient::connect(const string& host, unsigned short port, float timeoutSeconds)
+{
+    disconnect();
+    connectPort = port;
+    connectDeadline = clock.getElapsedTime().asSeconds() + timeoutSeconds;
+    state = CONNECTING;
+
+    // Resolving a name can take seconds; a lookup nobody waits for any more
+    // finishes on its own and is thrown away
+    shared_ptr<Lookup> pending = make_shared<Lookup>();
+    lookup = pending;
+    thread([pending, host]
+    {
+        pending->address = IpAddress(host);
+        pending->done = true;
+    }).detach();
+}
+
+// Moves a connection in progress along; true once it is up
+bool MatchClient::finishConnect()
+{
+    if (lookup && lookup->done)
+    {
+        IpAddress address = lookup->address;
+        lookup.reset();
+        if (address == IpAddress::None)
+        {
+            fail("Unknown match server address");
+            return false;
+        }
+        socket.setBlocking(false);
+        Socket::Status status = socket.connect(address, connectPort);
+        if (status != Socket::Done && status != Socket::NotReady)
+        {
+            fail("Could not reach the match server");
+            return false;
+        }
+    }
+    if (!lookup)
+    {
+        if (socket.getRemoteAddress() != IpAddress::None)
+        {
+            state = CONNECTED;
+            return true;
+        }
+
+        // Still connecting: a read finds nothing yet, but a refused or reset
+        // connection reports itself, so it fails now rather than at the deadline.
+        // Anything that did arrive just after connecting is kept.
+        char first;
+        size_t received = 0;
+        Socket::Status status = socket.receive(&first, 1, received);
+        if (received > 0)
+            in.append(&first, received);
+#ifdef _WIN32
+        // Winsock answers any read before the connection is up with "not
+        // connected" (Disconnected), so there only an error is conclusive
+        bool refused = status == Socket::Error;
+#else
+        bool refused = status == Socket::Error || status == Socket::Disconnected;
+#endif
+        if (refused)
+        {
+            fail("Could not reach the match server");
+            return false;
+        }
+    }
+    if (clock.getElapsedTime().asSeconds() >= connectDeadline)
+        fail("Could not reach the match server");
+    return false;
+}
+
+void MatchClient::disconnect()
+{
+    lookup.reset();
+    socket.disconnect();
+    in = FrameBuffer();
+    out.clear();
+    state = OFFLINE;
+    waiting = 0;
+    peerInputs.clear();
+    peerLeft = false;
+}
+
+void MatchClient::join(const string& username, int score)
+{
+    if (state == OFFLINE || state == FAILED)
+        return;
+    string frame;
+    MessageWriter(frame, MSG_JOIN).i32(score).str(username).finish();
+    send(frame);
+    // Joining again ends the last match; QUEUED follows once the server answers
+    if (state == MATCHED)
+        state = CONNECTED;
+    peerInputs.clear();
+    peerLeft = false;
+}
+
+void MatchClient::leave()
+{
+    if (state != QUEUED && state != MATCHED)
+        return;
+    string frame;
+    MessageWriter(frame, MSG_LEAVE).finish();
+    send(frame);
+    state = CONNECTED;
+    peerInputs.clear();
+}
+
+void MatchClient::sendInputs(uint32_t firstTick, const vector<uint8_t>& inputs)
+{
+    if (state != MATCHED)
+        return;
+    // Split so no frame goes over MAX_FRAME_PAYLOAD
+    const size_t perFrame = MAX_FRAME_PAYLOAD - 4;
+    for (size_t start = 0; start < inputs.size(); start += perFrame)
+    {
+        size_t count = min(perFrame, inputs.size() - start);
+        string frame;
+        MessageWriter(frame, MSG_INPUT).u32(firstTick + (uint32_t)start).bytes(inputs.data() + start, count).finish();
+        send(frame);
+    }
+}
+
+bool MatchClient::receiveInputs(uint32_t& firstTick, vector<uint8_t>& inputs)
+{
+    if (peerInputs.empty() || peerInputs.front().releaseAt > clock.getElapsedTime().asSeconds())
+        return false;
+    firstTick = peerInputs.front().firstTick;
+    inputs.swap(peerInputs.front().inputs);
+    peerInputs.pop_front();
+    return true;
+}
+
+void MatchClient::update()
+{
+    if (state == OFFLINE || state == FAILED)
+        return;
+    if (state == CONNECTING && !finishConnect())
+        return;
+    flush();
+
+    char chunk[1024];
+    size_t received = 0;
+    Socket::Status status;
+    while ((status = socket.receive(chunk, sizeof(chunk), received)) == Socket::Done)
+        in.append(chunk, received);
+    if (status == Socket::Disconnected || status == Socket::Error)
+    {
+        fail("Lost the connection to the match server");
+        return;
+    }
+
+    MessageType type;
+    const char* payload;
+    size_t size;
+    while (in.next(type, payload, size))
+    {
+        MessageReader reader(payload, size);
+        if (type == MSG_QUEUED)
+        {
+            waiting = (int)reader.u32();
+            if (state == CONNECTED)
+                state = QUEUED;
+        }
+        else if (type == MSG_MATCHED)
+        {
+            matched.id = reader.u32();
+            matched.seat = reader.u8();
+            matched.seed = reader.u32();
+            matched.opponentScore = reader.i32();
+            matched.opponent = reader.str();
+            if (reader.ok())
+                state = MATCHED;
+        }
+        else if (type == MSG_PEER_INPUT && state == MATCHED)
+        {
+            PeerInput batch;
+            batch.releaseAt = clock.getElapsedTime().asSeconds() + latency;
+            batch.firstTick = reader.u32();
+            size_t count;
+            const char* bytes = reader.rest(count);
+            batch.inputs.assign((const uint8_t*)bytes, (const uint8_t*)bytes + count);
+            if (reader.ok())
+                peerInputs.push_back(batch);
+        }
+        else if (type == MSG_PEER_LEFT && state == MATCHED)
+            peerLeft = true;
+        else if (type == MSG_ERROR)
+        {
+            string reason = reader.str();
+            fail(reason.empty() ? "Refused by the match server" : reason);
+            return;
+        }
+    }
+    if (in.malformed())
+        fail("Garbled reply from the match server");
+}
+
+void MatchClient::send(const string& frame)
+{
+    out += frame;
+    flush();
+}
+
+void MatchClient::flush()
+{
+    if (out.empty() || state == CONNECTING)
+        return;
+    size_t sent = 0;
+    Socket::Status status = socket.send(out.data(), out.size(), sent);
+    if (status == Socket::Disconnected || status == Socket::Error)
+    {
+        fail("Lost the connection to the match server");
+        return;
+    }
+    out.erase(0, sent);
+}
+
+void MatchClient::fail(const string& reason)
+{
+    lookup.reset();
+    socket.disconnect();
+    out.clear();
+    lastError = reason;
+    state = FAILED;
+}
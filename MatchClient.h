@@ -0,0 +1,103 @@
+// --- MATCH CLIENT: THE GAME'S CONNECTION TO THE MATCH SERVER ---
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <SFML/Network.hpp>
+#include "MatchProtocol.h"
+
+struct MatchInfo
+{
+    uint32_t id = 0;
+    int seat = 0;           // 0 or 1: which player this client controls
+    uint32_t seed = 0;      // shared by both sides of the match
+    std::string opponent;
+    int opponentScore = 0;
+};
+
+// "host" or "host:port"; false when the port isn't a number
+bool parseServerAddress(const std::string& text, std::string& host, unsigned short& port);
+
+// One non-blocking sf::TcpSocket to the match server. The game calls
+// update() once a frame; nothing here ever waits, connecting included.
+class MatchClient
+{
+public:
+    enum Status
+    {
+        OFFLINE,
+        CONNECTING, // looking the host up or waiting for the connection
+        CONNECTED,
+        QUEUED,
+        MATCHED,
+        FAILED      // lost the connection or was refused; see error()
+    };
+
+    // Returns at once: the host name is looked up on a thread of its own and
+    // update() finishes the connection, or fails as soon as it is refused
+    // and at the latest once timeoutSeconds have passed. join() may follow
+    // right away; it is sent once connected.
+    void connect(const std::string& host, unsigned short port = DEFAULT_MATCH_PORT, float timeoutSeconds = 2);
+    void disconnect();
+
+    void join(const std::string& username, int score);
+    // Leaves the queue, or the match once matched
+    void leave();
+
+    // Lockstep inputs for ticks firstTick, firstTick + 1, ..., relayed to the opponent
+    void sendInputs(uint32_t firstTick, const std::vector<uint8_t>& inputs);
+    // The opponent's next batch of inputs, once its simulated latency has passed
+    bool receiveInputs(uint32_t& firstTick, std::vector<uint8_t>& inputs);
+    bool opponentLeft() const { return peerLeft; }
+
+    // Holds every opponent input back this long before handing it out, to
+    // try lockstep over loopback as if the other player were far away
+    void setSimulatedLatency(float seconds) { latency = seconds; }
+
+    // Sends what is pending and handles what has arrived
+    void update();
+
+    Status status() const { return state; }
+    int playersWaiting() const { return waiting; }
+    const MatchInfo& match() const { return matched; }
+    const std::string& error() const { return lastError; }
+
+private:
+    // Filled in by the lookup thread, which keeps it alive if we stop waiting
+    struct Lookup
+    {
+        std::atomic<bool> done{ false };
+        sf::IpAddress address;
+    };
+
+    struct PeerInput
+    {
+        float releaseAt;    // seconds on `clock`
+        uint32_t firstTick;
+        std::vector<uint8_t> inputs;
+    };
+
+    sf::TcpSocket socket;
+    std::shared_ptr<Lookup> lookup;
+    unsigned short connectPort = 0;
+    float connectDeadline = 0;      // seconds on `clock`
+    FrameBuffer in;
+    std::string out;
+    Status state = OFFLINE;
+    int waiting = 0;
+    MatchInfo matched;
+    std::string lastError;
+    std::deque<PeerInput> peerInputs;
+    bool peerLeft = false;
+    float latency = 0;
+    sf::Clock clock;
+
+    bool finishConnect();
+    void send(const std::string& frame);
+    void flush();
+    void fail(const std::string& reason);
+};
@@ -0,0 +1,128 @@
+#include "MatchProtocol.h"
+
+using namespace std;
+
+// -------------------------------------------------------------
+// WRITER / READER
+// -------------------------------------------------------------
+MessageWriter::MessageWriter(string& out, MessageType type)
+    : out(out), start(out.size())
+{
+    out.append(2, '\0');
+    out.push_back((char)type);
+}
+
+MessageWriter& MessageWriter::u8(uint8_t value)
+{
+    out.push_back((char)value);
+    return *this;
+}
+
+MessageWriter& MessageWriter::u32(uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8)
+        out.push_back((char)(value >> shift));
+    return *this;
+}
+
+MessageWriter& MessageWriter::str(const string& value)
+{
+    size_t length = value.size() < 255 ? value.size() : 255;
+    out.push_back((char)length);
+    out.append(value, 0, length);
+    return *this;
+}
+
+MessageWriter& MessageWriter::bytes(const void* data, size_t count)
+{
+    out.append((const char*)data, count);
+    return *this;
+}
+
+bool MessageWriter::finish()
+{
+    size_t payload = out.size() - start - FRAME_HEADER;
+    if (payload > MAX_FRAME_PAYLOAD)
+    {
+        out.resize(start);
+        return false;
+    }
+    out[start] = (char)(payload & 0xFF);
+    out[start + 1] = (char)(payload >> 8);
+    return true;
+}
+
+uint8_t MessageReader::u8()
+{
+    if (pos + 1 > size)
+    {
+        valid = false;
+        return 0;
+    }
+    return (uint8_t)data[pos++];
+}
+
+uint32_t MessageReader::u32()
+{
+    if (pos + 4 > size)
+    {
+        valid = false;
+        return 0;
+    }
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++)
+        value |= (uint32_t)(uint8_t)data[pos++] << (8 * i);
+    return value;
+}
+
+string MessageReader::str()
+{
+    size_t length = u8();
+    if (!valid || pos + length > size)
+    {
+        valid = false;
+        return string();
+    }
+    string value(data + pos, length);
+    pos += length;
+    return value;
+}
+
+const char* MessageReader::rest(size_t& count)
+{
+    count = size - pos;
+    const char* tail = data + pos;
+    pos = size;
+    return tail;
+}
+
+// -------------------------------------------------------------
+// FRAME BUFFER
+// -------------------------------------------------------------
+bool FrameBuffer::next(MessageType& type, const char*& payload, size_t& size)
+{
+    // Drop what earlier frames used once it's worth moving the rest down
+    if (consumed > 0 && consumed >= buffer.size() / 2)
+    {
+        buffer.erase(0, consumed);
+        consumed = 0;
+    }
+    if (broken || buffered() < FRAME_HEADER)
+        return false;
+
+    const unsigned char* header = (const unsigned char*)buffer.data() + consumed;
+    size_t length = header[0] | (size_t)header[1] << 8;
+    if (length > MAX_FRAME_PAYLOAD)
+    {
+        broken = true;
+        return false;
+    }
+    if (buffered() < FRAME_HEADER + length)
+        return false;
+
+    type = (MessageType)header[2];
+    payload = buffer.data() + consumed + FRAME_HEADER;
+    size = length;
+    consumed += FRAME_HEADER + length;
+    return true;
+}
@@ -0,0 +1,99 @@
+// --- MATCHMAKING PROTOCOL: BINARY MESSAGES BETWEEN GAME CLIENTS AND THE MATCH SERVER ---
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+const unsigned short DEFAULT_MATCH_PORT = 47800;
+
+// Every message is one frame: a little-endian uint16 payload length, a
+// uint8 message type, then the payload. Integers are little-endian and
+// strings are a uint8 length followed by that many bytes.
+const size_t FRAME_HEADER = 3;
+const size_t MAX_FRAME_PAYLOAD = 1024;
+
+enum MessageType : uint8_t
+{
+    // client -> server
+    MSG_JOIN = 1,        // int32 score, string username
+    MSG_LEAVE = 2,       // (empty); also ends a match in progress
+    MSG_INPUT = 3,       // uint32 first tick, then one lockstep input byte per tick
+
+    // server -> client
+    MSG_QUEUED = 16,     // uint32 players waiting
+    MSG_MATCHED = 17,    // uint32 match id, uint8 seat (0 or 1), uint32 seed, int32 opponent score, string opponent
+    MSG_ERROR = 18,      // string reason
+    MSG_PEER_INPUT = 19, // the opponent's MSG_INPUT payload, relayed unchanged
+    MSG_PEER_LEFT = 20   // (empty) the opponent disconnected or left the match
+};
+
+// -------------------------------------------------------------
+// WRITER / READER
+// -------------------------------------------------------------
+// Builds one frame in `out`: construct, append fields, then finish()
+class MessageWriter
+{
+public:
+    MessageWriter(std::string& out, MessageType type);
+
+    MessageWriter& u8(uint8_t value);
+    MessageWriter& u32(uint32_t value);
+    MessageWriter& i32(int32_t value) { return u32((uint32_t)value); }
+    // Longer strings are cut to 255 bytes
+    MessageWriter& str(const std::string& value);
+    MessageWriter& bytes(const void* data, size_t count);
+
+    // Fills in the length; false if the payload is over MAX_FRAME_PAYLOAD
+    bool finish();
+
+private:
+    std::string& out;
+    size_t start;
+};
+
+// Reads the fields of one payload; any read past the end sets ok() false
+class MessageReader
+{
+public:
+    MessageReader(const char* payload, size_t size) : data(payload), size(size) {}
+
+    uint8_t u8();
+    uint32_t u32();
+    int32_t i32() { return (int32_t)u32(); }
+    std::string str();
+    // Whatever is left of the payload
+    const char* rest(size_t& count);
+
+    bool ok() const { return valid; }
+    bool atEnd() const { return pos == size; }
+
+private:
+    const char* data;
+    size_t size;
+    size_t pos = 0;
+    bool valid = true;
+};
+
+// -------------------------------------------------------------
+// FRAME BUFFER
+// -------------------------------------------------------------
+// Bytes received from a stream socket, cut into whole frames
+class FrameBuffer
+{
+public:
+    void append(const char* bytes, size_t count) { buffer.append(bytes, count); }
+
+    // The next complete frame, if one has arrived. The payload pointer is
+    // valid until the next append() or next(). False with malformed() set
+    // when the peer sent a frame larger than MAX_FRAME_PAYLOAD.
+    bool next(MessageType& type, const char*& payload, size_t& size);
+    bool malformed() const { return broken; }
+
+    size_t buffered() const { return buffer.size() - consumed; }
+
+private:
+    std::string buffer;
+    size_t consumed = 0;
+    bool broken = false;
+};
@@ -0,0 +1,438 @@
+#include "MatchServer.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+using namespace std;
+
+const size_t MAX_PENDING_OUTPUT = 256 * 1024;  // a client this far behind is dropped
+const int MAX_EVENTS = 256;
+
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int SEND_FLAGS = 0;
+#endif
+
+static const chrono::steady_clock::time_point serverEpoch = chrono::steady_clock::now();
+
+static bool makeNonBlocking(int socket)
+{
+    int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+MatchServer::MatchServer(const MatchmakingRules& rules)
+    : rules(rules), matchmaker(rules)
+{
+    int pipeEnds[2];
+    if (pipe(pipeEnds) == 0)
+    {
+        wakeRead = pipeEnds[0];
+        wakeWrite = pipeEnds[1];
+        makeNonBlocking(wakeRead);
+        makeNonBlocking(wakeWrite);
+    }
+#ifdef __linux__
+    poller = epoll_create1(0);
+    if (poller >= 0 && wakeRead >= 0)
+    {
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = wakeRead;
+        epoll_ctl(poller, EPOLL_CTL_ADD, wakeRead, &event);
+    }
+#endif
+}
+
+MatchServer::~MatchServer()
+{
+    for (auto& entry : clients)
+        close(entry.first);
+    if (listener >= 0)
+        close(listener);
+    if (poller >= 0)
+        close(poller);
+    if (wakeRead >= 0)
+        close(wakeRead);
+    if (wakeWrite >= 0)
+        close(wakeWrite);
+}
+
+bool MatchServer::listen(unsigned short port, bool loopbackOnly)
+{
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0)
+        return false;
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(loopbackOnly ? INADDR_LOOPBACK : INADDR_ANY);
+    if (::bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || ::listen(listener, SOMAXCONN) != 0 ||
+        !makeNonBlocking(listener))
+    {
+        close(listener);
+        listener = -1;
+        return false;
+    }
+
+    socklen_t length = sizeof(address);
+    getsockname(listener, (sockaddr*)&address, &length);
+    boundPort = ntohs(address.sin_port);
+    watch(listener, true, false);
+    nextPass = now() + matchInterval;
+    return true;
+}
+
+void MatchServer::run()
+{
+    while (!stopping)
+        poll(1000);
+}
+
+void MatchServer::stop()
+{
+    stopping = true;
+    if (wakeWrite >= 0)
+    {
+        char byte = 0;
+        (void)!write(wakeWrite, &byte, 1);
+    }
+}
+
+double MatchServer::now() const
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - serverEpoch).count();
+}
+
+// -------------------------------------------------------------
+// EVENT LOOP
+// -------------------------------------------------------------
+void MatchServer::poll(int timeoutMs)
+{
+    double untilPass = nextPass - now();
+    timeoutMs = max(0, min(timeoutMs, (int)(untilPass * 1000) + 1));
+
+    // Sockets that became ready, and whether each may be written
+    vector<pair<int, bool>> ready;
+#ifdef __linux__
+    if (poller >= 0)
+    {
+        epoll_event events[MAX_EVENTS];
+        int count = epoll_wait(poller, events, MAX_EVENTS, timeoutMs);
+        for (int i = 0; i < count; i++)
+        {
+            int socket = events[i].data.fd;
+            ready.push_back({ socket, (events[i].events & EPOLLOUT) != 0 });
+        }
+    }
+    else
+#endif
+    {
+        vector<pollfd> fds;
+        fds.reserve(clients.size() + 2);
+        fds.push_back({ listener, POLLIN, 0 });
+        if (wakeRead >= 0)
+            fds.push_back({ wakeRead, POLLIN, 0 });
+        for (auto& entry : clients)
+            fds.push_back({ entry.first, (short)(POLLIN | (entry.second.wantsWrite ? POLLOUT : 0)), 0 });
+        if (::poll(fds.data(), fds.size(), timeoutMs) > 0)
+            for (const pollfd& fd : fds)
+                if (fd.revents)
+                    ready.push_back({ fd.fd, (fd.revents & POLLOUT) != 0 });
+    }
+
+    for (const pair<int, bool>& event : ready)
+    {
+        int socket = event.first;
+        if (socket == listener)
+            acceptClients();
+        else if (socket == wakeRead)
+        {
+            char drain[64];
+            while (read(wakeRead, drain, sizeof(drain)) > 0)
+            {
+            }
+        }
+        else if (clients.count(socket))
+        {
+            if (event.second)
+                writeTo(socket);
+            if (clients.count(socket))
+                readFrom(socket);
+        }
+    }
+
+    if (now() >= nextPass)
+    {
+        runMatchPass();
+        nextPass = now() + matchInterval;
+    }
+}
+
+// Adds a socket to the epoll set, or changes whether it waits to write;
+// poll() rebuilds its list from `clients` every time instead
+void MatchServer::watch(int socket, bool added, bool writable)
+{
+#ifdef __linux__
+    if (poller >= 0)
+    {
+        epoll_event event = {};
+        event.events = writable ? EPOLLIN | EPOLLOUT : EPOLLIN;
+        event.data.fd = socket;
+        epoll_ctl(poller, added ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, socket, &event);
+    }
+#endif
+    auto it = clients.find(socket);
+    if (it != clients.end())
+        it->second.wantsWrite = writable;
+}
+
+void MatchServer::acceptClients()
+{
+    while (true)
+    {
+        int socket = accept(listener, nullptr, nullptr);
+        if (socket < 0)
+            return;
+        int noDelay = 1;
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+#ifdef SO_NOSIGPIPE
+        int noSigPipe = 1;
+        setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+        if (!makeNonBlocking(socket))
+        {
+            close(socket);
+            continue;
+        }
+        clients[socket];
+        watch(socket, true, false);
+    }
+}
+
+void MatchServer::readFrom(int socket)
+{
+    char chunk[4096];
+    while (true)
+    {
+        ssize_t received = recv(socket, chunk, sizeof(chunk), 0);
+        if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        {
+            drop(socket);
+            return;
+        }
+        if (received < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        clients[socket].in.append(chunk, (size_t)received);
+    }
+
+    MessageType type;
+    const char* payload;
+    size_t size;
+    while (clients.count(socket) && clients[socket].in.next(type, payload, size))
+        handle(socket, type, payload, size);
+    auto it = clients.find(socket);
+    if (it != clients.end() && it->second.in.malformed())
+        drop(socket);
+}
+
+void MatchServer::writeTo(int socket)
+{
+    Client& client = clients[socket];
+    size_t sent = 0;
+    while (sent < client.out.size())
+    {
+        ssize_t count = ::send(socket, client.out.data() + sent, client.out.size() - sent, SEND_FLAGS);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                drop(socket);
+                return;
+            }
+            break;
+        }
+        sent += (size_t)count;
+    }
+    client.out.erase(0, sent);
+    if (client.out.empty() == client.wantsWrite)
+        watch(socket, false, !client.out.empty());
+}
+
+// -------------------------------------------------------------
+// MESSAGES
+// -------------------------------------------------------------
+void MatchServer::handle(int socket, MessageType type, const char* payload, size_t size)
+{
+    Client& client = clients[socket];
+    MessageReader reader(payload, size);
+    if (type == MSG_INPUT)
+    {
+        if (client.peer >= 0)
+        {
+            string frame;
+            MessageWriter(frame, MSG_PEER_INPUT).bytes(payload, size).finish();
+            send(client.peer, frame);
+        }
+    }
+    else if (type == MSG_JOIN)
+    {
+        unpair(socket);
+        int score = reader.i32();
+        string username = reader.str();
+        if (!reader.ok() || username.empty())
+        {
+            sendError(socket, "Malformed join");
+            return;
+        }
+        auto existing = byName.find(username);
+        if (existing != byName.end() && existing->second != socket)
+        {
+            sendError(socket, "Already queued");
+            return;
+        }
+        if (!client.username.empty())
+        {
+            matchmaker.leave(client.username);
+            byName.erase(client.username);
+        }
+        client.username = username;
+        byName[username] = socket;
+        matchmaker.enqueue(username, score, socket, now());
+
+        string frame;
+        MessageWriter(frame, MSG_QUEUED).u32((uint32_t)matchmaker.waiting()).finish();
+        send(socket, frame);
+    }
+    else if (type == MSG_LEAVE)
+    {
+        unpair(socket);
+        if (!client.username.empty())
+        {
+            matchmaker.leave(client.username);
+            byName.erase(client.username);
+            client.username.clear();
+        }
+    }
+    else
+        drop(socket);
+}
+
+void MatchServer::send(int socket, string frame)
+{
+    auto it = clients.find(socket);
+    if (it == clients.end())
+        return;
+    Client& client = it->second;
+    if (client.out.size() + frame.size() > MAX_PENDING_OUTPUT)
+    {
+        drop(socket);
+        return;
+    }
+    client.out += frame;
+    if (!client.wantsWrite)
+        writeTo(socket);
+}
+
+void MatchServer::sendError(int socket, const string& reason)
+{
+    string frame;
+    MessageWriter(frame, MSG_ERROR).str(reason).finish();
+    send(socket, frame);
+}
+
+void MatchServer::drop(int socket)
+{
+    auto it = clients.find(socket);
+    if (it == clients.end())
+        return;
+    if (!it->second.username.empty())
+    {
+        matchmaker.leave(it->second.username);
+        byName.erase(it->second.username);
+    }
+    unpair(socket);
+    clients.erase(socket);
+    close(socket);  // also takes it out of the epoll set
+}
+
+// Ends the socket's match, if it is in one, and tells the opponent
+void MatchServer::unpair(int socket)
+{
+    auto it = clients.find(socket);
+    if (it == clients.end() || it->second.peer < 0)
+        return;
+    int peer = it->second.peer;
+    it->second.peer = -1;
+    auto other = clients.find(peer);
+    if (other == clients.end())
+        return;
+    other->second.peer = -1;
+    string frame;
+    MessageWriter(frame, MSG_PEER_LEFT).finish();
+    send(peer, frame);
+}
+
+void MatchServer::runMatchPass()
+{
+    matches.clear();
+    matchmaker.runBatch(now(), matches);
+    for (const MatchPair& pair : matches)
+    {
+        uint32_t matchId = nextMatchId++;
+        uint32_t seed = seeds.next();
+
+        const QueuePlayer* seats[2] = { &pair.first, &pair.second };
+        for (int seat = 0; seat < 2; seat++)
+        {
+            int socket = seats[seat]->id;
+            const QueuePlayer& opponent = *seats[1 - seat];
+            auto it = clients.find(socket);
+            if (it == clients.end())
+                continue;
+            byName.erase(it->second.username);
+            it->second.username.clear();
+
+            string frame;
+            MessageWriter(frame, MSG_MATCHED).u32(matchId).u8((uint8_t)seat).u32(seed)
+                .i32(opponent.score).str(opponent.username).finish();
+            send(socket, frame);
+        }
+
+        // Both still here: relay their inputs to each other from now on
+        auto first = clients.find(pair.first.id);
+        auto second = clients.find(pair.second.id);
+        if (first != clients.end() && second != clients.end())
+        {
+            first->second.peer = pair.second.id;
+            second->second.peer = pair.first.id;
+        }
+        else if (first != clients.end() || second != clients.end())
+        {
+            int left = first != clients.end() ? pair.first.id : pair.second.id;
+            string frame;
+            MessageWriter(frame, MSG_PEER_LEFT).finish();
+            send(left, frame);
+        }
+    }
+}
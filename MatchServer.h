@@ -0,0 +1,83 @@
+// --- MATCH SERVER: THE MATCHMAKING QUEUE AS A TCP DAEMON ---
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Matchmaking.h"
+#include "MatchProtocol.h"
+#include "SizedTreap.h"
+
+// Game clients connect over TCP, send MSG_JOIN with their username and
+// score, and are told MSG_MATCHED once the skill matchmaker has paired
+// them. The two stay paired afterwards: each one's MSG_INPUT is relayed to
+// the other for the lockstep match, until either leaves or disconnects.
+// One thread runs everything: non-blocking sockets behind epoll (poll()
+// where there is no epoll), so thousands of queued clients cost one event
+// loop. A client that disconnects leaves the queue. POSIX only.
+class MatchServer
+{
+public:
+    explicit MatchServer(const MatchmakingRules& rules = MatchmakingRules());
+    ~MatchServer();
+    MatchServer(const MatchServer&) = delete;
+    MatchServer& operator=(const MatchServer&) = delete;
+
+    // Listens on all interfaces (loopbackOnly: 127.0.0.1); port 0 picks a free one
+    bool listen(unsigned short port, bool loopbackOnly = false);
+    unsigned short port() const { return boundPort; }
+
+    // Seconds between matchmaking passes
+    void setMatchInterval(double seconds) { matchInterval = seconds; }
+
+    // Serves until stop() is called, from this or any other thread (or a
+    // signal handler)
+    void run();
+    void stop();
+    bool stopRequested() const { return stopping; }
+    // Handles whatever is ready, waiting at most timeoutMs for something to be
+    void poll(int timeoutMs);
+
+    int connections() const { return (int)clients.size(); }
+    int waiting() const { return matchmaker.waiting(); }
+    const SkillMatchmaker& getMatchmaker() const { return matchmaker; }
+
+private:
+    struct Client
+    {
+        FrameBuffer in;
+        std::string out;
+        std::string username;   // empty until MSG_JOIN
+        int peer = -1;          // the opponent's socket while in a match
+        bool wantsWrite = false;
+    };
+
+    MatchmakingRules rules;
+    SkillMatchmaker matchmaker;
+    std::unordered_map<int, Client> clients;    // by socket
+    std::unordered_map<std::string, int, UsernameHash, UsernameEqual> byName;
+    std::vector<MatchPair> matches;
+    int listener = -1;
+    int poller = -1;            // epoll instance, -1 when using poll()
+    int wakeRead = -1, wakeWrite = -1;
+    unsigned short boundPort = 0;
+    double matchInterval = 0.25;
+    double nextPass = 0;
+    uint32_t nextMatchId = 1;
+    XorShift32 seeds{ 0x2545F491u };
+    std::atomic<bool> stopping{ false };
+
+    double now() const;
+    void watch(int socket, bool added, bool writable);
+    void acceptClients();
+    void readFrom(int socket);
+    void writeTo(int socket);
+    void handle(int socket, MessageType type, const char* payload, size_t size);
+    void send(int socket, std::string frame);
+    void sendError(int socket, const std::string& reason);
+    void drop(int socket);
+    void unpair(int socket);
+    void runMatchPass();
+};
@@ -0,0 +1,464 @@
+#include "Matchmaking.h"
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+// -------------------------------------------------------------
+// PRIORITY QUEUE
+// -------------------------------------------------------------
+void PriorityQueue::push(const string& username, int score, int id)
+{
+    removePlayer(username);
+
+    int ticket;
+    if (freeTickets.empty())
+    {
+        ticket = (int)tickets.size();
+        tickets.push_back(Ticket());
+    }
+    else
+    {
+        ticket = freeTickets.back();
+        freeTickets.pop_back();
+    }
+    Ticket& t = tickets[ticket];
+    t.player = { username, score, id };
+    t.sequence = nextSequence++;
+    byName.emplace(username, ticket);
+
+    heap.push_back(ticket);
+    t.heapSlot = (int)heap.size() - 1;
+    siftUp(t.heapSlot);
+    tree.insert(ticket, [this](int a, int b) { return before(a, b); });
+}
+
+bool PriorityQueue::pop(QueuePlayer& player)
+{
+    if (heap.empty())
+        return false;
+    player = tickets[heap[0]].player;
+    removeTicket(heap[0]);
+    return true;
+}
+
+bool PriorityQueue::peek(QueuePlayer& player) const
+{
+    if (heap.empty())
+        return false;
+    player = tickets[heap[0]].player;
+    return true;
+}
+
+void PriorityQueue::reserve(int expectedPlayers)
+{
+    tickets.reserve(expectedPlayers);
+    tree.reserve(expectedPlayers);
+    heap.reserve(expectedPlayers);
+    byName.reserve(expectedPlayers);
+}
+
+bool PriorityQueue::removePlayer(const string& username)
+{
+    auto it = byName.find(username);
+    if (it == byName.end())
+        return false;
+    removeTicket(it->second);
+    return true;
+}
+
+int PriorityQueue::getPlayerPosition(const string& username) const
+{
+    auto it = byName.find(username);
+    if (it == byName.end())
+        return -1;
+    int key = it->second;
+    int position = 1;
+    for (int t = tree.root(); t >= 0;)
+    {
+        if (t == key)
+            return position + tree.sizeOf(tree.left(t));
+        if (before(t, key))
+        {
+            position += tree.sizeOf(tree.left(t)) + 1;
+            t = tree.right(t);
+        }
+        else
+            t = tree.left(t);
+    }
+    return -1;
+}
+
+int PriorityQueue::getPlayersAbove(const string& username) const
+{
+    auto it = byName.find(username);
+    if (it == byName.end())
+        return -1;
+    int score = tickets[it->second].player.score;
+    int count = 0;
+    for (int t = tree.root(); t >= 0;)
+    {
+        if (tickets[t].player.score > score)
+        {
+            count += tree.sizeOf(tree.left(t)) + 1;
+            t = tree.right(t);
+        }
+        else
+            t = tree.left(t);
+    }
+    return count;
+}
+
+// Best first: the higher score, then the one queued earlier
+bool PriorityQueue::before(int a, int b) const
+{
+    if (tickets[a].player.score != tickets[b].player.score)
+        return tickets[a].player.score > tickets[b].player.score;
+    return tickets[a].sequence < tickets[b].sequence;
+}
+
+void PriorityQueue::removeTicket(int ticket)
+{
+    tree.erase(ticket, [this](int a, int b) { return before(a, b); });
+
+    // Move the last heap entry into its slot and restore the heap either way
+    int slot = tickets[ticket].heapSlot;
+    int last = heap.back();
+    heap.pop_back();
+    if (last != ticket)
+    {
+        placeInHeap(slot, last);
+        siftUp(slot);
+        siftDown(tickets[last].heapSlot);
+    }
+
+    byName.erase(tickets[ticket].player.username);
+    tickets[ticket].player.username.clear();
+    freeTickets.push_back(ticket);
+}
+
+// -------------------------------------------------------------
+// HEAP
+// -------------------------------------------------------------
+void PriorityQueue::placeInHeap(int slot, int ticket)
+{
+    heap[slot] = ticket;
+    tickets[ticket].heapSlot = slot;
+}
+
+void PriorityQueue::siftUp(int slot)
+{
+    int ticket = heap[slot];
+    while (slot > 0)
+    {
+        int parent = (slot - 1) / 2;
+        if (!before(ticket, heap[parent]))
+            break;
+        placeInHeap(slot, heap[parent]);
+        slot = parent;
+    }
+    placeInHeap(slot, ticket);
+}
+
+void PriorityQueue::siftDown(int slot)
+{
+    int ticket = heap[slot];
+    int size = (int)heap.size();
+    while (true)
+    {
+        int child = 2 * slot + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && before(heap[child + 1], heap[child]))
+            child++;
+        if (!before(heap[child], ticket))
+            break;
+        placeInHeap(slot, heap[child]);
+        slot = child;
+    }
+    placeInHeap(slot, ticket);
+}
+
+// -------------------------------------------------------------
+// SKILL MATCHMAKER
+// -------------------------------------------------------------
+SkillMatchmaker::SkillMatchmaker(const MatchmakingRules& rules)
+    : rules(rules)
+{
+    this->rules.bucketWidth = max(1, rules.bucketWidth);
+}
+
+bool SkillMatchmaker::enqueue(const string& username, int score, int id, double now)
+{
+    if (contains(username))
+        return false;
+
+    int ticket;
+    if (freeTickets.empty())
+    {
+        ticket = (int)tickets.size();
+        tickets.push_back(Waiting());
+    }
+    else
+    {
+        ticket = freeTickets.back();
+        freeTickets.pop_back();
+    }
+    Waiting& w = tickets[ticket];
+    w.player = { username, score, id };
+    w.since = now;
+    w.sequence = nextSequence++;
+    w.active = true;
+    w.bucket = bucketOf(score);
+    if (w.bucket >= (int)buckets.size())
+        buckets.resize(w.bucket + 1);
+    w.bucketSlot = (int)buckets[w.bucket].size();
+    buckets[w.bucket].push_back(ticket);
+
+    byName.emplace(username, ticket);
+    // Players who leave stay in arrivals until the next pass; drop them
+    // here too so a queue nobody matches from doesn't keep growing
+    if (arrivals.size() > 2 * byName.size() + 64)
+        dropStaleArrivals();
+    arrivals.push_back({ ticket, w.sequence });
+    return true;
+}
+
+bool SkillMatchmaker::leave(const string& username)
+{
+    auto it = byName.find(username);
+    if (it == byName.end())
+        return false;
+    removeTicket(it->second);
+    return true;
+}
+
+uint64_t SkillMatchmaker::ticketOf(const string& username) const
+{
+    auto it = byName.find(username);
+    return it == byName.end() ? NO_TICKET : tickets[it->second].sequence;
+}
+
+void SkillMatchmaker::reserve(int expectedPlayers)
+{
+    tickets.reserve(expectedPlayers);
+    byName.reserve(expectedPlayers);
+    arrivals.reserve(expectedPlayers);
+}
+
+int SkillMatchmaker::windowAfter(double waited) const
+{
+    if (waited >= rules.maxWait)
+        return INT32_MAX;
+    return rules.initialWindow + (int)(rules.windowGrowth * max(0.0, waited));
+}
+
+int SkillMatchmaker::runBatch(double now, vector<MatchPair>& matches)
+{
+    int made = 0;
+    size_t kept = 0;
+    for (size_t i = 0; i < arrivals.size(); i++)
+    {
+        int ticket = arrivals[i].first;
+        const Waiting& w = tickets[ticket];
+        if (!w.active || w.sequence != arrivals[i].second)
+            continue;
+
+        int opponent = closestOpponent(ticket, windowAfter(now - w.since));
+        if (opponent < 0)
+        {
+            arrivals[kept++] = arrivals[i];
+            continue;
+        }
+
+        const Waiting& o = tickets[opponent];
+        MatchPair pair = { w.player, o.player, (float)(now - w.since), (float)(now - o.since),
+                           w.since, o.since, w.sequence, o.sequence };
+        recordWait(pair.firstWait);
+        recordWait(pair.secondWait);
+        matches.push_back(pair);
+        made++;
+        // Tickets freed here aren't reused before the pass ends, so the
+        // opponent's own arrival entry is recognised as stale
+        removeTicket(ticket);
+        removeTicket(opponent);
+    }
+    arrivals.resize(kept);
+    matchCount += made;
+    return made;
+}
+
+float SkillMatchmaker::waitPercentile(double percent) const
+{
+    if (waits.empty())
+        return 0;
+    vector<float> sorted(waits);
+    size_t k = min(sorted.size() - 1, (size_t)(percent / 100.0 * sorted.size()));
+    nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    return sorted[k];
+}
+
+void SkillMatchmaker::resetStats()
+{
+    matchCount = 0;
+    waits.clear();
+    nextWaitSample = 0;
+}
+
+void SkillMatchmaker::dropStaleArrivals()
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < arrivals.size(); i++)
+    {
+        const Waiting& w = tickets[arrivals[i].first];
+        if (w.active && w.sequence == arrivals[i].second)
+            arrivals[kept++] = arrivals[i];
+    }
+    arrivals.resize(kept);
+}
+
+int SkillMatchmaker::bucketOf(int score) const
+{
+    return max(0, score) / rules.bucketWidth;
+}
+
+// Closest score within `window` of this player's, -1 if none. Bucket
+// b + d only holds scores more than (d - 1) * bucketWidth away, so the
+// search stops once the best found is no farther than that.
+int SkillMatchmaker::closestOpponent(int ticket, int window) const
+{
+    const Waiting& w = tickets[ticket];
+    int score = w.player.score;
+    long long low = (long long)score - window;
+    long long high = min((long long)score + window, (long long)INT32_MAX);
+    int lowest = low <= 0 ? 0 : bucketOf((int)low);
+    int highest = min((int)buckets.size() - 1, bucketOf((int)high));
+
+    int best = -1;
+    long long bestGap = (long long)window + 1;
+    for (int d = 0; w.bucket - d >= lowest || w.bucket + d <= highest; d++)
+    {
+        for (int side = 0; side < (d == 0 ? 1 : 2); side++)
+        {
+            int b = side == 0 ? w.bucket + d : w.bucket - d;
+            if (b < lowest || b > highest)
+                continue;
+            for (int candidate : buckets[b])
+            {
+                if (candidate == ticket)
+                    continue;
+                long long gap = llabs((long long)tickets[candidate].player.score - score);
+                if (gap < bestGap)
+                {
+                    bestGap = gap;
+                    best = candidate;
+                    if (gap == 0)
+                        return best;
+                }
+            }
+        }
+        if (best >= 0 && bestGap <= (long long)d * rules.bucketWidth)
+            break;
+    }
+    return best;
+}
+
+void SkillMatchmaker::removeTicket(int ticket)
+{
+    Waiting& w = tickets[ticket];
+    vector<int>& bucket = buckets[w.bucket];
+    int moved = bucket.back();
+    bucket[w.bucketSlot] = moved;
+    tickets[moved].bucketSlot = w.bucketSlot;
+    bucket.pop_back();
+
+    byName.erase(w.player.username);
+    w.player.username.clear();
+    w.active = false;
+    freeTickets.push_back(ticket);
+}
+
+void SkillMatchmaker::recordWait(float seconds)
+{
+    if ((int)waits.size() < WAIT_SAMPLES)
+        waits.push_back(seconds);
+    else
+        waits[nextWaitSample] = seconds;
+    nextWaitSample = (nextWaitSample + 1) % WAIT_SAMPLES;
+}
+
+// -------------------------------------------------------------
+// MATCHMAKING SYSTEM
+// -------------------------------------------------------------
+MatchmakingSystem::MatchmakingSystem(const MatchmakingRules& rules)
+    : matchmaker(rules), start(chrono::steady_clock::now())
+{
+}
+
+double MatchmakingSystem::now() const
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+void MatchmakingSystem::addPlayer(const string& username, int score, int playerID)
+{
+    queue.push(username, score, playerID);
+    matchmaker.leave(username);
+    matchmaker.enqueue(username, score, playerID, now());
+    tickets[username] = matchmaker.ticketOf(username);
+}
+
+bool MatchmakingSystem::removePlayer(const string& username)
+{
+    matchmaker.leave(username);
+    tickets.erase(username);
+    return queue.removePlayer(username);
+}
+
+// Still queued under the same ticket the pair was made with
+bool MatchmakingSystem::stillWaiting(const QueuePlayer& player, uint64_t ticket) const
+{
+    auto it = tickets.find(player.username);
+    return it != tickets.end() && it->second == ticket;
+}
+
+// Back into the matchmaker as if never taken out: same score, same wait
+void MatchmakingSystem::putBack(const QueuePlayer& player, double since)
+{
+    matchmaker.enqueue(player.username, player.score, player.id, since);
+    tickets[player.username] = matchmaker.ticketOf(player.username);
+}
+
+bool MatchmakingSystem::createMatch(QueuePlayer& player1, QueuePlayer& player2)
+{
+    while (true)
+    {
+        if (pending.empty())
+        {
+            batch.clear();
+            if (!canMatch() || matchmaker.runBatch(now(), batch) == 0)
+                return false;
+            pending.insert(pending.end(), batch.begin(), batch.end());
+        }
+        MatchPair pair = pending.front();
+        pending.pop_front();
+
+        bool firstWaiting = stillWaiting(pair.first, pair.firstTicket);
+        bool secondWaiting = stillWaiting(pair.second, pair.secondTicket);
+        if (!firstWaiting || !secondWaiting)
+        {
+            if (firstWaiting)
+                putBack(pair.first, pair.firstSince);
+            if (secondWaiting)
+                putBack(pair.second, pair.secondSince);
+            continue;
+        }
+        tickets.erase(pair.first.username);
+        tickets.erase(pair.second.username);
+        queue.removePlayer(pair.first.username);
+        queue.removePlayer(pair.second.username);
+        player1 = pair.first;
+        player2 = pair.second;
+        return true;
+    }
+}
@@ -0,0 +1,210 @@
+// --- MATCHMAKING: PLAYERS WAITING FOR A MULTIPLAYER MATCH ---
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "AccountStore.h"
+#include "SizedTreap.h"
+
+struct QueuePlayer
+{
+    std::string username;
+    int score;
+    int id;
+};
+
+// -------------------------------------------------------------
+// PRIORITY QUEUE
+// -------------------------------------------------------------
+// Highest score first, then whoever queued first. Every queued player
+// has one ticket that sits in two structures at once: a binary heap for
+// pop/peek, and a treap in the same order whose nodes know their subtree
+// sizes, for queue positions. A hash index from the username to its
+// ticket makes removal, position and players-above O(log N) instead of
+// a scan, and there is no fixed capacity. Usernames are case-insensitive,
+// as in AuthManager.
+class PriorityQueue
+{
+public:
+    // A player already queued is moved to their new score, at the back of it
+    void push(const std::string& username, int score, int id);
+    bool pop(QueuePlayer& player);
+    bool peek(QueuePlayer& player) const;
+
+    int getSize() const { return (int)heap.size(); }
+    bool isEmpty() const { return heap.empty(); }
+    bool contains(const std::string& username) const { return byName.count(username) != 0; }
+    void reserve(int expectedPlayers);
+
+    // False when the player isn't queued
+    bool removePlayer(const std::string& username);
+
+    // 1 = next to be matched; -1 when not queued
+    int getPlayerPosition(const std::string& username) const;
+    // Queued players with a strictly higher score; -1 when not queued
+    int getPlayersAbove(const std::string& username) const;
+
+private:
+    struct Ticket
+    {
+        QueuePlayer player;
+        uint64_t sequence;  // queue order, the tie-break between equal scores
+        int heapSlot;
+    };
+
+    std::vector<Ticket> tickets;
+    std::vector<int> freeTickets;
+    std::vector<int> heap;      // ticket numbers, best at the front
+    std::unordered_map<std::string, int, UsernameHash, UsernameEqual> byName;
+    SizedTreap tree;
+    uint64_t nextSequence = 0;
+
+    bool before(int a, int b) const;
+    void removeTicket(int ticket);
+
+    void placeInHeap(int slot, int ticket);
+    void siftUp(int slot);
+    void siftDown(int slot);
+};
+
+// -------------------------------------------------------------
+// SKILL MATCHMAKER
+// -------------------------------------------------------------
+// How far apart two players' scores may be. A player who has waited
+// `w` seconds accepts opponents within initialWindow + windowGrowth * w
+// points, and anyone at all after maxWait, so nobody waits longer than
+// maxWait plus one batch interval while someone else is queued.
+struct MatchmakingRules
+{
+    int bucketWidth = 100;          // score range of one bucket
+    int initialWindow = 100;
+    float windowGrowth = 50;        // points per second of waiting
+    float maxWait = 30;
+};
+
+struct MatchPair
+{
+    QueuePlayer first, second;
+    float firstWait, secondWait;    // seconds each had been queued
+    double firstSince, secondSince;     // when each was queued, on the caller's clock
+    uint64_t firstTicket, secondTicket; // each one's place in the queue, as ticketOf() gave it
+};
+
+// Waiting players sorted into buckets by score (their
+// auth.getPlayerScore total). runBatch() is meant to be called
+// periodically: it walks the queue longest-waiting first and pairs each
+// player with the closest score inside their current window, searching
+// outward from their own bucket and stopping as soon as no further
+// bucket can hold a closer score. Times are seconds on any clock the
+// caller likes, so the same rules run in game and in benchmarks.
+class SkillMatchmaker
+{
+public:
+    explicit SkillMatchmaker(const MatchmakingRules& rules = MatchmakingRules());
+
+    const MatchmakingRules& getRules() const { return rules; }
+
+    // False if the player is already waiting. `now` is when they count as
+    // queued from, so a player put back keeps the wait they had.
+    bool enqueue(const std::string& username, int score, int id, double now);
+    // False when the player isn't waiting
+    bool leave(const std::string& username);
+    bool contains(const std::string& username) const { return byName.count(username) != 0; }
+    int waiting() const { return (int)byName.size(); }
+    void reserve(int expectedPlayers);
+
+    // Identifies this stay in the queue: a player who leaves and queues
+    // again gets a new one. NO_TICKET when the player isn't waiting.
+    static const uint64_t NO_TICKET = UINT64_MAX;
+    uint64_t ticketOf(const std::string& username) const;
+
+    // Score difference a player accepts after waiting this long
+    int windowAfter(double waited) const;
+
+    // Appends this pass's pairs to `matches` and returns how many it made
+    int runBatch(double now, std::vector<MatchPair>& matches);
+
+    // Over every match since the last resetStats(); waits are kept for
+    // the most recent WAIT_SAMPLES players matched
+    static const int WAIT_SAMPLES = 1 << 16;
+    long long matchesMade() const { return matchCount; }
+    float waitPercentile(double percent) const;
+    void resetStats();
+
+private:
+    struct Waiting
+    {
+        QueuePlayer player;
+        double since;
+        uint64_t sequence;  // arrival order; tells a reused ticket from the one queued before it
+        int bucket;
+        int bucketSlot;
+        bool active;
+    };
+
+    MatchmakingRules rules;
+    std::vector<Waiting> tickets;
+    std::vector<int> freeTickets;
+    std::vector<std::vector<int>> buckets;
+    std::unordered_map<std::string, int, UsernameHash, UsernameEqual> byName;
+    std::vector<std::pair<int, uint64_t>> arrivals;     // (ticket, sequence), oldest first; may hold stale entries
+    uint64_t nextSequence = 0;
+
+    long long matchCount = 0;
+    std::vector<float> waits;
+    int nextWaitSample = 0;
+
+    int bucketOf(int score) const;
+    int closestOpponent(int ticket, int window) const;
+    void dropStaleArrivals();
+    void removeTicket(int ticket);
+    void recordWait(float seconds);
+};
+
+// -------------------------------------------------------------
+// MATCHMAKING SYSTEM
+// -------------------------------------------------------------
+// The queue screen's view (position, players ahead) comes from the
+// priority queue; who plays whom comes from the skill matchmaker, on
+// a clock that starts with the system. A batch pass can find more pairs
+// than one createMatch() hands out; the rest wait in `pending`, and a
+// pair one side of which has left (or queued again since) is dropped
+// with the other side put back in the matchmaker, keeping their wait.
+class MatchmakingSystem
+{
+public:
+    explicit MatchmakingSystem(const MatchmakingRules& rules = MatchmakingRules());
+
+    void addPlayer(const std::string& username, int score, int playerID);
+
+    bool canMatch() const { return queue.getSize() >= 2; }
+    // The next pair the skill matchmaker found, running a batch pass if
+    // none is pending; false while nobody is close enough yet
+    bool createMatch(QueuePlayer& player1, QueuePlayer& player2);
+
+    int getQueueSize() const { return queue.getSize(); }
+    bool getTopPlayer(QueuePlayer& player) const { return queue.peek(player); }
+
+    bool removePlayer(const std::string& username);
+    int getPlayerPosition(const std::string& username) const { return queue.getPlayerPosition(username); }
+    int getPlayersAbove(const std::string& username) const { return queue.getPlayersAbove(username); }
+
+    const SkillMatchmaker& getMatchmaker() const { return matchmaker; }
+
+private:
+    PriorityQueue queue;
+    SkillMatchmaker matchmaker;
+    std::vector<MatchPair> batch;
+    std::deque<MatchPair> pending;
+    // Matchmaker ticket of every queued player, pending pairs included
+    std::unordered_map<std::string, uint64_t, UsernameHash, UsernameEqual> tickets;
+    std::chrono::steady_clock::time_point start;
+
+    double now() const;
+    bool stillWaiting(const QueuePlayer& player, uint64_t ticket) const;
+    void putBack(const QueuePlayer& player, double since);
+};
@@ -0,0 +1,181 @@
+#include "PersistenceWorker.h"
+#include <cstdio>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+void syncFile(FILE* f)
+{
+    fflush(f);
+#ifdef _WIN32
+    _commit(_fileno(f));
+#else
+    fsync(fileno(f));
+#endif
+}
+
+void syncDirectoryOf(const string& path)
+{
+#ifndef _WIN32
+    size_t slash = path.find_last_of('/');
+    string directory = slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = open(directory.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    fsync(fd);
+    close(fd);
+#else
+    (void)path;
+#endif
+}
+
+PersistenceWorker::PersistenceWorker(size_t maxPendingFiles)
+    : maxPending(maxPendingFiles > 0 ? maxPendingFiles : 1)
+{
+    thread = std::thread(&PersistenceWorker::run, this);
+}
+
+PersistenceWorker::~PersistenceWorker()
+{
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    workAvailable.notify_one();
+    thread.join();
+}
+
+void PersistenceWorker::writeFile(const string& path, string contents, bool syncAfter, function<void(bool)> done)
+{
+    enqueue(path, true, move(contents), syncAfter, move(done));
+}
+
+void PersistenceWorker::buildFile(const string& path, function<bool(string&)> build, bool syncAfter,
+                                  function<void(bool)> done)
+{
+    enqueue(path, true, string(), syncAfter, move(done), move(build));
+}
+
+void PersistenceWorker::appendFile(const string& path, const string& text, bool syncAfter)
+{
+    enqueue(path, false, text, syncAfter);
+}
+
+void PersistenceWorker::enqueue(const string& path, bool replace, string data, bool sync, function<void(bool)> done,
+                                function<bool(string&)> build)
+{
+    unique_lock<mutex> lock(queueMutex);
+    auto it = pending.find(path);
+    if (it == pending.end())
+    {
+        spaceAvailable.wait(lock, [this] { return order.size() < maxPending; });
+        Pending& write = pending[path];
+        write.replace = replace;
+        write.sync = sync;
+        write.data = move(data);
+        write.build = move(build);
+        if (done)
+            write.done.push_back(move(done));
+        order.push_back(path);
+        lock.unlock();
+        workAvailable.notify_one();
+        return;
+    }
+
+    // Already waiting: a rewrite supersedes it, an append extends it
+    Pending& write = it->second;
+    if (replace)
+    {
+        write.replace = true;
+        write.data = move(data);
+        write.build = move(build);
+    }
+    else
+        write.data += data;
+    write.sync = write.sync || sync;
+    if (done)
+        write.done.push_back(move(done));
+    coalesced++;
+}
+
+void PersistenceWorker::flush()
+{
+    unique_lock<mutex> lock(queueMutex);
+    drained.wait(lock, [this] { return order.empty() && !busy; });
+}
+
+long long PersistenceWorker::coalescedWrites() const
+{
+    lock_guard<mutex> lock(queueMutex);
+    return coalesced;
+}
+
+void PersistenceWorker::run()
+{
+    unique_lock<mutex> lock(queueMutex);
+    while (true)
+    {
+        workAvailable.wait(lock, [this] { return stopping || !order.empty(); });
+        if (order.empty())
+            return;     // stopping, and nothing left to write
+
+        string path = order.front();
+        order.pop_front();
+        Pending write = move(pending[path]);
+        pending.erase(path);
+        busy = true;
+        lock.unlock();
+        spaceAvailable.notify_one();
+
+        bool written = perform(path, write);
+        for (const function<void(bool)>& done : write.done)
+            done(written);
+
+        lock.lock();
+        busy = false;
+        if (order.empty())
+            drained.notify_all();
+    }
+}
+
+bool PersistenceWorker::perform(const string& path, Pending& write)
+{
+    if (write.build)
+    {
+        string contents;
+        if (!write.build(contents))
+            return false;
+        contents += write.data;     // appends queued after it
+        write.data.swap(contents);
+    }
+
+    // A rewrite goes to a temporary file first, so a crash mid-write
+    // leaves the previous version intact
+    string target = write.replace ? path + ".tmp" : path;
+    FILE* f = fopen(target.c_str(), write.replace ? "wb" : "ab");
+    if (!f)
+        return false;
+    bool written = fwrite(write.data.data(), 1, write.data.size(), f) == write.data.size();
+    fflush(f);
+    if (write.sync)
+        syncFile(f);
+    written = fclose(f) == 0 && written;
+    if (write.replace)
+    {
+        if (!written)
+            return false;
+#ifdef _WIN32
+        remove(path.c_str());
+#endif
+        if (rename(target.c_str(), path.c_str()) != 0)
+            return false;
+        if (write.sync)
+            syncDirectoryOf(path);
+    }
+    return written;
+}
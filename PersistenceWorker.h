@@ -0,0 +1,84 @@
+// --- PERSISTENCE WORKER: FILE WRITES MOVED OFF THE FRAME THREAD ---
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Pushes what was written to an open file through to the disk (fsync)
+void syncFile(FILE* f);
+// Makes a rename or a new file in the directory holding `path` survive a
+// crash; POSIX only, NTFS journals the rename itself
+void syncDirectoryOf(const std::string& path);
+
+// One background thread that performs the file writes the game queues.
+// Writes are grouped per file: a whole-file rewrite replaces anything
+// still pending for that file (only the newest leaderboard or profile
+// snapshot matters), and appends are concatenated, so a burst of saves
+// at game over becomes one write per file. At most maxPendingFiles files
+// can be waiting; a caller queuing another one blocks until the worker
+// catches up. Any thread may queue; the destructor writes everything
+// still pending before it returns.
+//
+// A rewrite can say when it is done: `done` runs on the worker thread with
+// true once the file is in place, false if it could not be written. A
+// rewrite superseded by a newer one for the same file is done when that
+// one is.
+class PersistenceWorker
+{
+public:
+    explicit PersistenceWorker(size_t maxPendingFiles = 64);
+    ~PersistenceWorker();
+    PersistenceWorker(const PersistenceWorker&) = delete;
+    PersistenceWorker& operator=(const PersistenceWorker&) = delete;
+
+    // Replaces the file (through a temporary file and a rename); syncAfter
+    // also fsyncs the temporary file before the rename and the directory after
+    void writeFile(const std::string& path, std::string contents, bool syncAfter = false,
+                   std::function<void(bool)> done = nullptr);
+    // The same, but the contents are made on the worker thread: build fills
+    // them in, or returns false to give the rewrite up. It runs after
+    // everything queued before it, and must only read what its caller
+    // leaves alone until done has run.
+    void buildFile(const std::string& path, std::function<bool(std::string&)> build, bool syncAfter = false,
+                   std::function<void(bool)> done = nullptr);
+    // Appends to the file; syncAfter also fsyncs it once written
+    void appendFile(const std::string& path, const std::string& text, bool syncAfter = false);
+
+    // Blocks until everything queued so far is on disk (handed to the OS)
+    void flush();
+
+    // Queued writes that were merged into another write for the same file
+    long long coalescedWrites() const;
+
+private:
+    struct Pending
+    {
+        bool replace = false;   // rewrite the whole file rather than append
+        bool sync = false;
+        std::string data;
+        std::function<bool(std::string&)> build;    // makes what goes before data
+        std::vector<std::function<void(bool)>> done;
+    };
+
+    mutable std::mutex queueMutex;
+    std::condition_variable workAvailable, spaceAvailable, drained;
+    std::deque<std::string> order;      // files in the order they were first queued
+    std::unordered_map<std::string, Pending> pending;
+    size_t maxPending;
+    bool busy = false;
+    bool stopping = false;
+    long long coalesced = 0;
+    std::thread thread;
+
+    void enqueue(const std::string& path, bool replace, std::string data, bool sync,
+                 std::function<void(bool)> done = nullptr, std::function<bool(std::string&)> build = nullptr);
+    void run();
+    static bool perform(const std::string& path, Pending& write);
+};
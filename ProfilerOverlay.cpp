@@ -0,0 +1,41 @@
+#include "ProfilerOverlay.h"
+#include <cstdio>
+
+using namespace std;
+using namespace sf;
+
+const unsigned OVERLAY_TEXT_SIZE = 12;
+const float OVERLAY_LINE_HEIGHT = 16;
+const float OVERLAY_PADDING = 6;
+const float OVERLAY_COLUMN_X[3] = { 0, 90, 150 };   // phase name, p50, p99
+
+static void drawCell(RenderTarget& target, Text& text, Vector2f topLeft, int column, int line, Color color)
+{
+    text.setFillColor(color);
+    text.setPosition(topLeft.x + OVERLAY_PADDING + OVERLAY_COLUMN_X[column],
+                     topLeft.y + OVERLAY_PADDING + OVERLAY_LINE_HEIGHT * line);
+    target.draw(text);
+}
+
+void drawProfilerOverlay(RenderTarget& target, TextCache& texts, const FrameProfiler& profiler, Vector2f topLeft)
+{
+    RectangleShape background(Vector2f(PROFILER_OVERLAY_WIDTH, OVERLAY_PADDING * 2 + OVERLAY_LINE_HEIGHT * (PHASE_COUNT + 1)));
+    background.setPosition(topLeft);
+    background.setFillColor(Color(0, 0, 0, 180));
+    target.draw(background);
+
+    Color headerColor(255, 255, 120);
+    drawCell(target, texts.get("profiler.header", profiler.recordingCsv() ? "ms  [CSV]" : "ms", OVERLAY_TEXT_SIZE), topLeft, 0, 0, headerColor);
+    drawCell(target, texts.get("profiler.p50Header", "p50", OVERLAY_TEXT_SIZE), topLeft, 1, 0, headerColor);
+    drawCell(target, texts.get("profiler.p99Header", "p99", OVERLAY_TEXT_SIZE), topLeft, 2, 0, headerColor);
+
+    char value[16];
+    for (int p = 0; p < PHASE_COUNT; p++)
+    {
+        drawCell(target, texts.get("profiler.phase", p, phaseName(p), OVERLAY_TEXT_SIZE), topLeft, 0, p + 1, Color::White);
+        snprintf(value, sizeof(value), "%.2f", profiler.p50(p) / 1000.0);
+        drawCell(target, texts.get("profiler.p50", p, value, OVERLAY_TEXT_SIZE), topLeft, 1, p + 1, Color::White);
+        snprintf(value, sizeof(value), "%.2f", profiler.p99(p) / 1000.0);
+        drawCell(target, texts.get("profiler.p99", p, value, OVERLAY_TEXT_SIZE), topLeft, 2, p + 1, Color::White);
+    }
+}
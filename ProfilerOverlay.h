@@ -0,0 +1,13 @@
+// --- PROFILER OVERLAY: p50 / p99 FRAME TIMES DRAWN OVER THE GAME ---
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include "FrameProfiler.h"
+#include "TextCache.h"
+
+const float PROFILER_OVERLAY_WIDTH = 220;
+
+// Draws one line per phase with its median and 99th percentile time in
+// milliseconds. The numbers only move when the profiler refreshes its
+// summary, so the labels are re-laid out a couple of times per second.
+void drawProfilerOverlay(sf::RenderTarget& target, TextCache& texts, const FrameProfiler& profiler, sf::Vector2f topLeft);
@@ -0,0 +1,139 @@
+#include "RankIndex.h"
+
+using namespace std;
+
+bool RankIndex::update(const string& username, int score)
+{
+    auto it = byName.find(username);
+    int node;
+    if (it == byName.end())
+    {
+        node = (int)nodes.size();
+        nodes.push_back(Node());
+        nodes[node].player = (int)players.size();
+        players.push_back({ username, node });
+        byName.emplace(username, nodes[node].player);
+    }
+    else
+    {
+        node = players[it->second].node;
+        if (score <= nodes[node].score)
+            return false;
+
+        tree.erase(node, [this](int a, int b) { return before(a, b); });
+    }
+
+    nodes[node].score = score;
+    nodes[node].sequence = nextSequence++;
+    tree.insert(node, [this](int a, int b) { return before(a, b); });
+    return true;
+}
+
+void RankIndex::reserve(int expectedPlayers)
+{
+    nodes.reserve(expectedPlayers);
+    tree.reserve(expectedPlayers);
+    players.reserve(expectedPlayers);
+    byName.reserve(expectedPlayers);
+}
+
+int RankIndex::rankOf(const string& username) const
+{
+    auto it = byName.find(username);
+    if (it == byName.end())
+        return 0;
+    return countAbove(nodes[players[it->second].node].score) + 1;
+}
+
+int RankIndex::bestScore(const string& username) const
+{
+    auto it = byName.find(username);
+    return it == byName.end() ? -1 : nodes[players[it->second].node].score;
+}
+
+int RankIndex::countAbove(int score) const
+{
+    int count = 0;
+    for (int t = tree.root(); t >= 0;)
+    {
+        if (nodes[t].score > score)
+        {
+            count += tree.sizeOf(tree.left(t)) + 1;
+            t = tree.right(t);
+        }
+        else
+            t = tree.left(t);
+    }
+    return count;
+}
+
+int RankIndex::countAtLeast(int score) const
+{
+    return score == INT32_MIN ? size() : countAbove(score - 1);
+}
+
+double RankIndex::percentile(int score) const
+{
+    if (players.empty())
+        return 0;
+    return 100.0 * (size() - countAtLeast(score)) / size();
+}
+
+vector<RankedPlayer> RankIndex::topRange(int offset, int count) const
+{
+    vector<RankedPlayer> page;
+    if (offset < 0 || count <= 0 || offset >= size())
+        return page;
+
+    // Walk down to the offset-th node, stacking the nodes whose left
+    // subtree we enter; they are exactly the ones still to come in order
+    vector<int> stack;
+    int skip = offset;
+    for (int t = tree.root(); t >= 0;)
+    {
+        int leftSize = tree.sizeOf(tree.left(t));
+        if (skip < leftSize)
+        {
+            stack.push_back(t);
+            t = tree.left(t);
+        }
+        else if (skip == leftSize)
+        {
+            stack.push_back(t);
+            break;
+        }
+        else
+        {
+            skip -= leftSize + 1;
+            t = tree.right(t);
+        }
+    }
+
+    page.reserve(min(count, size() - offset));
+    while (!stack.empty() && (int)page.size() < count)
+    {
+        int t = stack.back();
+        stack.pop_back();
+        const Node& n = nodes[t];
+        int rank;
+        if (page.empty())
+            rank = countAbove(n.score) + 1;
+        else if (n.score == page.back().score)
+            rank = page.back().rank;
+        else
+            rank = offset + (int)page.size() + 1;
+        page.push_back({ players[n.player].username, n.score, rank });
+
+        for (int c = tree.right(t); c >= 0; c = tree.left(c))
+            stack.push_back(c);
+    }
+    return page;
+}
+
+// Best first: the higher score, then the one reached earlier
+bool RankIndex::before(int a, int b) const
+{
+    if (nodes[a].score != nodes[b].score)
+        return nodes[a].score > nodes[b].score;
+    return nodes[a].sequence < nodes[b].sequence;
+}
@@ -0,0 +1,69 @@
+// --- RANK INDEX: EVERY PLAYER'S BEST SCORE IN AN ORDER-STATISTIC TREE ---
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "AccountStore.h"
+#include "SizedTreap.h"
+
+struct RankedPlayer
+{
+    std::string username;
+    int score;
+    int rank;   // 1 = best; players with equal scores share a rank
+};
+
+// Holds one entry per player, their best score, in a treap ordered best
+// first (higher score, then whoever reached it first). Every node knows
+// the size of its subtree, so ranks, percentiles and the start of any
+// page of the table are found in O(log N) and updates stay O(log N)
+// however many players there are. Usernames are case-insensitive, as in
+// AuthManager.
+class RankIndex
+{
+public:
+    // Raises a player's best score, adding the player if new; returns
+    // false (and changes nothing) if the score isn't an improvement
+    bool update(const std::string& username, int score);
+
+    int size() const { return (int)players.size(); }
+    void reserve(int expectedPlayers);
+
+    // 0 when the player has no score yet
+    int rankOf(const std::string& username) const;
+    // -1 when the player has no score yet
+    int bestScore(const std::string& username) const;
+
+    // Players whose best is strictly higher / at least this high
+    int countAbove(int score) const;
+    int countAtLeast(int score) const;
+
+    // Share of players, in percent, whose best is below this score
+    double percentile(int score) const;
+
+    // Up to `count` players starting at position `offset` (0 = best)
+    std::vector<RankedPlayer> topRange(int offset, int count) const;
+
+private:
+    struct Node
+    {
+        int score;
+        uint32_t sequence;  // when the score was reached, the tie-break
+        int player;
+    };
+    struct PlayerInfo
+    {
+        std::string username;
+        int node;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<PlayerInfo> players;
+    std::unordered_map<std::string, int, UsernameHash, UsernameEqual> byName;
+    SizedTreap tree;
+    uint32_t nextSequence = 0;
+
+    bool before(int a, int b) const;
+};
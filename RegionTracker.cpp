@@ -0,0 +1,287 @@
+#include "RegionTracker.h"
+#include <algorithm>
+
+using namespace std;
+
+const int UNLABELLED = -2;
+
+void RegionTracker::reset(const Board& board)
+{
+    rows = board.rows();
+    cols = board.cols();
+    label.assign(rows * cols, -1);
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            if (board.get(i, j) == TILE_EMPTY)
+                label[i * cols + j] = UNLABELLED;
+
+    regionSize.clear();
+    regionCell.clear();
+    live.clear();
+    liveSlot.clear();
+    freeLabels.clear();
+    removed.clear();
+    emptyCells = 0;
+    filler.reserve(rows, cols);
+    for (int cell = 0; cell < rows * cols; cell++)
+    {
+        if (label[cell] != UNLABELLED)
+            continue;
+        int size = filler.fill(label.data(), rows, cols, cell / cols, cell % cols, UNLABELLED, (int)regionSize.size());
+        newRegion(size, cell);
+        emptyCells += size;
+    }
+
+    mark.assign(rows * cols, -1);
+    nextSearch = 0;
+    reachedStamp.clear();
+    stamp = 0;
+}
+
+void RegionTracker::removeCell(int row, int col)
+{
+    int cell = row * cols + col;
+    if (label[cell] < 0)
+        return;
+    int region = label[cell];
+    emptyCells--;
+    label[cell] = -1;
+    removed.push_back(cell);
+    if (--regionSize[region] == 0)
+        dropRegion(region);
+}
+
+// A label for a region of `size` cells, one of which is `cell`; labels of
+// regions that are gone are reused, so the label count follows the number
+// of live regions rather than every split since reset()
+int RegionTracker::newRegion(int size, int cell)
+{
+    int region;
+    if (freeLabels.empty())
+    {
+        region = (int)regionSize.size();
+        regionSize.push_back(0);
+        regionCell.push_back(0);
+        liveSlot.push_back(-1);
+    }
+    else
+    {
+        region = freeLabels.back();
+        freeLabels.pop_back();
+    }
+    regionSize[region] = size;
+    regionCell[region] = cell;
+    liveSlot[region] = (int)live.size();
+    live.push_back(region);
+    return region;
+}
+
+void RegionTracker::dropRegion(int region)
+{
+    int slot = liveSlot[region];
+    live[slot] = live.back();
+    liveSlot[live[slot]] = slot;
+    live.pop_back();
+    liveSlot[region] = -1;
+    regionSize[region] = 0;
+    freeLabels.push_back(region);
+}
+
+// -------------------------------------------------------------
+// SPLIT DETECTION
+// -------------------------------------------------------------
+void RegionTracker::update()
+{
+    if (removed.empty())
+        return;
+
+    // Empty neighbours of every removed cell, grouped by the region they were in
+    seeds.clear();
+    for (int cell : removed)
+    {
+        int row = cell / cols, col = cell % cols;
+        if (row > 0 && label[cell - cols] >= 0)
+            seeds.push_back({ label[cell - cols], cell - cols });
+        if (row < rows - 1 && label[cell + cols] >= 0)
+            seeds.push_back({ label[cell + cols], cell + cols });
+        if (col > 0 && label[cell - 1] >= 0)
+            seeds.push_back({ label[cell - 1], cell - 1 });
+        if (col < cols - 1 && label[cell + 1] >= 0)
+            seeds.push_back({ label[cell + 1], cell + 1 });
+    }
+    removed.clear();
+    sort(seeds.begin(), seeds.end());
+    seeds.erase(unique(seeds.begin(), seeds.end()), seeds.end());
+
+    for (size_t first = 0; first < seeds.size();)
+    {
+        size_t last = first;
+        while (last < seeds.size() && seeds[last].first == seeds[first].first)
+            last++;
+        splitRegion(seeds[first].first, &seeds[first], (int)(last - first));
+        first = last;
+    }
+}
+
+int RegionTracker::find(int search)
+{
+    while (parent[search] != search)
+    {
+        parent[search] = parent[parent[search]];
+        search = parent[search];
+    }
+    return search;
+}
+
+void RegionTracker::splitRegion(int region, const pair<int, int>* first, int count)
+{
+    if (count == 1)
+    {
+        regionCell[region] = first[0].second;
+        return;
+    }
+
+    int base = nextSearch;
+    nextSearch += count;
+    if ((int)queue.size() < count)
+        queue.resize(count);
+    head.assign(count, 0);
+    parent.resize(count);
+    busy.assign(count, 0);
+    done.assign(count, 0);
+    for (int s = 0; s < count; s++)
+    {
+        parent[s] = s;
+        queue[s].clear();
+        queue[s].push_back(first[s].second);
+        mark[first[s].second] = base + s;
+    }
+
+    while (true)
+    {
+        // A group whose searches have all run dry is a complete region of its
+        // own; stop once at most one group is still growing; it keeps the old label
+        fill(busy.begin(), busy.end(), 0);
+        for (int s = 0; s < count; s++)
+            if (head[s] < (int)queue[s].size())
+                busy[find(s)] = 1;
+        int growing = 0, lastGrowing = -1;
+        for (int s = 0; s < count; s++)
+        {
+            if (find(s) != s || done[s])
+                continue;
+            if (busy[s])
+            {
+                growing++;
+                lastGrowing = s;
+            }
+            else
+                takeGroup(region, s, count);
+        }
+        if (growing <= 1)
+        {
+            // Every group finishing on the same step leaves the old label empty
+            if (lastGrowing >= 0)
+                regionCell[region] = queue[lastGrowing][0];
+            else
+                dropRegion(region);
+            return;
+        }
+
+        // One step of every search still growing
+        for (int s = 0; s < count; s++)
+        {
+            if (head[s] >= (int)queue[s].size())
+                continue;
+            int cell = queue[s][head[s]++];
+            int row = cell / cols, col = cell % cols;
+            int next[4] = { row > 0 ? cell - cols : -1, row < rows - 1 ? cell + cols : -1,
+                            col > 0 ? cell - 1 : -1, col < cols - 1 ? cell + 1 : -1 };
+            for (int n : next)
+            {
+                if (n < 0 || label[n] != region)
+                    continue;
+                if (mark[n] >= base)
+                {
+                    int a = find(s), b = find(mark[n] - base);
+                    if (a != b)
+                        parent[b] = a;
+                }
+                else
+                {
+                    mark[n] = base + s;
+                    queue[s].push_back(n);
+                }
+            }
+        }
+    }
+}
+
+// Moves every cell reached by the searches of one finished group to a new label
+void RegionTracker::takeGroup(int region, int root, int count)
+{
+    int size = 0;
+    for (int s = 0; s < count; s++)
+        if (find(s) == root)
+            size += (int)queue[s].size();
+    int split = newRegion(size, queue[root][0]);
+    for (int s = 0; s < count; s++)
+        if (find(s) == root)
+            for (int cell : queue[s])
+                label[cell] = split;
+    regionSize[region] -= size;
+    done[root] = 1;
+}
+
+// -------------------------------------------------------------
+// CAPTURE
+// -------------------------------------------------------------
+int RegionTracker::captureUnreached(Board& board, const int* cellRows, const int* cellCols, int count)
+{
+    update();
+
+    stamp++;
+    reachedStamp.resize(regionSize.size(), 0);
+    for (int i = 0; i < count; i++)
+    {
+        if (cellRows[i] < 0 || cellRows[i] >= rows || cellCols[i] < 0 || cellCols[i] >= cols)
+            continue;
+        int region = label[cellRows[i] * cols + cellCols[i]];
+        if (region >= 0)
+            reachedStamp[region] = stamp;
+    }
+
+    // Walk each unreached region from its known cell, reusing the first search queue
+    int captured = 0;
+    if (queue.empty())
+        queue.resize(1);
+    vector<int>& cells = queue[0];
+    // Backwards, so dropping a region only moves one already visited into its slot
+    for (int i = (int)live.size() - 1; i >= 0; i--)
+    {
+        int region = live[i];
+        if (reachedStamp[region] == stamp)
+            continue;
+        cells.clear();
+        cells.push_back(regionCell[region]);
+        label[regionCell[region]] = -1;
+        for (size_t k = 0; k < cells.size(); k++)
+        {
+            int cell = cells[k];
+            int row = cell / cols, col = cell % cols;
+            board.set(row, col, TILE_BLUE);
+            int next[4] = { row > 0 ? cell - cols : -1, row < rows - 1 ? cell + cols : -1,
+                            col > 0 ? cell - 1 : -1, col < cols - 1 ? cell + 1 : -1 };
+            for (int n : next)
+                if (n >= 0 && label[n] == region)
+                {
+                    label[n] = -1;
+                    cells.push_back(n);
+                }
+        }
+        captured += regionSize[region];
+        emptyCells -= regionSize[region];
+        dropRegion(region);
+    }
+    return captured;
+}
@@ -0,0 +1,61 @@
+// --- INCREMENTAL REGION TRACKING: LABELLED EMPTY REGIONS KEPT UP TO DATE AS TRAILS ARE LAID ---
+#pragma once
+
+#include <vector>
+#include "Board.h"
+#include "FloodFill.h"
+
+// Every empty cell carries the label of its connected empty region. Cells only
+// ever leave the empty set during a match, so regions only split: a removed
+// cell is queued, and update() checks whether its empty neighbours are still
+// connected by growing one search per neighbour in lock-step. Searches that
+// meet are merged with union-find, and the search stops as soon as at most one
+// unfinished group is left, so a split costs the size of the smaller side(s)
+// rather than the size of the board.
+class RegionTracker
+{
+public:
+    // Labels every empty region of the board from scratch
+    void reset(const Board& board);
+
+    // A cell stopped being empty (a trail was laid on it)
+    void removeCell(int row, int col);
+
+    // Resolves the splits caused by the cells removed since the last update
+    void update();
+
+    // Turns every region that contains none of the given cells into blue on
+    // the board and returns the number of cells converted. Calls update() first.
+    int captureUnreached(Board& board, const int* cellRows, const int* cellCols, int count);
+
+    int regionOf(int row, int col) const { return label[row * cols + col]; }
+    int emptyCount() const { return emptyCells; }
+
+private:
+    int rows = 0, cols = 0;
+    std::vector<int> label;         // region per cell, -1 when not empty
+    std::vector<int> regionSize;    // cells per region label, 0 once gone
+    std::vector<int> regionCell;    // some cell of each region
+    std::vector<int> live;          // labels of the regions with cells left, in no order
+    std::vector<int> liveSlot;      // where each label sits in `live`, -1 once gone
+    std::vector<int> freeLabels;    // labels of regions gone, to reuse
+    std::vector<int> removed;       // cells removed since the last update
+    int emptyCells = 0;
+    ScanlineFill filler;
+
+    // Split detection scratch, reused between updates
+    std::vector<int> mark;          // search id that reached the cell
+    int nextSearch = 0;
+    std::vector<std::pair<int, int> > seeds;    // (region, cell)
+    std::vector<std::vector<int> > queue;       // cells reached by each search, in BFS order
+    std::vector<int> head, parent;
+    std::vector<char> busy, done;
+    std::vector<int> reachedStamp;
+    int stamp = 0;
+
+    int newRegion(int size, int cell);
+    void dropRegion(int region);
+    int find(int search);
+    void splitRegion(int region, const std::pair<int, int>* first, int count);
+    void takeGroup(int region, int root, int count);
+};
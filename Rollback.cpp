@@ -0,0 +1,177 @@
+#include "Rollback.h"
+#include <algorithm>
+
+using namespace std;
+
+RollbackSession::RollbackSession(int inputDelay, int maxRollback)
+    : delay(max(0, min(MAX_INPUT_DELAY, inputDelay))), maxAhead(max(1, min(WINDOW / 2, maxRollback))),
+      snapshots(maxAhead + 1)
+{
+    fill(localInputs, localInputs + WINDOW, INPUT_KEEP);
+    fill(remoteInputs, remoteInputs + WINDOW, INPUT_KEEP);
+    fill(usedRemote, usedRemote + WINDOW, INPUT_KEEP);
+    fill(remoteHeld, remoteHeld + WINDOW, INPUT_KEEP);
+    fill(remoteKnown, remoteKnown + WINDOW, false);
+}
+
+void RollbackSession::start(GameSimulation& sim, int localSeat, uint32_t seed, int numEnemies)
+{
+    seat = localSeat == 1 ? 1 : 0;
+    sim.reset(2, numEnemies, seed);
+
+    fill(localInputs, localInputs + WINDOW, INPUT_KEEP);
+    fill(remoteInputs, remoteInputs + WINDOW, INPUT_KEEP);
+    fill(usedRemote, usedRemote + WINDOW, INPUT_KEEP);
+    fill(remoteHeld, remoteHeld + WINDOW, INPUT_KEEP);
+    fill(remoteKnown, remoteKnown + WINDOW, false);
+    fill(remoteKnown, remoteKnown + delay, true);
+    simTick = 0;
+    confirmed = 0;
+    nextLocal = delay;
+    mispredicted = false;
+    pendingInput = INPUT_KEEP;
+    lastConfirmed = INPUT_KEEP;
+    outgoing.clear();
+    outgoingFirst = nextLocal;
+    accumulator = 0;
+    waiting = false;
+    stalls = 0;
+    rollbacks = 0;
+    resimulated = 0;
+    sim.save(snapshots[0]);
+}
+
+void RollbackSession::setLocalInput(uint8_t input)
+{
+    uint8_t direction = input & INPUT_DIRECTION_MASK;
+    if (direction != INPUT_KEEP)
+        pendingInput = (pendingInput & ~INPUT_DIRECTION_MASK) | direction;
+    pendingInput |= input & INPUT_POWER_UP;
+}
+
+bool RollbackSession::receive(uint32_t firstTick, const uint8_t* inputs, size_t count)
+{
+    if (firstTick < confirmed || firstTick - confirmed + count > (size_t)WINDOW)
+        return false;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t tick = firstTick + (uint32_t)i;
+        int slot = tick & (WINDOW - 1);
+        remoteInputs[slot] = inputs[i];
+        remoteKnown[slot] = true;
+        // Already simulated with a guess that acted differently: replay from
+        // here. A key released (INPUT_KEEP) where the guess repeated the
+        // direction already held changes nothing, so it costs no rollback.
+        if (tick < simTick && usedRemote[slot] != effect(inputs[i], slot) && (!mispredicted || tick < rollbackTo))
+        {
+            rollbackTo = tick;
+            mispredicted = true;
+        }
+    }
+    return true;
+}
+
+int RollbackSession::update(GameSimulation& sim, float dt)
+{
+    if (mispredicted)
+    {
+        // Replay up to where we were, unless the real inputs end the match sooner
+        // (a snapshot only fails to fit if the board was resized mid-match,
+        // and then there is nothing to go back to)
+        uint32_t reached = simTick;
+        if (sim.restore(snapshots[rollbackTo % snapshots.size()]))
+        {
+            for (simTick = rollbackTo; simTick < reached && !sim.isOver(); simTick++)
+                simulate(sim, simTick);
+            rollbacks++;
+            resimulated += simTick - rollbackTo;
+        }
+        mispredicted = false;
+    }
+    confirm();
+
+    // A long stall isn't paid back all at once: the match just runs late
+    accumulator = min(accumulator + dt, MAX_CATCHUP_TICKS * LOCKSTEP_TICK_SECONDS);
+
+    int simulated = 0;
+    while (accumulator >= LOCKSTEP_TICK_SECONDS && !sim.isOver())
+    {
+        if (nextLocal == simTick + delay)
+        {
+            if (outgoing.empty())
+                outgoingFirst = nextLocal;
+            localInputs[nextLocal & (WINDOW - 1)] = pendingInput;
+            outgoing.push_back(pendingInput);
+            pendingInput = INPUT_KEEP;
+            nextLocal++;
+        }
+
+        // Every snapshot back to the first unconfirmed tick is in use
+        if (simTick - confirmed >= (uint32_t)maxAhead)
+        {
+            if (!waiting)
+                stalls++;
+            waiting = true;
+            break;
+        }
+        waiting = false;
+
+        simulate(sim, simTick);
+        simTick++;
+        confirm();
+        accumulator -= LOCKSTEP_TICK_SECONDS;
+        simulated++;
+    }
+    return simulated;
+}
+
+bool RollbackSession::takeOutgoing(uint32_t& firstTick, vector<uint8_t>& inputs)
+{
+    if (outgoing.empty())
+        return false;
+    firstTick = outgoingFirst;
+    inputs.swap(outgoing);
+    outgoing.clear();
+    return true;
+}
+
+// Runs one tick with the opponent's real input if it is here, the guess if
+// not, and keeps the state that follows for a later rollback
+void RollbackSession::simulate(GameSimulation& sim, uint32_t tick)
+{
+    int slot = tick & (WINDOW - 1);
+    uint8_t remote = remoteKnown[slot] ? remoteInputs[slot] : (uint8_t)(lastConfirmed & INPUT_DIRECTION_MASK);
+    const SimPlayer& opponent = sim.players[1 - seat];
+    remoteHeld[slot] = directionInput(opponent.dirRow, opponent.dirCol);
+    usedRemote[slot] = effect(remote, slot);
+
+    for (int player = 0; player < 2; player++)
+        applyInput(sim, player, player == seat ? localInputs[slot] : remote);
+    sim.tick();
+    sim.save(snapshots[(tick + 1) % snapshots.size()]);
+}
+
+// What an opponent input does on a tick: the direction the opponent ends up
+// with, plus any power-up press. Only meaningful while the ticks before it
+// were simulated correctly, which is all receive() needs: the earliest
+// mismatch is where the replay starts.
+uint8_t RollbackSession::effect(uint8_t input, int slot) const
+{
+    uint8_t direction = input & INPUT_DIRECTION_MASK;
+    return (direction != INPUT_KEEP ? direction : remoteHeld[slot]) | (input & INPUT_POWER_UP);
+}
+
+// Moves past every simulated tick whose opponent input has arrived and was
+// used; once confirmed, a tick can no longer be rolled back
+void RollbackSession::confirm()
+{
+    while (confirmed < simTick && !mispredicted)
+    {
+        int slot = confirmed & (WINDOW - 1);
+        if (!remoteKnown[slot])
+            break;
+        lastConfirmed = remoteInputs[slot];
+        remoteKnown[slot] = false;
+        confirmed++;
+    }
+}
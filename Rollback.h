@@ -0,0 +1,79 @@
+// --- ROLLBACK: PREDICT THE OPPONENT, SIMULATE AHEAD, REPLAY WHEN THE GUESS WAS WRONG ---
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "GameSimulation.h"
+#include "Lockstep.h"
+
+const int DEFAULT_ROLLBACK_DELAY = 2;   // ticks of input delay kept, so most corrections are short
+const int MAX_ROLLBACK_TICKS = 15;      // furthest the game runs ahead of the opponent's input (250 ms)
+
+// Same inputs, same wire format and the same interface as LockstepSession,
+// but a tick whose opponent input hasn't arrived is simulated anyway with a
+// guess: the opponent keeps holding whatever direction they last held, and
+// presses no power-up. The state before every unconfirmed tick is kept in a
+// ring of snapshots; when an input arrives that differs from the guess the
+// match is restored to that tick and replayed with the real input, all
+// before the next frame is drawn. Only running more than maxRollback ticks
+// ahead of the opponent stalls.
+class RollbackSession
+{
+public:
+    explicit RollbackSession(int inputDelay = DEFAULT_ROLLBACK_DELAY, int maxRollback = MAX_ROLLBACK_TICKS);
+
+    void start(GameSimulation& sim, int localSeat, uint32_t seed, int numEnemies);
+    void setLocalInput(uint8_t input);
+    bool receive(uint32_t firstTick, const uint8_t* inputs, size_t count);
+    // Replays mispredicted ticks, then simulates what dt seconds make due
+    int update(GameSimulation& sim, float dt);
+    bool takeOutgoing(uint32_t& firstTick, std::vector<uint8_t>& inputs);
+
+    // The match ended and every input up to the end is confirmed; a match
+    // that only ended on a guess may still be rolled back
+    bool over(const GameSimulation& sim) const { return sim.isOver() && confirmed == simTick; }
+
+    int localSeat() const { return seat; }
+    int inputDelay() const { return delay; }
+    uint32_t tick() const { return simTick; }
+    // How far (0..1) the clock is into the next tick, for drawing between ticks
+    float tickFraction() const { return std::min(1.0f, accumulator / LOCKSTEP_TICK_SECONDS); }
+    // Ticks before this were simulated with the opponent's real input
+    uint32_t confirmedTick() const { return confirmed; }
+    bool stalled() const { return waiting; }
+    int stallCount() const { return stalls; }
+    int rollbackCount() const { return rollbacks; }
+    long long resimulatedTicks() const { return resimulated; }
+
+private:
+    static const int WINDOW = 256;      // ticks of input kept, a power of two
+
+    int delay;
+    int maxAhead;
+    int seat = 0;
+    uint32_t simTick = 0;       // next tick to simulate
+    uint32_t confirmed = 0;     // first tick whose opponent input is still unknown
+    uint32_t nextLocal = 0;
+    uint32_t rollbackTo = 0;    // earliest mispredicted tick, while mispredicted
+    bool mispredicted = false;
+    uint8_t pendingInput = INPUT_KEEP;
+    uint8_t lastConfirmed = INPUT_KEEP;     // opponent's input on tick confirmed - 1
+    uint8_t localInputs[WINDOW];
+    uint8_t remoteInputs[WINDOW];
+    uint8_t usedRemote[WINDOW];     // effect of the input the tick was last simulated with
+    uint8_t remoteHeld[WINDOW];     // opponent's direction going into the tick, as an input byte
+    bool remoteKnown[WINDOW];
+    std::vector<SimSnapshot> snapshots;     // state before tick t, at t % size
+    std::vector<uint8_t> outgoing;
+    uint32_t outgoingFirst = 0;
+    float accumulator = 0;
+    bool waiting = false;
+    int stalls = 0;
+    int rollbacks = 0;
+    long long resimulated = 0;
+
+    void simulate(GameSimulation& sim, uint32_t tick);
+    uint8_t effect(uint8_t input, int slot) const;
+    void confirm();
+};
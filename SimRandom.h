@@ -0,0 +1,37 @@
+// --- SIMULATION RANDOM NUMBERS: A SEEDED GENERATOR PER MATCH ---
+#pragma once
+
+#include <cstdint>
+
+// PCG32 (O'Neill, pcg-random.org): 64 bits of state, 32-bit output. Unlike
+// rand() it belongs to one simulation rather than to the process, and the
+// same seed gives the same numbers on every platform and compiler, so a
+// match is reproduced by its seed and inputs alone.
+class SimRandom
+{
+public:
+    explicit SimRandom(uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(uint64_t seed)
+    {
+        state = 0;
+        next();
+        state += seed;
+        next();
+    }
+
+    uint32_t next()
+    {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint32_t xorShifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+        uint32_t rotation = (uint32_t)(old >> 59);
+        return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+    }
+
+    // 0 .. bound - 1, by multiply and shift instead of a division
+    int below(int bound) { return (int)(((uint64_t)next() * (uint32_t)bound) >> 32); }
+
+private:
+    uint64_t state;
+};
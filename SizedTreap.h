@@ -0,0 +1,114 @@
+// --- SIZED TREAP: AN ORDER-STATISTIC TREE OVER SOMEBODY ELSE'S NODES ---
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// xorshift32 (Marsaglia): fixed seed, so whatever it shapes is reproducible
+class XorShift32
+{
+public:
+    explicit XorShift32(uint32_t seed) : state(seed) {}
+
+    uint32_t next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+private:
+    uint32_t state;
+};
+
+// The tree shared by RankIndex and PriorityQueue. Nodes are numbered by the
+// owner, which keeps what they hold and decides their order: insert() and
+// erase() take `before(a, b)`, true when node a goes ahead of node b. A
+// node's order must not change while it is in the tree, so erase it, change
+// it, insert it again. Every node knows the size of its subtree, so a walk
+// from root() down left()/right() finds a position in O(log N).
+class SizedTreap
+{
+public:
+    void reserve(int nodes) { links.reserve(nodes); }
+
+    int root() const { return top; }
+    int left(int node) const { return links[node].left; }
+    int right(int node) const { return links[node].right; }
+    int sizeOf(int node) const { return node < 0 ? 0 : links[node].size; }
+
+    template <class Before>
+    void insert(int node, Before before)
+    {
+        if (node >= (int)links.size())
+            links.resize(node + 1);
+        links[node] = { -1, -1, 1, random.next() };
+        int left, right;
+        split(top, node, false, left, right, before);
+        top = merge(merge(left, node), right);
+    }
+
+    template <class Before>
+    void erase(int node, Before before)
+    {
+        // Everything before it, it alone, everything after
+        int left, middle, right;
+        split(top, node, false, left, middle, before);
+        split(middle, node, true, middle, right, before);
+        top = merge(left, right);
+    }
+
+private:
+    struct Link
+    {
+        int left, right;
+        int size;           // nodes in this subtree
+        uint32_t priority;
+    };
+
+    std::vector<Link> links;
+    int top = -1;
+    XorShift32 random{ 0x9E3779B9u };
+
+    void pull(int node) { links[node].size = sizeOf(links[node].left) + sizeOf(links[node].right) + 1; }
+
+    int merge(int a, int b)
+    {
+        if (a < 0)
+            return b;
+        if (b < 0)
+            return a;
+        if (links[a].priority > links[b].priority)
+        {
+            links[a].right = merge(links[a].right, b);
+            pull(a);
+            return a;
+        }
+        links[b].left = merge(a, links[b].left);
+        pull(b);
+        return b;
+    }
+
+    // Left gets the nodes ordered before `key` (and `key` itself if keyGoesLeft)
+    template <class Before>
+    void split(int tree, int key, bool keyGoesLeft, int& left, int& right, Before& before)
+    {
+        if (tree < 0)
+        {
+            left = right = -1;
+            return;
+        }
+        if (before(tree, key) || (keyGoesLeft && tree == key))
+        {
+            split(links[tree].right, key, keyGoesLeft, links[tree].right, right, before);
+            left = tree;
+        }
+        else
+        {
+            split(links[tree].left, key, keyGoesLeft, left, links[tree].left, before);
+            right = tree;
+        }
+        pull(tree);
+    }
+};
@@ -4,18 +4,24 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <vector>
 #include <ctime>
 #include <cstdlib>
+#include "GameSimulation.h"
+#include "FixedTimestep.h"
+#include "AuthManager.h"
+#include "Matchmaking.h"
+#include "MatchClient.h"
+#include "Rollback.h"
+#include "TileMapRenderer.h"
+#include "TextCache.h"
+#include "ProfilerOverlay.h"
 
 using namespace std;
 using namespace sf;
 
-const int ROWS = 25;
-const int COLS = 40;
-const int TILE_SIZE_PIXELS = 18;
 const int HUD_PANEL_WIDTH = 200;
-
-int tileGrid[ROWS][COLS] = { 0 };
+const float ENEMY_SPIN_DEGREES_PER_SECOND = 240;    // 4 degrees a frame at the old fixed 60 FPS
 
 // ============================================================================
 // ALI - Game states (original)
@@ -36,16 +42,6 @@ const int MULTIPLAYER = 6;
 // AAYAN
 // ============================================================================
 
-// -------------------------------------------------------------
-// PLAYER AUTH
-// -------------------------------------------------------------
-struct Player
-{
-    int id;
-    string username, password;
-    int totalScore = 0;
-};
-
 // -------------------------------------------------------------
 // TEXT POSITIONING HELPER
 // -------------------------------------------------------------
@@ -189,397 +185,6 @@ public:
     }
 };
 
-// -------------------------------------------------------------
-// AUTH MANAGER
-// -------------------------------------------------------------
-class AuthManager
-{
-private:
-    Player players[100];
-    int count = 0;
-    int nextID = 1;
-    const char* file = "players.txt";
-
-public:
-    AuthManager() { load(); }
-
-    void load()
-    {
-        ifstream f(file);
-        if (!f.is_open())
-            return;
-        string line;
-        while (getline(f, line) && count < 100)
-        {
-            Player p;
-            istringstream iss(line);
-            char delim;
-            iss >> p.id >> delim;
-            getline(iss, p.username, ',');
-            string rest;
-            getline(iss, rest);
-            istringstream restStream(rest);
-            getline(restStream, p.password, ',');
-            string scoreStr;
-            if (getline(restStream, scoreStr))
-            {
-                p.totalScore = stoi(scoreStr);
-            }
-            else
-            {
-                p.totalScore = 0;
-            }
-            players[count++] = p;
-            nextID = max(nextID, p.id + 1);
-        }
-    }
-
-    void save()
-    {
-        ofstream f(file);
-        for (int i = 0; i < count; i++)
-            f << players[i].id << "," << players[i].username << "," << players[i].password << "," << players[i].totalScore << endl;
-    }
-
-    string toLower(const string& s)
-    {
-        string result = s;
-        for (int i = 0; i < result.length(); i++)
-            if (result[i] >= 'A' && result[i] <= 'Z')
-                result[i] = result[i] - 'A' + 'a';
-        return result;
-    }
-
-    bool registerPlayer(const string& u, const string& p, string& msg)
-    {
-        if (u.length() < 3)
-        {
-            msg = "Username too short";
-            return false;
-        }
-        if (p.length() < 6)
-        {
-            msg = "Password too short";
-            return false;
-        }
-        string uLower = toLower(u);
-        for (int i = 0; i < count; i++)
-            if (toLower(players[i].username) == uLower)
-            {
-                msg = "Username exists";
-                return false;
-            }
-        Player pl;
-        pl.id = nextID++;
-        pl.username = u;
-        pl.password = p;
-        players[count++] = pl;
-        save();
-        return true;
-    }
-
-    bool loginPlayer(const string& u, const string& p, string& msg)
-    {
-        string uLower = toLower(u);
-        for (int i = 0; i < count; i++)
-            if (toLower(players[i].username) == uLower)
-            {
-                if (players[i].password == p)
-                    return true;
-                msg = "Wrong password";
-                return false;
-            }
-        msg = "User not found";
-        return false;
-    }
-
-    int getPlayerScore(const string& username)
-    {
-        string uLower = toLower(username);
-        for (int i = 0; i < count; i++)
-            if (toLower(players[i].username) == uLower)
-                return players[i].totalScore;
-        return 0;
-    }
-
-    void updatePlayerScore(const string& username, int newScore)
-    {
-        string uLower = toLower(username);
-        for (int i = 0; i < count; i++)
-            if (toLower(players[i].username) == uLower)
-            {
-                if (newScore > players[i].totalScore)
-                {
-                    players[i].totalScore = newScore;
-                    save();
-                }
-                return;
-            }
-    }
-};
-
-// ============================================================================
-// AAYAN - PRIORITY QUEUE IMPLEMENTATION
-// ============================================================================
-
-struct QueuePlayer
-{
-    string username;
-    int score;
-    int id;
-};
-
-class PriorityQueue
-{
-private:
-    QueuePlayer queue[100];
-    int size;
-
-    void heapifyUp(int index)
-    {
-        while (index > 0)
-        {
-            int parent = (index - 1) / 2;
-            if (queue[parent].score >= queue[index].score)
-                break;
-            QueuePlayer temp = queue[parent];
-            queue[parent] = queue[index];
-            queue[index] = temp;
-            index = parent;
-        }
-    }
-
-    void heapifyDown(int index)
-    {
-        while (true)
-        {
-            int left = 2 * index + 1;
-            int right = 2 * index + 2;
-            int largest = index;
-
-            if (left < size && queue[left].score > queue[largest].score)
-                largest = left;
-            if (right < size && queue[right].score > queue[largest].score)
-                largest = right;
-
-            if (largest == index)
-                break;
-
-            QueuePlayer temp = queue[index];
-            queue[index] = queue[largest];
-            queue[largest] = temp;
-            index = largest;
-        }
-    }
-
-public:
-    PriorityQueue() : size(0) {}
-
-    void push(const string& username, int score, int id)
-    {
-        if (size >= 100)
-            return;
-        queue[size].username = username;
-        queue[size].score = score;
-        queue[size].id = id;
-        heapifyUp(size);
-        size++;
-    }
-
-    bool pop(QueuePlayer& player)
-    {
-        if (size == 0)
-            return false;
-        player = queue[0];
-        queue[0] = queue[size - 1];
-        size--;
-        if (size > 0)
-            heapifyDown(0);
-        return true;
-    }
-
-    bool peek(QueuePlayer& player)
-    {
-        if (size == 0)
-            return false;
-        player = queue[0];
-        return true;
-    }
-
-    int getSize() { return size; }
-
-    bool isEmpty() { return size == 0; }
-
-    void removePlayer(const string& username)
-    {
-        for (int i = 0; i < size; i++)
-        {
-            if (queue[i].username == username)
-            {
-                queue[i] = queue[size - 1];
-                size--;
-                if (i < size)
-                {
-                    heapifyUp(i);
-                    heapifyDown(i);
-                }
-                break;
-            }
-        }
-    }
-
-    // Get position (rank) of a player in the queue (1-based, 1 = highest priority)
-    int getPlayerPosition(const string& username)
-    {
-        // Create a temporary sorted array to find position
-        QueuePlayer temp[100];
-        int tempSize = 0;
-        
-        // Copy all players
-        for (int i = 0; i < size; i++)
-            temp[tempSize++] = queue[i];
-        
-        // Sort by score (descending) - simple bubble sort
-        for (int i = 0; i < tempSize - 1; i++)
-        {
-            for (int j = 0; j < tempSize - i - 1; j++)
-            {
-                if (temp[j].score < temp[j + 1].score)
-                {
-                    QueuePlayer swap = temp[j];
-                    temp[j] = temp[j + 1];
-                    temp[j + 1] = swap;
-                }
-            }
-        }
-        
-        // Find position
-        for (int i = 0; i < tempSize; i++)
-        {
-            if (temp[i].username == username)
-                return i + 1; // 1-based position
-        }
-        return -1; // Not found
-    }
-
-    // Get how many players have higher priority (higher score)
-    int getPlayersAbove(const string& username)
-    {
-        int playerScore = -1;
-        // Find the player's score
-        for (int i = 0; i < size; i++)
-        {
-            if (queue[i].username == username)
-            {
-                playerScore = queue[i].score;
-                break;
-            }
-        }
-        if (playerScore == -1)
-            return -1;
-        
-        // Count players with higher score
-        int count = 0;
-        for (int i = 0; i < size; i++)
-        {
-            if (queue[i].score > playerScore)
-                count++;
-        }
-        return count;
-    }
-};
-
-// ============================================================================
-// AAYAN - MATCHMAKING SYSTEM
-// ============================================================================
-
-class MatchmakingSystem
-{
-private:
-    PriorityQueue queue;
-    int nextMatchID;
-
-public:
-    MatchmakingSystem() : nextMatchID(1) {}
-
-    void addPlayer(const string& username, int score, int playerID)
-    {
-        queue.push(username, score, playerID);
-    }
-
-    bool canMatch()
-    {
-        return queue.getSize() >= 2;
-    }
-
-    bool createMatch(QueuePlayer& player1, QueuePlayer& player2)
-    {
-        if (!canMatch())
-            return false;
-        queue.pop(player1);
-        queue.pop(player2);
-        return true;
-    }
-
-    int getQueueSize() { return queue.getSize(); }
-
-    bool getTopPlayer(QueuePlayer& player) { return queue.peek(player); }
-
-    void removePlayer(const string& username) { queue.removePlayer(username); }
-
-    int getPlayerPosition(const string& username) { return queue.getPlayerPosition(username); }
-
-    int getPlayersAbove(const string& username) { return queue.getPlayersAbove(username); }
-};
-
-// -------------------------------------------------------------
-// ENEMY + FLOOD FILL
-// -------------------------------------------------------------
-struct Enemy
-{
-    int posX, posY;    // pixel coordinates
-    int velX, velY;    // velocity in pixels per tick
-    Enemy()
-    {
-        posX = posY = 300;
-        velX = 4 - rand() % 8;
-        velY = 4 - rand() % 8;
-    }
-    void move()
-    {
-        posX += velX;
-        if (tileGrid[posY / TILE_SIZE_PIXELS][posX / TILE_SIZE_PIXELS] == 1)
-        {
-            velX = -velX;
-            posX += velX;
-        }
-        posY += velY;
-        if (tileGrid[posY / TILE_SIZE_PIXELS][posX / TILE_SIZE_PIXELS] == 1)
-        {
-            velY = -velY;
-            posY += velY;
-        }
-    }
-};
-
-void floodFillMark(int row, int col)
-{
-    if (row < 0 || row >= ROWS || col < 0 || col >= COLS)
-        return;
-    if (tileGrid[row][col] == 0)
-    {
-        tileGrid[row][col] = -1;
-        if (row > 0 && tileGrid[row - 1][col] == 0)
-            floodFillMark(row - 1, col);
-        if (row < ROWS - 1 && tileGrid[row + 1][col] == 0)
-            floodFillMark(row + 1, col);
-        if (col > 0 && tileGrid[row][col - 1] == 0)
-            floodFillMark(row, col - 1);
-        if (col < COLS - 1 && tileGrid[row][col + 1] == 0)
-            floodFillMark(row, col + 1);
-    }
-}
-
 // -------------------------------------------------------------
 // FONT LOADING HELPER
 // -------------------------------------------------------------
@@ -597,16 +202,43 @@ bool loadFont(Font& font)
 // -------------------------------------------------------------
 // MAIN
 // -------------------------------------------------------------
-int main()
+int main(int argc, char** argv)
 {
-    srand(time(0));
+    // Optional arena size and match server:
+    // xonix [rows cols] [--matchmaker host[:port]] [--net-latency ms] [--fps n]
+    vector<string> sizeArgs;
+    string matchmakerAddress;
+    float netLatency = 0;
+    int renderFps = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--matchmaker" && i + 1 < argc)
+            matchmakerAddress = argv[++i];
+        else if (arg == "--net-latency" && i + 1 < argc)
+            netLatency = (float)atof(argv[++i]) / 1000;
+        else if (arg == "--fps" && i + 1 < argc)
+            renderFps = atoi(argv[++i]);
+        else
+            sizeArgs.push_back(arg);
+    }
+    int boardRows = sizeArgs.size() >= 2 ? atoi(sizeArgs[0].c_str()) : DEFAULT_ROWS;
+    int boardCols = sizeArgs.size() >= 2 ? atoi(sizeArgs[1].c_str()) : DEFAULT_COLS;
+    GameSimulation sim(boardRows, boardCols, (uint64_t)time(0));
+    const int ROWS = sim.rows();
+    const int COLS = sim.cols();
     
     // Enable antialiasing for smoother rendering
     ContextSettings settings;
     settings.antialiasingLevel = 8;
     
     RenderWindow window(VideoMode(COLS * TILE_SIZE_PIXELS + 2 * HUD_PANEL_WIDTH, ROWS * TILE_SIZE_PIXELS + 60), "XONIX", Style::Default, settings);
-    window.setFramerateLimit(60);
+    // The simulation runs at SIM_TICKS_PER_SECOND whatever the display does,
+    // so frames come at the monitor's refresh rate, or --fps if given
+    if (renderFps > 0)
+        window.setFramerateLimit(renderFps);
+    else
+        window.setVerticalSyncEnabled(true);
 
     Font font;
     if (!loadFont(font))
@@ -621,12 +253,24 @@ int main()
         font.setSmooth(false);
     }
 
+    // Every label drawn below is retained here between frames
+    TextCache texts;
+    texts.setFont(font);
+
     Texture tiles, enemyTex, gameoverTex;
     tiles.loadFromFile("images/tiles.png");
     enemyTex.loadFromFile("images/enemy.png");
     gameoverTex.loadFromFile("images/gameover.png");
 
-    Sprite sTile(tiles), sEnemy(enemyTex), sGameover(gameoverTex);
+    TileMapRenderer tileMap;
+    tileMap.init(tiles, ROWS, COLS);
+    tileMap.setPosition(HUD_PANEL_WIDTH, 0);
+
+    // Frame timings: F3 shows the overlay, F4 starts/stops writing them to a CSV
+    FrameProfiler profiler;
+    sim.setProfiler(&profiler);
+
+    Sprite sEnemy(enemyTex), sGameover(gameoverTex);
     sEnemy.setOrigin(20, 20);
     // Center game over sprite in the game area (accounting for HUD panel)
     FloatRect gameoverBounds = sGameover.getLocalBounds();
@@ -635,7 +279,12 @@ int main()
     float gameAreaCenterY = (ROWS * TILE_SIZE_PIXELS) / 2;
     sGameover.setPosition(gameAreaCenterX, gameAreaCenterY);
 
+    // Account files are written by this worker so the game-over saves
+    // don't stall a frame; declared first, it outlives the AuthManager
+    PersistenceWorker persistence;
     AuthManager auth;
+    auth.setPersistence(&persistence);
+
     int state = LOGIN_SCREEN;
     float centerX = (COLS * TILE_SIZE_PIXELS + 2 * HUD_PANEL_WIDTH) / 2;
 
@@ -675,6 +324,14 @@ int main()
     // AAYAN - Matchmaking system
     // ============================================================================
     MatchmakingSystem matchmaking;
+    // With --matchmaker the queue screen also queues on the match server,
+    // and a match found there is played over the same connection, predicting
+    // the opponent's input and rolling back when the guess was wrong
+    MatchClient matchClient;
+    matchClient.setSimulatedLatency(netLatency);
+    RollbackSession netSession;
+    bool onlineMatch = false;
+    vector<uint8_t> netInputs;
     QueuePlayer player1Queue, player2Queue;
     string player2Username = "";
     bool player2LoggedIn = false;
@@ -683,46 +340,26 @@ int main()
     int player1PlayersAbove = -1, player2PlayersAbove = -1;
 
     // ============================================================================
-    // ALI - Single player game variables
+    // Game simulation (single player and multiplayer)
     // ============================================================================
-    int playerCol = 10, playerRow = 0, playerDirCol = 0, playerDirRow = 0;
-    bool running = true;
-    float timer = 0, delay = 0.07;
+    SimPlayer& player1 = sim.players[0];
+    SimPlayer& player2 = sim.players[1];
     Clock clock;
-    Enemy enemies[10];
+    FixedTimestep timestep;     // local matches; online ones keep their own clock
     int enemyCount = 4;
-
-    // Score / Power-ups
-    int score = 0, rewardComboCount = 0, availablePowerUps = 0, lastPowerUpAwardScore = 0;
-    bool isFreezeActive = false;
-    Clock freezeClock;
     string currentUser, errorMessage;
     Clock errorClock;
 
-    // ============================================================================
-    // AAYAN - Multiplayer game variables
-    // ============================================================================
-    int player2Col = 15, player2Row = 0, player2DirCol = 0, player2DirRow = 0;
-    bool player2Running = true;
-    float player2Timer = 0;
-    int player2Score = 0, player2RewardComboCount = 0, player2AvailablePowerUps = 0, player2LastPowerUpAwardScore = 0;
-    bool player2FreezeActive = false;
-    Clock player2FreezeClock;
-    string player1DeathReason = "";
-    string player2DeathReason = "";
-    bool isMultiplayerMode = false;
-    
     // Track key states to prevent multiple triggers when held
     bool spaceWasPressed = false;
     bool enterWasPressed = false;
 
-    for (int i = 0; i < ROWS; i++)
-        for (int j = 0; j < COLS; j++)
-            if (i == 0 || j == 0 || i == ROWS - 1 || j == COLS - 1)
-                tileGrid[i][j] = 1;
-
     while (window.isOpen())
     {
+        profiler.beginFrame();
+        float frameSeconds = clock.restart().asSeconds();
+        auth.update();      // a snapshot the worker finished writing
+        profiler.begin(PHASE_EVENTS);
         Vector2i mouse = Mouse::getPosition(window);
         Event e;
         while (window.pollEvent(e))
@@ -785,24 +422,7 @@ int main()
             if (state == MAIN_MENU && playGameButton.isClicked(mouse, e))
             {
                 state = PLAYING;
-                isMultiplayerMode = false;
-                for (int i = 1; i < ROWS - 1; i++)
-                    for (int j = 1; j < COLS - 1; j++)
-                        tileGrid[i][j] = 0;
-                playerCol = 10;
-                playerRow = 0;
-                playerDirCol = playerDirRow = 0;
-                running = true;
-                score = 0;
-                rewardComboCount = 0;
-                availablePowerUps = 0;
-                lastPowerUpAwardScore = 0;
-                player1DeathReason = "";
-                player2DeathReason = "";
-                for (int i = 0; i < enemyCount; i++)
-                {
-                    enemies[i] = Enemy();
-                }
+                sim.reset(1, enemyCount);
             }
 
             // ============================================================================
@@ -821,6 +441,13 @@ int main()
                 player1Queue.id = player1ID;
                 player1QueuePosition = matchmaking.getPlayerPosition(currentUser);
                 player1PlayersAbove = matchmaking.getPlayersAbove(currentUser);
+                string host;
+                unsigned short port;
+                if (parseServerAddress(matchmakerAddress, host, port))
+                {
+                    matchClient.connect(host, port);    // finished by update(), frames keep coming
+                    matchClient.join(currentUser, playerScore);
+                }
                 state = MATCHMAKING_QUEUE;
                 cerr << "State changed to MATCHMAKING_QUEUE" << endl;
             }
@@ -831,6 +458,7 @@ int main()
                 {
                     cerr << "Leave queue button clicked, removing player: " << currentUser << endl;
                     matchmaking.removePlayer(currentUser);
+                    matchClient.disconnect();
                     leaveQueueButton.hovered = false;
                     matchmakingButton.hovered = false;
                     state = MAIN_MENU;
@@ -909,33 +537,20 @@ int main()
                 if (player2LoggedIn && startMultiplayerButton.isClicked(mouse, e))
                 {
                     state = MULTIPLAYER;
-                    isMultiplayerMode = true;
-                    for (int i = 1; i < ROWS - 1; i++)
-                        for (int j = 1; j < COLS - 1; j++)
-                            tileGrid[i][j] = 0;
-                    playerCol = 10;
-                    playerRow = 0;
-                    playerDirCol = playerDirRow = 0;
-                    running = true;
-                    score = 0;
-                    rewardComboCount = 0;
-                    availablePowerUps = 0;
-                    lastPowerUpAwardScore = 0;
-                    player2Col = 15;
-                    player2Row = 0;
-                    player2DirCol = player2DirRow = 0;
-                    player2Running = true;
-                    player2Score = 0;
-                    player2RewardComboCount = 0;
-                    player2AvailablePowerUps = 0;
-                    player2LastPowerUpAwardScore = 0;
-                    player1DeathReason = "";
-                    player2DeathReason = "";
-                    for (int i = 0; i < enemyCount; i++)
-                        enemies[i] = Enemy();
+                    sim.reset(2, enemyCount);
                 }
             }
 
+            if (e.type == Event::KeyPressed && e.key.code == Keyboard::F3)
+                profiler.showOverlay = !profiler.showOverlay;
+            if (e.type == Event::KeyPressed && e.key.code == Keyboard::F4)
+            {
+                if (profiler.recordingCsv())
+                    profiler.stopCsv();
+                else if (!profiler.startCsv("frame_profile.csv"))
+                    cerr << "Could not open frame_profile.csv" << endl;
+            }
+
             // ============================================================================
             // AAYAN - ESC to return to menu
             // ============================================================================
@@ -947,565 +562,184 @@ int main()
                     matchmaking.removePlayer(currentUser);
                     state = MAIN_MENU;
                 }
+                else if (state == MULTIPLAYER && onlineMatch)
+                {
+                    cerr << "ESC pressed in online match, returning to MAIN_MENU" << endl;
+                    matchClient.disconnect();
+                    onlineMatch = false;
+                    state = MAIN_MENU;
+                }
                 else if (state == MULTIPLAYER)
                 {
                     state = GAME_ROOM;
                     // Update the displayed scores with latest values from auth
                     player1Queue.score = auth.getPlayerScore(currentUser);
                     player2Queue.score = auth.getPlayerScore(player2Username);
-                    for (int i = 1; i < ROWS - 1; i++)
-                        for (int j = 1; j < COLS - 1; j++)
-                            tileGrid[i][j] = 0;
-                    playerCol = 10;
-                    playerRow = 0;
-                    playerDirCol = playerDirRow = 0;
-                    running = true;
-                    score = 0;
-                    rewardComboCount = 0;
-                    availablePowerUps = 0;
-                    lastPowerUpAwardScore = 0;
-                    player2Col = 15;
-                    player2Row = 0;
-                    player2DirCol = player2DirRow = 0;
-                    player2Running = true;
-                    player2Score = 0;
-                    player2RewardComboCount = 0;
-                    player2AvailablePowerUps = 0;
-                    player2LastPowerUpAwardScore = 0;
-                    for (int i = 0; i < enemyCount; i++)
-                    {
-                        enemies[i] = Enemy();
-                    }
+                    sim.reset(2, enemyCount);
                     cerr << "ESC pressed in MULTIPLAYER, returning to GAME_ROOM" << endl;
                 }
             }
         }
+        matchClient.update();
+        if (state == MATCHMAKING_QUEUE && matchClient.status() == MatchClient::MATCHED)
+        {
+            const MatchInfo& match = matchClient.match();
+            cerr << "Matched online with " << match.opponent << ", seat " << match.seat << endl;
+            matchmaking.removePlayer(currentUser);
+            netSession.start(sim, match.seat, match.seed, LOCKSTEP_ENEMIES);
+            onlineMatch = true;
+            state = MULTIPLAYER;
+        }
+        profiler.end(PHASE_EVENTS);
 
         // -------------------------------------------------------------
         // GAME LOGIC
         // -------------------------------------------------------------
-        if (state == PLAYING && running)
+        if (state == PLAYING && !sim.isOver())
         {
+            profiler.begin(PHASE_INPUT);
             // Player movement
             if (Keyboard::isKeyPressed(Keyboard::Left))
-            {
-                playerDirCol = -1;
-                playerDirRow = 0;
-            }
+                sim.setDirection(0, 0, -1);
             if (Keyboard::isKeyPressed(Keyboard::Right))
-            {
-                playerDirCol = 1;
-                playerDirRow = 0;
-            }
+                sim.setDirection(0, 0, 1);
             if (Keyboard::isKeyPressed(Keyboard::Up))
-            {
-                playerDirCol = 0;
-                playerDirRow = -1;
-            }
+                sim.setDirection(0, -1, 0);
             if (Keyboard::isKeyPressed(Keyboard::Down))
-            {
-                playerDirCol = 0;
-                playerDirRow = 1;
-            }
+                sim.setDirection(0, 1, 0);
 
-            // Power-up
             // Power-up: only trigger on initial press, not when held
             bool spacePressed = Keyboard::isKeyPressed(Keyboard::Space);
-            if (spacePressed && !spaceWasPressed && availablePowerUps > 0 && !isFreezeActive)
-            {
-                isFreezeActive = true;
-                freezeClock.restart();
-                availablePowerUps--;
-            }
+            if (spacePressed && !spaceWasPressed)
+                sim.usePowerUp(0);
             spaceWasPressed = spacePressed;
-            
-            if (isFreezeActive && freezeClock.getElapsedTime().asSeconds() > 3.0f)
-                isFreezeActive = false;
 
-            timer += clock.restart().asSeconds();
-            if (timer > delay)
-            {
-                playerCol += playerDirCol;
-                playerRow += playerDirRow;
-                playerCol = max(0, min(COLS - 1, playerCol));
-                playerRow = max(0, min(ROWS - 1, playerRow));
-                if (tileGrid[playerRow][playerCol] == 2)
-                {
-                    running = false;
-                    cerr << "Player eliminated: Stepped on own constructing tile" << endl;
-                }
-                if (tileGrid[playerRow][playerCol] == 0)
-                    tileGrid[playerRow][playerCol] = 2;
-                timer = 0;
-            }
+            profiler.end(PHASE_INPUT);
 
-            if (!isFreezeActive)
-                for (int i = 0; i < enemyCount; i++)
-                    enemies[i].move();
+            profiler.begin(PHASE_SIMULATION);
+            timestep.run(sim, frameSeconds);
+            profiler.end(PHASE_SIMULATION);
 
-            // Capture logic & score
-            if (tileGrid[playerRow][playerCol] == 1)
+            if (sim.isOver())
             {
-                playerDirCol = playerDirRow = 0;
-                int pathTiles = 0;
-                
-                // First count path tiles (type 2) to check if player has a path
-                for (int i = 0; i < ROWS; i++)
-                    for (int j = 0; j < COLS; j++)
-                        if (tileGrid[i][j] == 2)
-                            pathTiles++;
-                
-                // Only process if player actually had a path
-                if (pathTiles > 0)
-                {
-                    // Flood fill from enemies to mark their connected area
-                    for (int i = 0; i < enemyCount; i++)
-                        floodFillMark(enemies[i].posY / TILE_SIZE_PIXELS, enemies[i].posX / TILE_SIZE_PIXELS);
-                    
-                    // Count captured tiles: path (2) + enclosed empty (0) that aren't enemy-connected (-1)
-                    int tilesCaptured = 0;
-                    for (int i = 0; i < ROWS; i++)
-                        for (int j = 0; j < COLS; j++)
-                        {
-                            if (tileGrid[i][j] == 2)
-                                tilesCaptured++;
-                            else if (tileGrid[i][j] == 0 && i > 0 && i < ROWS - 1 && j > 0 && j < COLS - 1)
-                                tilesCaptured++;  // Enclosed area (not on border)
-                        }
-                    
-                    // Convert tiles: -1 back to 0, path and enclosed to 1
-                    for (int i = 0; i < ROWS; i++)
-                        for (int j = 0; j < COLS; j++)
-                        {
-                            if (tileGrid[i][j] == -1)
-                                tileGrid[i][j] = 0;
-                            else if (tileGrid[i][j] == 2 || tileGrid[i][j] == 0)
-                                tileGrid[i][j] = 1;
-                        }
-
-                    int multiplier = 1;
-                    if (tilesCaptured > 10)
-                        multiplier = 2;
-                    if (rewardComboCount >= 3 && tilesCaptured > 5)
-                        multiplier = 2;
-                    if (rewardComboCount >= 5 && tilesCaptured > 5)
-                        multiplier = 4;
-                    score += tilesCaptured * multiplier;
-                    if (multiplier > 1)
-                        rewardComboCount++;
-
-                    if (score - lastPowerUpAwardScore >= 50)
-                    {
-                        availablePowerUps++;
-                        lastPowerUpAwardScore = score;
-                    }
-                    
-                    int emptyTiles = 0;
-                    for (int i = 0; i < ROWS; i++)
-                        for (int j = 0; j < COLS; j++)
-                            if (tileGrid[i][j] == 0)
-                                emptyTiles++;
-                    if (emptyTiles == 0)
-                    {
-                        running = false;
-                        cerr << "Game won: Grid completely filled!" << endl;
-                    }
-                }
+                if (player1.deathReason.empty())
+                    cerr << "Game won: Grid completely filled!" << endl;
+                else
+                    cerr << "Player eliminated: " << player1.deathReason << endl;
             }
-
-            for (int i = 0; i < enemyCount; i++)
-                if (tileGrid[enemies[i].posY / TILE_SIZE_PIXELS][enemies[i].posX / TILE_SIZE_PIXELS] == 2)
-                {
-                    running = false;
-                    cerr << "Player eliminated: Enemy touched constructing tile" << endl;
-                }
         }
 
         // ============================================================================
-        // AAYAN - MULTIPLAYER GAME LOGIC
+        // ONLINE MULTIPLAYER: only inputs cross the network
         // ============================================================================
-        if (state == MULTIPLAYER && (running || player2Running))
+        if (state == MULTIPLAYER && onlineMatch && !netSession.over(sim))
         {
-            if (running)
-            {
-                if (Keyboard::isKeyPressed(Keyboard::Left))
-                {
-                    playerDirCol = -1;
-                    playerDirRow = 0;
-                }
-                if (Keyboard::isKeyPressed(Keyboard::Right))
-                {
-                    playerDirCol = 1;
-                    playerDirRow = 0;
-                }
-                if (Keyboard::isKeyPressed(Keyboard::Up))
-                {
-                    playerDirCol = 0;
-                    playerDirRow = -1;
-                }
-                if (Keyboard::isKeyPressed(Keyboard::Down))
-                {
-                    playerDirCol = 0;
-                    playerDirRow = 1;
-                }
+            profiler.begin(PHASE_INPUT);
+            uint8_t input = INPUT_KEEP;
+            if (Keyboard::isKeyPressed(Keyboard::Left))
+                input = INPUT_LEFT;
+            if (Keyboard::isKeyPressed(Keyboard::Right))
+                input = INPUT_RIGHT;
+            if (Keyboard::isKeyPressed(Keyboard::Up))
+                input = INPUT_UP;
+            if (Keyboard::isKeyPressed(Keyboard::Down))
+                input = INPUT_DOWN;
 
-                // Power-up: only trigger on initial press, not when held
-                bool spacePressed = Keyboard::isKeyPressed(Keyboard::Space);
-                if (spacePressed && !spaceWasPressed && availablePowerUps > 0 && !isFreezeActive)
-                {
-                    player2FreezeActive = true;
-                    player2FreezeClock.restart();
-                    availablePowerUps--;
-                    cerr << "P1 used power-up, freezing P2 and enemies" << endl;
-                }
-                spaceWasPressed = spacePressed;
-            }
+            // Power-up: only trigger on initial press, not when held
+            bool spacePressed = Keyboard::isKeyPressed(Keyboard::Space);
+            if (spacePressed && !spaceWasPressed)
+                input |= INPUT_POWER_UP;
+            spaceWasPressed = spacePressed;
+            netSession.setLocalInput(input);
 
-            if (player2Running && running)
-            {
-                if (Keyboard::isKeyPressed(Keyboard::A))
-                {
-                    player2DirCol = -1;
-                    player2DirRow = 0;
-                }
-                if (Keyboard::isKeyPressed(Keyboard::D))
-                {
-                    player2DirCol = 1;
-                    player2DirRow = 0;
-                }
-                if (Keyboard::isKeyPressed(Keyboard::W))
-                {
-                    player2DirCol = 0;
-                    player2DirRow = -1;
-                }
-                if (Keyboard::isKeyPressed(Keyboard::S))
-                {
-                    player2DirCol = 0;
-                    player2DirRow = 1;
-                }
+            uint32_t firstTick;
+            while (matchClient.receiveInputs(firstTick, netInputs))
+                if (!netSession.receive(firstTick, netInputs.data(), netInputs.size()))
+                    cerr << "Dropped opponent inputs for tick " << firstTick << endl;
+            profiler.end(PHASE_INPUT);
 
-                // Power-up: only trigger on initial press, not when held
-                bool enterPressed = Keyboard::isKeyPressed(Keyboard::Enter);
-                if (enterPressed && !enterWasPressed && player2AvailablePowerUps > 0 && !player2FreezeActive)
-                {
-                    isFreezeActive = true;
-                    freezeClock.restart();
-                    player2AvailablePowerUps--;
-                    cerr << "P2 used power-up, freezing P1 and enemies" << endl;
-                }
-                enterWasPressed = enterPressed;
-            }
+            profiler.begin(PHASE_SIMULATION);
+            netSession.update(sim, frameSeconds);
+            profiler.end(PHASE_SIMULATION);
 
-            if (isFreezeActive && freezeClock.getElapsedTime().asSeconds() > 3.0f)
-                isFreezeActive = false;
-            if (player2FreezeActive && player2FreezeClock.getElapsedTime().asSeconds() > 3.0f)
-                player2FreezeActive = false;
+            if (netSession.takeOutgoing(firstTick, netInputs))
+                matchClient.sendInputs(firstTick, netInputs);
 
-            timer += clock.restart().asSeconds();
-            if (timer > delay)
+            if (netSession.over(sim))
             {
-                bool p1Frozen = isFreezeActive;
-                bool p2Frozen = player2FreezeActive;
-                if (running && !p1Frozen)
-                {
-                    playerCol += playerDirCol;
-                    playerRow += playerDirRow;
-                    playerCol = max(0, min(COLS - 1, playerCol));
-                    playerRow = max(0, min(ROWS - 1, playerRow));
-
-                    int prevTile = tileGrid[playerRow][playerCol];
-                    if (playerRow == player2Row && playerCol == player2Col)
-                    {
-                        bool p1Constructing = (playerDirCol != 0 || playerDirRow != 0);
-                        bool p2Constructing = (player2DirCol != 0 || player2DirRow != 0);
-                        bool p1OnBlue = (prevTile == 1);
-                        
-                        if (p1OnBlue && !p1Constructing && !p2Constructing)
-                        {
-                        }
-                        else if (p1Constructing && p2Constructing)
-                        {
-                            running = false;
-                            player2Running = false;
-                            if (player1DeathReason.empty())
-                                player1DeathReason = "Collided with Player 2 while both constructing";
-                            if (player2DeathReason.empty())
-                                player2DeathReason = "Collided with Player 1 while both constructing";
-                        }
-                        else if (p1Constructing && !p2Constructing)
-                        {
-                            running = false;
-                            if (player1DeathReason.empty())
-                                player1DeathReason = "Collided with Player 2 while constructing";
-                        }
-                        else if (!p1Constructing && p2Constructing)
-                        {
-                            player2Running = false;
-                            if (player2DeathReason.empty())
-                                player2DeathReason = "Collided with Player 1 while constructing";
-                        }
-                    }
-
-                    if (tileGrid[playerRow][playerCol] == 2)
-                    {
-                        running = false;
-                        if (player1DeathReason.empty())
-                            player1DeathReason = "Stepped on own constructing tile";
-                    }
-                    if (tileGrid[playerRow][playerCol] == 0)
-                        tileGrid[playerRow][playerCol] = 2;
-                }
-
-                if (player2Running && running && !p2Frozen)
-                {
-                    player2Col += player2DirCol;
-                    player2Row += player2DirRow;
-                    player2Col = max(0, min(COLS - 1, player2Col));
-                    player2Row = max(0, min(ROWS - 1, player2Row));
-
-                    if (playerRow == player2Row && playerCol == player2Col)
-                    {
-                        bool p1Constructing = (playerDirCol != 0 || playerDirRow != 0);
-                        bool p2Constructing = (player2DirCol != 0 || player2DirRow != 0);
-                        bool p2OnBlue = (tileGrid[player2Row][player2Col] == 1);
-                        
-                        if (p2OnBlue && !p1Constructing && !p2Constructing)
-                        {
-                        }
-                        else if (p1Constructing && p2Constructing)
-                        {
-                            running = false;
-                            player2Running = false;
-                            if (player1DeathReason.empty())
-                                player1DeathReason = "Collided with Player 2 while both constructing";
-                            if (player2DeathReason.empty())
-                                player2DeathReason = "Collided with Player 1 while both constructing";
-                        }
-                        else if (p1Constructing && !p2Constructing)
-                        {
-                            running = false;
-                            if (player1DeathReason.empty())
-                                player1DeathReason = "Collided with Player 2 while constructing";
-                        }
-                        else if (!p1Constructing && p2Constructing)
-                        {
-                            player2Running = false;
-                            if (player2DeathReason.empty())
-                                player2DeathReason = "Collided with Player 1 while constructing";
-                        }
-                    }
+                const SimPlayer& me = sim.players[netSession.localSeat()];
+                auth.updatePlayerScore(currentUser, me.score);
+                cerr << "Online match over, " << currentUser << " scored " << me.score << endl;
+            }
+        }
 
-                    if (tileGrid[player2Row][player2Col] == 2 || tileGrid[player2Row][player2Col] == 3)
-                    {
-                        player2Running = false;
-                        if (player2DeathReason.empty())
-                        {
-                            if (tileGrid[player2Row][player2Col] == 2)
-                                player2DeathReason = "Stepped on Player 1's constructing tile";
-                            else
-                                player2DeathReason = "Stepped on own constructing tile";
-                        }
-                    }
-                    if (tileGrid[player2Row][player2Col] == 0)
-                        tileGrid[player2Row][player2Col] = 3;
-                }
+        // ============================================================================
+        // AAYAN - MULTIPLAYER GAME LOGIC
+        // ============================================================================
+        if (state == MULTIPLAYER && !onlineMatch && !sim.isOver())
+        {
+            profiler.begin(PHASE_INPUT);
+            if (Keyboard::isKeyPressed(Keyboard::Left))
+                sim.setDirection(0, 0, -1);
+            if (Keyboard::isKeyPressed(Keyboard::Right))
+                sim.setDirection(0, 0, 1);
+            if (Keyboard::isKeyPressed(Keyboard::Up))
+                sim.setDirection(0, -1, 0);
+            if (Keyboard::isKeyPressed(Keyboard::Down))
+                sim.setDirection(0, 1, 0);
 
-                timer = 0;
-            }
+            // Power-up: only trigger on initial press, not when held
+            bool spacePressed = Keyboard::isKeyPressed(Keyboard::Space);
+            if (spacePressed && !spaceWasPressed && sim.usePowerUp(0))
+                cerr << "P1 used power-up, freezing P2 and enemies" << endl;
+            spaceWasPressed = spacePressed;
 
-            if (!isFreezeActive && !player2FreezeActive && running && player2Running)
-                for (int i = 0; i < enemyCount; i++)
-                    enemies[i].move();
+            if (Keyboard::isKeyPressed(Keyboard::A))
+                sim.setDirection(1, 0, -1);
+            if (Keyboard::isKeyPressed(Keyboard::D))
+                sim.setDirection(1, 0, 1);
+            if (Keyboard::isKeyPressed(Keyboard::W))
+                sim.setDirection(1, -1, 0);
+            if (Keyboard::isKeyPressed(Keyboard::S))
+                sim.setDirection(1, 1, 0);
 
-            if (running && tileGrid[playerRow][playerCol] == 1)
-            {
-                playerDirCol = playerDirRow = 0;
-                int pathTiles = 0;
-                
-                // First count P1's path tiles (type 2) to check if they have a path
-                for (int i = 0; i < ROWS; i++)
-                    for (int j = 0; j < COLS; j++)
-                        if (tileGrid[i][j] == 2)
-                            pathTiles++;
-                
-                // Only process if P1 actually had a path
-                if (pathTiles > 0)
-                {
-                    // Flood fill from enemies to mark their connected area
-                    for (int i = 0; i < enemyCount; i++)
-                    {
-                        int enemyRow = enemies[i].posY / TILE_SIZE_PIXELS;
-                        int enemyCol = enemies[i].posX / TILE_SIZE_PIXELS;
-                        floodFillMark(enemyRow, enemyCol);
-                    }
-                    
-                    // Count captured tiles: path (2) + enclosed empty (0) that aren't enemy-connected (-1)
-                    int tilesCaptured = 0;
-                    for (int i = 0; i < ROWS; i++)
-                        for (int j = 0; j < COLS; j++)
-                        {
-                            if (tileGrid[i][j] == 2)
-                                tilesCaptured++;
-                            else if (tileGrid[i][j] == 0 && i > 0 && i < ROWS - 1 && j > 0 && j < COLS - 1)
-                                tilesCaptured++;  // Enclosed area (not on border)
-                        }
-                    
-                    // Convert tiles: -1 back to 0, path and enclosed to 1
-                    for (int i = 0; i < ROWS; i++)
-                        for (int j = 0; j < COLS; j++)
-                        {
-                            if (tileGrid[i][j] == -1)
-                                tileGrid[i][j] = 0;
-                            else if (tileGrid[i][j] == 2 || tileGrid[i][j] == 0)
-                                tileGrid[i][j] = 1;
-                        }
-
-                    int multiplier = 1;
-                    if (tilesCaptured > 10)
-                        multiplier = 2;
-                    if (rewardComboCount >= 3 && tilesCaptured > 5)
-                        multiplier = 2;
-                    if (rewardComboCount >= 5 && tilesCaptured > 5)
-                        multiplier = 4;
-                    score += tilesCaptured * multiplier;
-                    if (multiplier > 1)
-                        rewardComboCount++;
-
-                    if (score - lastPowerUpAwardScore >= 50)
-                    {
-                        availablePowerUps++;
-                        lastPowerUpAwardScore = score;
-                    }
-                    cerr << "P1 captured " << tilesCaptured << " tiles, score: " << score << endl;
-                }
-            }
+            // Power-up: only trigger on initial press, not when held
+            bool enterPressed = Keyboard::isKeyPressed(Keyboard::Enter);
+            if (enterPressed && !enterWasPressed && sim.usePowerUp(1))
+                cerr << "P2 used power-up, freezing P1 and enemies" << endl;
+            enterWasPressed = enterPressed;
 
-            if (player2Running && running && tileGrid[player2Row][player2Col] == 1)
-            {
-                player2DirCol = player2DirRow = 0;
-                int pathTiles = 0;
-                
-                // First count P2's path tiles (type 3) to check if they have a path
-                for (int i = 0; i < ROWS; i++)
-                    for (int j = 0; j < COLS; j++)
-                        if (tileGrid[i][j] == 3)
-                            pathTiles++;
-                
-                // Only process if P2 actually had a path
-                if (pathTiles > 0)
-                {
-                    // Flood fill from enemies to mark their connected area
-                    for (int i = 0; i < enemyCount; i++)
-                    {
-                        int enemyRow = enemies[i].posY / TILE_SIZE_PIXELS;
-                        int enemyCol = enemies[i].posX / TILE_SIZE_PIXELS;
-                        floodFillMark(enemyRow, enemyCol);
-                    }
-                    
-                    // Count captured tiles: path (3) + enclosed empty (0) that aren't enemy-connected (-1)
-                    int tilesCaptured = 0;
-                    for (int i = 0; i < ROWS; i++)
-                        for (int j = 0; j < COLS; j++)
-                        {
-                            if (tileGrid[i][j] == 3)
-                                tilesCaptured++;
-                            else if (tileGrid[i][j] == 0 && i > 0 && i < ROWS - 1 && j > 0 && j < COLS - 1)
-                                tilesCaptured++;  // Enclosed area (not on border)
-                        }
-                    
-                    // Convert tiles: -1 back to 0, path and enclosed to 1
-                    for (int i = 0; i < ROWS; i++)
-                        for (int j = 0; j < COLS; j++)
-                        {
-                            if (tileGrid[i][j] == -1)
-                                tileGrid[i][j] = 0;
-                            else if (tileGrid[i][j] == 3 || tileGrid[i][j] == 0)
-                                tileGrid[i][j] = 1;
-                        }
-
-                    int multiplier = 1;
-                    if (tilesCaptured > 10)
-                        multiplier = 2;
-                    if (player2RewardComboCount >= 3 && tilesCaptured > 5)
-                        multiplier = 2;
-                    if (player2RewardComboCount >= 5 && tilesCaptured > 5)
-                        multiplier = 4;
-                    player2Score += tilesCaptured * multiplier;
-                    if (multiplier > 1)
-                        player2RewardComboCount++;
-
-                    if (player2Score - player2LastPowerUpAwardScore >= 50)
-                    {
-                        player2AvailablePowerUps++;
-                        player2LastPowerUpAwardScore = player2Score;
-                    }
-                    cerr << "P2 captured " << tilesCaptured << " tiles, score: " << player2Score << endl;
-                }
-                
-                int emptyTiles = 0;
-                for (int i = 0; i < ROWS; i++)
-                    for (int j = 0; j < COLS; j++)
-                        if (tileGrid[i][j] == 0)
-                            emptyTiles++;
-                if (emptyTiles == 0)
-                {
-                    running = false;
-                    player2Running = false;
-                    cerr << "Game won: Grid completely filled! P1 score: " << score << ", P2 score: " << player2Score << endl;
-                }
-            }
+            profiler.end(PHASE_INPUT);
 
-            for (int i = 0; i < enemyCount; i++)
-            {
-                int enemyRow = enemies[i].posY / TILE_SIZE_PIXELS;
-                int enemyCol = enemies[i].posX / TILE_SIZE_PIXELS;
-                if (enemyCol >= 0 && enemyCol < COLS && enemyRow >= 0 && enemyRow < ROWS)
-                {
-                    if (tileGrid[enemyRow][enemyCol] == 2)
-                    {
-                        running = false;
-                        if (player1DeathReason.empty())
-                            player1DeathReason = "Enemy touched Player 1's constructing tile";
-                    }
-                    if (tileGrid[enemyRow][enemyCol] == 3)
-                    {
-                        player2Running = false;
-                        if (player2DeathReason.empty())
-                            player2DeathReason = "Enemy touched Player 2's constructing tile";
-                    }
-                }
-            }
+            profiler.begin(PHASE_SIMULATION);
+            timestep.run(sim, frameSeconds);
+            profiler.end(PHASE_SIMULATION);
 
-            if (!running && player2Running)
-            {
-                auth.updatePlayerScore(currentUser, score);
-                auth.updatePlayerScore(player2Username, player2Score);
-                cerr << "P1 eliminated, P2 wins. P1 score: " << score << ", P2 score: " << player2Score << endl;
-            }
-            if (running && !player2Running)
-            {
-                auth.updatePlayerScore(currentUser, score);
-                auth.updatePlayerScore(player2Username, player2Score);
-                cerr << "P2 eliminated, P1 wins. P1 score: " << score << ", P2 score: " << player2Score << endl;
-            }
-            if (!running && !player2Running)
+            if (sim.isOver())
             {
-                auth.updatePlayerScore(currentUser, score);
-                auth.updatePlayerScore(player2Username, player2Score);
-                cerr << "Both eliminated. P1 score: " << score << ", P2 score: " << player2Score << endl;
+                auth.updatePlayerScore(currentUser, player1.score);
+                auth.updatePlayerScore(player2Username, player2.score);
+                if (!player1.running && player2.running)
+                    cerr << "P1 eliminated (" << player1.deathReason << "), P2 wins.";
+                else if (player1.running && !player2.running)
+                    cerr << "P2 eliminated (" << player2.deathReason << "), P1 wins.";
+                else
+                    cerr << "Both eliminated.";
+                cerr << " P1 score: " << player1.score << ", P2 score: " << player2.score << endl;
             }
         }
 
         // -------------------------------------------------------------
         // DRAW
         // -------------------------------------------------------------
+        profiler.begin(PHASE_DRAW);
         window.clear();
+        // Enemies are drawn this far between their last two ticks
+        float tickAlpha = onlineMatch ? netSession.tickFraction() : timestep.alpha();
 
         if (state == LOGIN_SCREEN)
         {
-            Text t("XONIX GAME", font, 40);
-            FloatRect b = t.getLocalBounds();
-            t.setOrigin(roundf(b.width / 2), roundf(b.height / 2));
+            Text& t = texts.centered("login_screen.t", "XONIX GAME", 40);
             setTextPosition(t, centerX, 80);
             window.draw(t);
             usernameInputLogin.draw(window);
@@ -1516,7 +750,7 @@ int main()
             registerScreenButton.draw(window);
             if (!errorMessage.empty() && errorClock.getElapsedTime().asSeconds() < 3)
             {
-                Text e(errorMessage, font, 18);
+                Text& e = texts.get("login_screen.e", errorMessage, 18);
                 e.setFillColor(Color::Red);
                 setTextPosition(e, centerX - 100, 280);
                 window.draw(e);
@@ -1524,9 +758,7 @@ int main()
         }
         else if (state == REGISTER_SCREEN)
         {
-            Text t("CREATE ACCOUNT", font, 40);
-            FloatRect b = t.getLocalBounds();
-            t.setOrigin(roundf(b.width / 2), roundf(b.height / 2));
+            Text& t = texts.centered("register_screen.t", "CREATE ACCOUNT", 40);
             setTextPosition(t, centerX, 80);
             window.draw(t);
             usernameInputRegister.draw(window);
@@ -1537,7 +769,7 @@ int main()
             backButton.draw(window);
             if (!errorMessage.empty() && errorClock.getElapsedTime().asSeconds() < 3)
             {
-                Text e(errorMessage, font, 18);
+                Text& e = texts.get("register_screen.e", errorMessage, 18);
                 e.setFillColor(Color::Red);
                 setTextPosition(e, centerX - 100, 320);
                 window.draw(e);
@@ -1545,9 +777,7 @@ int main()
         }
         else if (state == MAIN_MENU)
         {
-            Text t("WELCOME " + currentUser + "!", font, 40);
-            FloatRect b = t.getLocalBounds();
-            t.setOrigin(roundf(b.width / 2), roundf(b.height / 2));
+            Text& t = texts.centered("main_menu.t", "WELCOME " + currentUser + "!", 40);
             setTextPosition(t, centerX, ROWS * TILE_SIZE_PIXELS / 2 - 100);
             window.draw(t);
             playGameButton.update(mouse);
@@ -1565,26 +795,47 @@ int main()
         // ============================================================================
         else if (state == MATCHMAKING_QUEUE)
         {
-            Text title("MATCHMAKING QUEUE", font, 40);
-            FloatRect b = title.getLocalBounds();
-            title.setOrigin(roundf(b.width / 2), roundf(b.height / 2));
+            Text& title = texts.centered("matchmaking_queue.title", "MATCHMAKING QUEUE", 40);
             setTextPosition(title, centerX, 80);
             window.draw(title);
 
             string statsText = "Your Score: " + to_string(player1Queue.score);
-            Text stats(statsText, font, 24);
-            FloatRect sb = stats.getLocalBounds();
-            stats.setOrigin(roundf(sb.width / 2), roundf(sb.height / 2));
+            Text& stats = texts.centered("matchmaking_queue.stats", statsText, 24);
             setTextPosition(stats, centerX, 150);
             window.draw(stats);
 
             string queueText = "Players in Queue: " + to_string(matchmaking.getQueueSize());
-            Text queue(queueText, font, 20);
-            FloatRect qb = queue.getLocalBounds();
-            queue.setOrigin(roundf(qb.width / 2), roundf(qb.height / 2));
+            Text& queue = texts.centered("matchmaking_queue.queue", queueText, 20);
             setTextPosition(queue, centerX, 200);
             window.draw(queue);
 
+            if (!matchmakerAddress.empty())
+            {
+                string onlineText;
+                Color onlineColor = Color::Yellow;
+                if (matchClient.status() == MatchClient::MATCHED)
+                {
+                    const MatchInfo& match = matchClient.match();
+                    onlineText = "Online: matched with " + match.opponent + " ( Score: " + to_string(match.opponentScore) + " )";
+                    onlineColor = Color::Green;
+                }
+                else if (matchClient.status() == MatchClient::QUEUED)
+                    onlineText = "Online: searching... " + to_string(matchClient.playersWaiting()) + " players waiting";
+                else if (matchClient.status() == MatchClient::FAILED)
+                {
+                    onlineText = "Online: " + matchClient.error();
+                    onlineColor = Color::Red;
+                }
+                else if (matchClient.status() == MatchClient::CONNECTING)
+                    onlineText = "Online: connecting to " + matchmakerAddress + "...";
+                else
+                    onlineText = "Online: joining the queue...";
+                Text& online = texts.centered("matchmaking_queue.online", onlineText, 16);
+                online.setFillColor(onlineColor);
+                setTextPosition(online, centerX, 380);
+                window.draw(online);
+            }
+
             addPlayer2Button.update(mouse);
             addPlayer2Button.draw(window);
             leaveQueueButton.update(mouse);
@@ -1595,33 +846,25 @@ int main()
         // ============================================================================
         else if (state == GAME_ROOM)
         {
-            Text title("GAME ROOM", font, 40);
-            FloatRect b = title.getLocalBounds();
-            title.setOrigin(roundf(b.width / 2), roundf(b.height / 2));
+            Text& title = texts.centered("game_room.title", "GAME ROOM", 40);
             setTextPosition(title, centerX, 60);
             window.draw(title);
 
             string p1Text = "Player 1: " + currentUser + " ( Score: " + to_string(player1Queue.score) + " )";
-            Text p1(p1Text, font, 20);
-            FloatRect p1b = p1.getLocalBounds();
-            p1.setOrigin(roundf(p1b.width / 2), roundf(p1b.height / 2));
+            Text& p1 = texts.centered("game_room.p1", p1Text, 20);
             setTextPosition(p1, centerX, 110);
             window.draw(p1);
 
             if (player2LoggedIn)
             {
                 string p2Text = "Player 2: " + player2Username + " ( Score: " + to_string(player2Queue.score) + " )";
-                Text p2(p2Text, font, 20);
-                FloatRect p2b = p2.getLocalBounds();
-                p2.setOrigin(roundf(p2b.width / 2), roundf(p2b.height / 2));
+                Text& p2 = texts.centered("game_room.p2", p2Text, 20);
                 setTextPosition(p2, centerX, 140);
                 window.draw(p2);
 
                 // Matchmaking Stats Section
-                Text statsTitle("--- MATCHMAKING STATS ---", font, 18);
+                Text& statsTitle = texts.centered("game_room.statsTitle", "--- MATCHMAKING STATS ---", 18);
                 statsTitle.setFillColor(Color::Yellow);
-                FloatRect stb = statsTitle.getLocalBounds();
-                statsTitle.setOrigin(roundf(stb.width / 2), roundf(stb.height / 2));
                 setTextPosition(statsTitle, centerX, 180);
                 window.draw(statsTitle);
 
@@ -1631,10 +874,8 @@ int main()
                     p1QueueStats += " (" + to_string(player1PlayersAbove) + " players ahead)";
                 else if (player1PlayersAbove == 0)
                     p1QueueStats += " (Top Priority!)";
-                Text p1Stats(p1QueueStats, font, 16);
+                Text& p1Stats = texts.centered("game_room.p1Stats", p1QueueStats, 16);
                 p1Stats.setFillColor(Color::Cyan);
-                FloatRect p1sb = p1Stats.getLocalBounds();
-                p1Stats.setOrigin(roundf(p1sb.width / 2), roundf(p1sb.height / 2));
                 setTextPosition(p1Stats, centerX, 210);
                 window.draw(p1Stats);
 
@@ -1644,10 +885,8 @@ int main()
                     p2QueueStats += " (" + to_string(player2PlayersAbove) + " players ahead)";
                 else if (player2PlayersAbove == 0)
                     p2QueueStats += " (Top Priority!)";
-                Text p2Stats(p2QueueStats, font, 16);
+                Text& p2Stats = texts.centered("game_room.p2Stats", p2QueueStats, 16);
                 p2Stats.setFillColor(Color(255, 200, 100));
-                FloatRect p2sb = p2Stats.getLocalBounds();
-                p2Stats.setOrigin(roundf(p2sb.width / 2), roundf(p2sb.height / 2));
                 setTextPosition(p2Stats, centerX, 235);
                 window.draw(p2Stats);
 
@@ -1669,10 +908,8 @@ int main()
                     priorityText = "EQUAL PRIORITY (Both have score: " + to_string(player1Queue.score) + ")";
                     priorityColor = Color::Green;
                 }
-                Text priority(priorityText, font, 16);
+                Text& priority = texts.centered("game_room.priority", priorityText, 16);
                 priority.setFillColor(priorityColor);
-                FloatRect prb = priority.getLocalBounds();
-                priority.setOrigin(roundf(prb.width / 2), roundf(prb.height / 2));
                 setTextPosition(priority, centerX, 265);
                 window.draw(priority);
 
@@ -1684,20 +921,16 @@ int main()
                     firstInQueue = player2Username + " joined queue first (Position #" + to_string(player2QueuePosition) + ")";
                 else
                     firstInQueue = "Both had same queue position";
-                Text firstQ(firstInQueue, font, 14);
+                Text& firstQ = texts.centered("game_room.firstQ", firstInQueue, 14);
                 firstQ.setFillColor(Color(180, 180, 180));
-                FloatRect fqb = firstQ.getLocalBounds();
-                firstQ.setOrigin(roundf(fqb.width / 2), roundf(fqb.height / 2));
                 setTextPosition(firstQ, centerX, 295);
                 window.draw(firstQ);
 
                 // Score difference
                 int scoreDiff = abs(player1Queue.score - player2Queue.score);
                 string diffText = "Score Difference: " + to_string(scoreDiff) + " points";
-                Text diff(diffText, font, 14);
+                Text& diff = texts.centered("game_room.diff", diffText, 14);
                 diff.setFillColor(Color(150, 150, 150));
-                FloatRect db = diff.getLocalBounds();
-                diff.setOrigin(roundf(db.width / 2), roundf(db.height / 2));
                 setTextPosition(diff, centerX, 320);
                 window.draw(diff);
 
@@ -1719,7 +952,7 @@ int main()
 
             if (!errorMessage.empty() && errorClock.getElapsedTime().asSeconds() < 3)
             {
-                Text e(errorMessage, font, 18);
+                Text& e = texts.get("game_room.e", errorMessage, 18);
                 e.setFillColor(Color::Red);
                 setTextPosition(e, centerX - 100, 400);
                 window.draw(e);
@@ -1743,62 +976,43 @@ int main()
             bottomPanel.setFillColor(Color(30, 30, 30));
             window.draw(bottomPanel);
 
-            for (int i = 0; i < ROWS; i++)
-                for (int j = 0; j < COLS; j++)
-                {
-                    if (tileGrid[i][j] == 0)
-                        continue;
-                    sTile.setTextureRect(IntRect(tileGrid[i][j] == 1 ? 0 : 54, 0, TILE_SIZE_PIXELS, TILE_SIZE_PIXELS));
-                    sTile.setPosition(HUD_PANEL_WIDTH + j * TILE_SIZE_PIXELS, i * TILE_SIZE_PIXELS);
-                    window.draw(sTile);
-                }
-            sTile.setTextureRect(IntRect(36, 0, TILE_SIZE_PIXELS, TILE_SIZE_PIXELS));
-            sTile.setPosition(HUD_PANEL_WIDTH + playerCol * TILE_SIZE_PIXELS, playerRow * TILE_SIZE_PIXELS);
-            window.draw(sTile);
-            for (int i = 0; i < enemyCount; i++)
+            tileMap.update(sim);
+            sim.clearDirty();
+            window.draw(tileMap);
+            for (int i = 0; i < sim.enemyCount; i++)
             {
-                sEnemy.setPosition(HUD_PANEL_WIDTH + enemies[i].posX, enemies[i].posY);
-                if (running)
-                    sEnemy.rotate(4);
+                sEnemy.setPosition(HUD_PANEL_WIDTH + sim.enemies[i].drawX(tickAlpha), sim.enemies[i].drawY(tickAlpha));
+                if (player1.running)
+                    sEnemy.rotate(ENEMY_SPIN_DEGREES_PER_SECOND * frameSeconds);
                 window.draw(sEnemy);
             }
 
-            Text title("PLAYER INFO", font, 20);
+            Text& title = texts.topCentered("playing.title", "PLAYER INFO", 20);
             title.setFillColor(Color::White);
-            FloatRect tb = title.getLocalBounds();
-            title.setOrigin(roundf(tb.width / 2), 0);
             setTextPosition(title, HUD_PANEL_WIDTH / 2, 20);
             window.draw(title);
 
-            Text name(currentUser, font, 16);
+            Text& name = texts.topCentered("playing.name", currentUser, 16);
             name.setFillColor(Color::Cyan);
-            FloatRect nb = name.getLocalBounds();
-            name.setOrigin(roundf(nb.width / 2), 0);
             setTextPosition(name, HUD_PANEL_WIDTH / 2, 50);
             window.draw(name);
 
-            Text scoreText("Score: " + to_string(score), font, 18);
+            Text& scoreText = texts.topCentered("playing.scoreText", "Score: " + to_string(player1.score), 18);
             scoreText.setFillColor(Color::White);
-            FloatRect stb = scoreText.getLocalBounds();
-            scoreText.setOrigin(roundf(stb.width / 2), 0);
             setTextPosition(scoreText, HUD_PANEL_WIDTH / 2, 80);
             window.draw(scoreText);
 
-            Text powerText("PowerUps: " + to_string(availablePowerUps), font, 18);
+            Text& powerText = texts.topCentered("playing.powerText", "PowerUps: " + to_string(player1.availablePowerUps), 18);
             powerText.setFillColor(Color::White);
-            FloatRect ptb = powerText.getLocalBounds();
-            powerText.setOrigin(roundf(ptb.width / 2), 0);
             setTextPosition(powerText, HUD_PANEL_WIDTH / 2, 110);
             window.draw(powerText);
 
-            Text controls("Controls: Arrow Keys - Move | Space - Power-Up | ESC - Exit", font, 14);
+            Text& controls = texts.topCentered("playing.controls", "Controls: Arrow Keys - Move | Space - Power-Up | ESC - Exit", 14);
             controls.setFillColor(Color(150, 150, 150));
-            FloatRect cb = controls.getLocalBounds();
-            controls.setOrigin(roundf(cb.width / 2), 0);
             setTextPosition(controls, centerX, ROWS * TILE_SIZE_PIXELS + 10);
             window.draw(controls);
 
-            if (!running)
+            if (!player1.running)
                 window.draw(sGameover);
         }
         // ============================================================================
@@ -1806,6 +1020,14 @@ int main()
         // ============================================================================
         else if (state == MULTIPLAYER)
         {
+            // Online, the left panel is seat 0 whoever holds it
+            string p1Label = currentUser, p2Label = player2Username;
+            if (onlineMatch)
+            {
+                p1Label = netSession.localSeat() == 0 ? currentUser : matchClient.match().opponent;
+                p2Label = netSession.localSeat() == 1 ? currentUser : matchClient.match().opponent;
+            }
+
             RectangleShape leftPanel, rightPanel, bottomPanel;
             leftPanel.setSize({(float)HUD_PANEL_WIDTH, (float)ROWS * TILE_SIZE_PIXELS});
             leftPanel.setPosition(0, 0);
@@ -1822,163 +1044,139 @@ int main()
             bottomPanel.setFillColor(Color(30, 30, 30));
             window.draw(bottomPanel);
 
-            for (int i = 0; i < ROWS; i++)
-                for (int j = 0; j < COLS; j++)
-                {
-                    if (tileGrid[i][j] == 0)
-                        continue;
-                    int tileType = 0;
-                    if (tileGrid[i][j] == 1)
-                        tileType = 0;
-                    else if (tileGrid[i][j] == 2)
-                        tileType = 54;
-                    else if (tileGrid[i][j] == 3)
-                        tileType = 72;
-                    sTile.setTextureRect(IntRect(tileType, 0, TILE_SIZE_PIXELS, TILE_SIZE_PIXELS));
-                    sTile.setPosition(HUD_PANEL_WIDTH + j * TILE_SIZE_PIXELS, i * TILE_SIZE_PIXELS);
-                    window.draw(sTile);
-                }
-
-            sTile.setTextureRect(IntRect(36, 0, TILE_SIZE_PIXELS, TILE_SIZE_PIXELS));
-            sTile.setPosition(HUD_PANEL_WIDTH + playerCol * TILE_SIZE_PIXELS, playerRow * TILE_SIZE_PIXELS);
-            window.draw(sTile);
+            tileMap.update(sim);
+            sim.clearDirty();
+            window.draw(tileMap);
 
-            sTile.setTextureRect(IntRect(18, 0, TILE_SIZE_PIXELS, TILE_SIZE_PIXELS));
-            sTile.setPosition(HUD_PANEL_WIDTH + player2Col * TILE_SIZE_PIXELS, player2Row * TILE_SIZE_PIXELS);
-            window.draw(sTile);
-
-            for (int i = 0; i < enemyCount; i++)
+            for (int i = 0; i < sim.enemyCount; i++)
             {
-                sEnemy.setPosition(HUD_PANEL_WIDTH + enemies[i].posX, enemies[i].posY);
-                if (running && player2Running)
-                    sEnemy.rotate(4);
+                sEnemy.setPosition(HUD_PANEL_WIDTH + sim.enemies[i].drawX(tickAlpha), sim.enemies[i].drawY(tickAlpha));
+                if (player1.running && player2.running)
+                    sEnemy.rotate(ENEMY_SPIN_DEGREES_PER_SECOND * frameSeconds);
                 else
                     sEnemy.setRotation(0);
                 window.draw(sEnemy);
             }
 
-            Text p1Title("PLAYER 1", font, 20);
+            Text& p1Title = texts.topCentered("multiplayer.p1Title", "PLAYER 1", 20);
             p1Title.setFillColor(Color::White);
-            FloatRect p1tb = p1Title.getLocalBounds();
-            p1Title.setOrigin(roundf(p1tb.width / 2), 0);
             setTextPosition(p1Title, HUD_PANEL_WIDTH / 2, 20);
             window.draw(p1Title);
 
-            Text p1Name(currentUser, font, 16);
+            Text& p1Name = texts.topCentered("multiplayer.p1Name", p1Label, 16);
             p1Name.setFillColor(Color::Cyan);
-            FloatRect p1nb = p1Name.getLocalBounds();
-            p1Name.setOrigin(roundf(p1nb.width / 2), 0);
             setTextPosition(p1Name, HUD_PANEL_WIDTH / 2, 50);
             window.draw(p1Name);
 
-            Text scoreText("Score: " + to_string(score), font, 18);
+            Text& scoreText = texts.topCentered("multiplayer.scoreText", "Score: " + to_string(player1.score), 18);
             scoreText.setFillColor(Color::White);
-            FloatRect stb = scoreText.getLocalBounds();
-            scoreText.setOrigin(roundf(stb.width / 2), 0);
             setTextPosition(scoreText, HUD_PANEL_WIDTH / 2, 80);
             window.draw(scoreText);
 
-            Text powerText("PowerUps: " + to_string(availablePowerUps), font, 18);
+            Text& powerText = texts.topCentered("multiplayer.powerText", "PowerUps: " + to_string(player1.availablePowerUps), 18);
             powerText.setFillColor(Color::White);
-            FloatRect ptb = powerText.getLocalBounds();
-            powerText.setOrigin(roundf(ptb.width / 2), 0);
             setTextPosition(powerText, HUD_PANEL_WIDTH / 2, 110);
             window.draw(powerText);
 
-            if (!running)
+            if (!player1.running)
             {
-                Text status("ELIMINATED", font, 18);
+                Text& status = texts.topCentered("multiplayer.status", "ELIMINATED", 18);
                 status.setFillColor(Color::Red);
-                FloatRect sb = status.getLocalBounds();
-                status.setOrigin(roundf(sb.width / 2), 0);
                 setTextPosition(status, HUD_PANEL_WIDTH / 2, 140);
                 window.draw(status);
             }
 
-            Text p2Title("PLAYER 2", font, 20);
+            Text& p2Title = texts.topCentered("multiplayer.p2Title", "PLAYER 2", 20);
             p2Title.setFillColor(Color::White);
-            FloatRect p2tb = p2Title.getLocalBounds();
-            p2Title.setOrigin(roundf(p2tb.width / 2), 0);
             setTextPosition(p2Title, COLS * TILE_SIZE_PIXELS + HUD_PANEL_WIDTH + HUD_PANEL_WIDTH / 2, 20);
             window.draw(p2Title);
 
-            Text p2Name(player2Username, font, 16);
+            Text& p2Name = texts.topCentered("multiplayer.p2Name", p2Label, 16);
             p2Name.setFillColor(Color::Yellow);
-            FloatRect p2nb = p2Name.getLocalBounds();
-            p2Name.setOrigin(roundf(p2nb.width / 2), 0);
             setTextPosition(p2Name, COLS * TILE_SIZE_PIXELS + HUD_PANEL_WIDTH + HUD_PANEL_WIDTH / 2, 50);
             window.draw(p2Name);
 
-            Text p2ScoreText("Score: " + to_string(player2Score), font, 18);
+            Text& p2ScoreText = texts.topCentered("multiplayer.p2ScoreText", "Score: " + to_string(player2.score), 18);
             p2ScoreText.setFillColor(Color::White);
-            FloatRect p2stb = p2ScoreText.getLocalBounds();
-            p2ScoreText.setOrigin(roundf(p2stb.width / 2), 0);
             setTextPosition(p2ScoreText, COLS * TILE_SIZE_PIXELS + HUD_PANEL_WIDTH + HUD_PANEL_WIDTH / 2, 80);
             window.draw(p2ScoreText);
 
-            Text p2PowerText("PowerUps: " + to_string(player2AvailablePowerUps), font, 18);
+            Text& p2PowerText = texts.topCentered("multiplayer.p2PowerText", "PowerUps: " + to_string(player2.availablePowerUps), 18);
             p2PowerText.setFillColor(Color::White);
-            FloatRect p2ptb = p2PowerText.getLocalBounds();
-            p2PowerText.setOrigin(roundf(p2ptb.width / 2), 0);
             setTextPosition(p2PowerText, COLS * TILE_SIZE_PIXELS + HUD_PANEL_WIDTH + HUD_PANEL_WIDTH / 2, 110);
             window.draw(p2PowerText);
 
-            if (!player2Running)
+            if (!player2.running)
             {
-                Text status("ELIMINATED", font, 18);
+                Text& status = texts.topCentered("multiplayer.status2", "ELIMINATED", 18);
                 status.setFillColor(Color::Red);
-                FloatRect sb = status.getLocalBounds();
-                status.setOrigin(roundf(sb.width / 2), 0);
                 setTextPosition(status, COLS * TILE_SIZE_PIXELS + HUD_PANEL_WIDTH + HUD_PANEL_WIDTH / 2, 140);
                 window.draw(status);
             }
 
-            if (!running && player2Running)
+            if (!player1.running && player2.running)
             {
-                Text winner(player2Username + " WINS!", font, 40);
+                Text& winner = texts.centered("multiplayer.winner", p2Label + " WINS!", 40);
                 winner.setFillColor(Color::Yellow);
-                FloatRect wb = winner.getLocalBounds();
-                winner.setOrigin(roundf(wb.width / 2), roundf(wb.height / 2));
                 setTextPosition(winner, centerX, ROWS * TILE_SIZE_PIXELS / 2);
                 window.draw(winner);
             }
-            else if (running && !player2Running)
+            else if (player1.running && !player2.running)
             {
-                Text winner(currentUser + " WINS!", font, 40);
+                Text& winner = texts.centered("multiplayer.winner2", p1Label + " WINS!", 40);
                 winner.setFillColor(Color::Yellow);
-                FloatRect wb = winner.getLocalBounds();
-                winner.setOrigin(roundf(wb.width / 2), roundf(wb.height / 2));
                 setTextPosition(winner, centerX, ROWS * TILE_SIZE_PIXELS / 2);
                 window.draw(winner);
             }
-            else if (!running && !player2Running)
+            else if (!player1.running && !player2.running)
             {
                 string winnerText;
-                if (score > player2Score)
-                    winnerText = currentUser + " WINS!";
-                else if (player2Score > score)
-                    winnerText = player2Username + " WINS!";
+                if (player1.score > player2.score)
+                    winnerText = p1Label + " WINS!";
+                else if (player2.score > player1.score)
+                    winnerText = p2Label + " WINS!";
                 else
                     winnerText = "TIE!";
 
-                Text winner(winnerText, font, 40);
+                Text& winner = texts.centered("multiplayer.winner3", winnerText, 40);
                 winner.setFillColor(Color::Yellow);
-                FloatRect wb = winner.getLocalBounds();
-                winner.setOrigin(roundf(wb.width / 2), roundf(wb.height / 2));
                 setTextPosition(winner, centerX, ROWS * TILE_SIZE_PIXELS / 2);
                 window.draw(winner);
             }
 
-            Text controls("P1: Arrow Keys - Move | Space - Power-Up | P2: W/A/S/D - Move | Enter - Power-Up | ESC - Exit", font, 14);
+            if (onlineMatch && !netSession.over(sim))
+            {
+                string netText;
+                if (matchClient.opponentLeft() || matchClient.status() == MatchClient::FAILED)
+                    netText = "OPPONENT DISCONNECTED";
+                else if (netSession.stalled())
+                    netText = "Waiting for " + matchClient.match().opponent + "...";
+                if (!netText.empty())
+                {
+                    Text& net = texts.centered("multiplayer.net", netText, 24);
+                    net.setFillColor(Color::Red);
+                    setTextPosition(net, centerX, ROWS * TILE_SIZE_PIXELS / 2 + 50);
+                    window.draw(net);
+                }
+            }
+
+            const char* controlsText = onlineMatch ? "Arrow Keys - Move | Space - Power-Up | ESC - Leave Match"
+                                                   : "P1: Arrow Keys - Move | Space - Power-Up | P2: W/A/S/D - Move | Enter - Power-Up | ESC - Exit";
+            Text& controls = texts.topCentered(onlineMatch ? "multiplayer.onlineControls" : "multiplayer.controls", controlsText, 14);
             controls.setFillColor(Color(150, 150, 150));
-            FloatRect cb = controls.getLocalBounds();
-            controls.setOrigin(roundf(cb.width / 2), 0);
             setTextPosition(controls, centerX, ROWS * TILE_SIZE_PIXELS + 10);
             window.draw(controls);
         }
 
+        if (profiler.showOverlay)
+            drawProfilerOverlay(window, texts, profiler, Vector2f(window.getSize().x - PROFILER_OVERLAY_WIDTH - 10, 10));
+        profiler.end(PHASE_DRAW);
+
         window.display();
+        profiler.endFrame();
     }
 
+    // The window is closed: everything queued must be on disk before exit
+    persistence.flush();
     return 0;
 }
@@ -4,18 +4,25 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <vector>
 #include <ctime>
 #include <cstdlib>
+#include "GameSimulation.h"
+#include "FixedTimestep.h"
+#include "AuthManager.h"
+#include "Leaderboard.h"
+#include "Matchmaking.h"
+#include "MatchClient.h"
+#include "Rollback.h"
+#include "TileMapRenderer.h"
+#include "TextCache.h"
+#include "ProfilerOverlay.h"
 
 using namespace std;
 using namespace sf;
 
-const int ROWS = 25;
-const int COLS = 40;
-const int TILE_SIZE_PIXELS = 18;
 const int HUD_PANEL_WIDTH = 200;
-
-int tileGrid[ROWS][COLS] = { 0 };
+const float ENEMY_SPIN_DEGREES_PER_SECOND = 240;    // 4 degrees a frame at the old fixed 60 FPS
 
 const int LOGIN_SCREEN = 0;
 const int REGISTER_SCREEN = 1;
@@ -40,20 +47,6 @@ struct Level
     float enemySpeed;
 };
 
-struct LeaderboardEntry
-{
-    string username;
-    int score;
-    int level;
-};
-
-struct QueuePlayer
-{
-    string username;
-    int score;
-    int id;
-};
-
 struct Match
 {
     int score;
@@ -95,116 +88,12 @@ struct PlayerProfile
     }
 };
 
-class MinHeap
-{
-private:
-    static const int MAX_SIZE = 10;
-    LeaderboardEntry heap[MAX_SIZE];
-    int size;
-
-    int parent(int i) { return (i - 1) / 2; }
-    int left(int i) { return 2 * i + 1; }
-    int right(int i) { return 2 * i + 2; }
-
-    void heapifyUp(int i)
-    {
-        while (i > 0)
-        {
-            int p = parent(i);
-            bool shouldSwap = heap[p].score > heap[i].score ||
-                (heap[p].score == heap[i].score && heap[p].level < heap[i].level);
-            if (!shouldSwap) break;
-            swap(heap[i], heap[p]);
-            i = p;
-        }
-    }
-
-    void heapifyDown(int i)
-    {
-        int smallest = i;
-        int l = left(i);
-        int r = right(i);
-
-        if (l < size)
-        {
-            bool lSmaller = heap[l].score < heap[smallest].score ||
-                (heap[l].score == heap[smallest].score && heap[l].level > heap[smallest].level);
-            if (lSmaller) smallest = l;
-        }
-        if (r < size)
-        {
-            bool rSmaller = heap[r].score < heap[smallest].score ||
-                (heap[r].score == heap[smallest].score && heap[r].level > heap[smallest].level);
-            if (rSmaller) smallest = r;
-        }
-
-        if (smallest != i)
-        {
-            swap(heap[i], heap[smallest]);
-            heapifyDown(smallest);
-        }
-    }
-
-public:
-    MinHeap() : size(0) {}
-
-    bool isFull() { return size == MAX_SIZE; }
-    int getSize() { return size; }
-    LeaderboardEntry* getHeap() { return heap; }
-
-    int getMinScore()
-    {
-        return (size > 0) ? heap[0].score : 0;
-    }
-
-    void insert(const LeaderboardEntry& entry)
-    {
-        if (size < MAX_SIZE)
-        {
-            heap[size] = entry;
-            heapifyUp(size);
-            size++;
-        }
-        else if (entry.score > heap[0].score)
-        {
-            heap[0] = entry;
-            heapifyDown(0);
-        }
-    }
-
-    LeaderboardEntry* getSortedArray()
-    {
-        LeaderboardEntry* sorted = new LeaderboardEntry[size];
-        for (int i = 0; i < size; i++)
-            sorted[i] = heap[i];
-
-        for (int i = 0; i < size - 1; i++)
-            for (int j = 0; j < size - i - 1; j++)
-                if (sorted[j].score < sorted[j + 1].score)
-                    swap(sorted[j], sorted[j + 1]);
-
-        return sorted;
-    }
-
-    void freeSortedArray(LeaderboardEntry* arr)
-    {
-        delete[] arr;
-    }
-};
 // Helper function to set text position at integer coordinates for crisp rendering
 void setTextPosition(Text& text, float x, float y)
 {
     text.setPosition(roundf(x), roundf(y));
 }
 
-struct Player
-{
-    int id;
-    string username, password;
-    int topScore = 0;
-    int totalScore = 0;
-};
-
 // ============================================================================
 // Button class
 // ============================================================================
@@ -339,407 +228,6 @@ public:
         display.setString("");
     }
 };
-class LeaderboardManager
-{
-private:
-    MinHeap heap;
-    const char* file = "leaderboard.txt";
-
-public:
-    LeaderboardManager() { load(); }
-
-    void load()
-    {
-        ifstream f(file);
-        if (!f.is_open())
-            return;
-        string line;
-        while (getline(f, line))
-        {
-            LeaderboardEntry entry;
-            istringstream iss(line);
-            char delim;
-            iss >> entry.score >> delim;
-            getline(iss, entry.username, ',');
-            iss >> entry.level;
-            heap.insert(entry);
-        }
-    }
-
-    void save()
-    {
-        ofstream f(file);
-        LeaderboardEntry* sorted = heap.getSortedArray();
-        for (int i = 0; i < heap.getSize(); i++)
-            f << sorted[i].score << "," << sorted[i].username << ","
-            << sorted[i].level << endl;
-        heap.freeSortedArray(sorted);
-    }
-
-    bool isHighScore(int score)
-    {
-        if (!heap.isFull())
-            return true;
-        return score > heap.getMinScore();
-    }
-
-    void addScore(const string& username, int score, int level)
-    {
-        LeaderboardEntry entry;
-        entry.username = username;
-        entry.score = score;
-        entry.level = level;
-        heap.insert(entry);
-        save();
-    }
-
-    LeaderboardEntry* getLeaderboard()
-    {
-        return heap.getSortedArray();
-    }
-
-    int getCount()
-    {
-        return heap.getSize();
-    }
-
-    void freeLeaderboard(LeaderboardEntry* arr)
-    {
-        heap.freeSortedArray(arr);
-    }
-};
-
-// ============================================================================
-// Priority Queue for Matchmaking
-// ============================================================================
-
-class PriorityQueue
-{
-private:
-    QueuePlayer queue[100];
-    int size;
-
-    void heapifyUp(int index)
-    {
-        while (index > 0)
-        {
-            int parent = (index - 1) / 2;
-            if (queue[parent].score >= queue[index].score)
-                break;
-            QueuePlayer temp = queue[parent];
-            queue[parent] = queue[index];
-            queue[index] = temp;
-            index = parent;
-        }
-    }
-
-    void heapifyDown(int index)
-    {
-        while (true)
-        {
-            int left = 2 * index + 1;
-            int right = 2 * index + 2;
-            int largest = index;
-
-            if (left < size && queue[left].score > queue[largest].score)
-                largest = left;
-            if (right < size && queue[right].score > queue[largest].score)
-                largest = right;
-
-            if (largest == index)
-                break;
-
-            QueuePlayer temp = queue[index];
-            queue[index] = queue[largest];
-            queue[largest] = temp;
-            index = largest;
-        }
-    }
-
-public:
-    PriorityQueue() : size(0) {}
-
-    void push(const string& username, int score, int id)
-    {
-        if (size >= 100)
-            return;
-        queue[size].username = username;
-        queue[size].score = score;
-        queue[size].id = id;
-        heapifyUp(size);
-        size++;
-    }
-
-    bool pop(QueuePlayer& player)
-    {
-        if (size == 0)
-            return false;
-        player = queue[0];
-        queue[0] = queue[size - 1];
-        size--;
-        if (size > 0)
-            heapifyDown(0);
-        return true;
-    }
-
-    bool peek(QueuePlayer& player)
-    {
-        if (size == 0)
-            return false;
-        player = queue[0];
-        return true;
-    }
-
-    int getSize() { return size; }
-
-    bool isEmpty() { return size == 0; }
-
-    void removePlayer(const string& username)
-    {
-        for (int i = 0; i < size; i++)
-        {
-            if (queue[i].username == username)
-            {
-                queue[i] = queue[size - 1];
-                size--;
-                if (i < size)
-                {
-                    heapifyUp(i);
-                    heapifyDown(i);
-                }
-                break;
-            }
-        }
-    }
-
-    int getPlayerPosition(const string& username)
-    {
-        QueuePlayer temp[100];
-        int tempSize = 0;
-
-        for (int i = 0; i < size; i++)
-            temp[tempSize++] = queue[i];
-
-        for (int i = 0; i < tempSize - 1; i++)
-        {
-            for (int j = 0; j < tempSize - i - 1; j++)
-            {
-                if (temp[j].score < temp[j + 1].score)
-                {
-                    QueuePlayer swap = temp[j];
-                    temp[j] = temp[j + 1];
-                    temp[j + 1] = swap;
-                }
-            }
-        }
-
-        for (int i = 0; i < tempSize; i++)
-        {
-            if (temp[i].username == username)
-                return i + 1;
-        }
-        return -1;
-    }
-
-    int getPlayersAbove(const string& username)
-    {
-        int playerScore = -1;
-        for (int i = 0; i < size; i++)
-        {
-            if (queue[i].username == username)
-            {
-                playerScore = queue[i].score;
-                break;
-            }
-        }
-        if (playerScore == -1)
-            return -1;
-
-        int count = 0;
-        for (int i = 0; i < size; i++)
-        {
-            if (queue[i].score > playerScore)
-                count++;
-        }
-        return count;
-    }
-};
-
-// ============================================================================
-// MATCHMAKING SYSTEM
-// ============================================================================
-
-class MatchmakingSystem
-{
-private:
-    PriorityQueue queue;
-    int nextMatchID;
-
-public:
-    MatchmakingSystem() : nextMatchID(1) {}
-
-    void addPlayer(const string& username, int score, int playerID)
-    {
-        queue.push(username, score, playerID);
-    }
-
-    bool canMatch()
-    {
-        return queue.getSize() >= 2;
-    }
-
-    bool createMatch(QueuePlayer& player1, QueuePlayer& player2)
-    {
-        if (!canMatch())
-            return false;
-        queue.pop(player1);
-        queue.pop(player2);
-        return true;
-    }
-
-    int getQueueSize() { return queue.getSize(); }
-
-    bool getTopPlayer(QueuePlayer& player) { return queue.peek(player); }
-
-    void removePlayer(const string& username) { queue.removePlayer(username); }
-
-    int getPlayerPosition(const string& username) { return queue.getPlayerPosition(username); }
-
-    int getPlayersAbove(const string& username) { return queue.getPlayersAbove(username); }
-};
-
-// ============================================================================
-// END MATCHMAKING SYSTEM
-// ============================================================================
-
-class AuthManager
-{
-private:
-    Player players[100];
-    int count = 0;
-    int nextID = 1;
-    const char* file = "players.txt";
-
-public:
-    AuthManager() { load(); }
-
-    void load()
-    {
-        ifstream f(file);
-        if (!f.is_open())
-            return;
-        string line;
-        while (getline(f, line) && count < 100)
-        {
-            Player p;
-            istringstream iss(line);
-            char delim;
-            iss >> p.id >> delim;
-            getline(iss, p.username, ',');
-            getline(iss, p.password, ',');
-            iss >> p.topScore;
-            players[count++] = p;
-            nextID = max(nextID, p.id + 1);
-        }
-    }
-
-    void save()
-    {
-        ofstream f(file);
-        for (int i = 0; i < count; i++)
-            f << players[i].id << "," << players[i].username << "," << players[i].password << "," << players[i].topScore << endl;
-    }
-
-    bool registerPlayer(const string& u, const string& p, string& msg)
-    {
-        if (u.length() < 3)
-        {
-            msg = "Username too short";
-            return false;
-        }
-        if (p.length() < 6)
-        {
-            msg = "Password too short";
-            return false;
-        }
-        if (count >= 100)
-        {
-            msg = "User limit reached";
-            return false;
-        }
-        for (int i = 0; i < count; i++)
-            if (players[i].username == u)
-            {
-                msg = "Username exists";
-                return false;
-            }
-        Player pl;
-        pl.id = nextID++;
-        pl.username = u;
-        pl.password = p;
-        players[count++] = pl;
-        save();
-        return true;
-    }
-
-    bool loginPlayer(const string& u, const string& p, string& msg)
-    {
-        for (int i = 0; i < count; i++)
-            if (players[i].username == u)
-            {
-                if (players[i].password == p)
-                    return true;
-                msg = "Wrong password";
-                return false;
-            }
-        msg = "User not found";
-        return false;
-    }
-
-    int getPlayerTopScore(const string& username)
-    {
-        for (int i = 0; i < count; i++)
-            if (players[i].username == username)
-                return players[i].topScore;
-        return 0;
-    }
-
-    void updatePlayerTopScore(const string& username, int newScore)
-    {
-        for (int i = 0; i < count; i++)
-        {
-            if (players[i].username == username)
-            {
-                if (newScore > players[i].topScore)
-                    players[i].topScore = newScore;
-                save();
-                return;
-            }
-        }
-    }
-
-    int getPlayerScore(const string& username)
-    {
-        for (int i = 0; i < count; i++)
-            if (players[i].username == username)
-                return players[i].totalScore;
-        return 0;
-    }
-
-    void updatePlayerScore(const string& username, int newScore)
-    {
-        for (int i = 0; i < count; i++)
-            if (players[i].username == username)
-            {
-                if (newScore > players[i].totalScore)
-                {
-                    players[i].totalScore = newScore;
-                    save();
-                }
-                return;
-            }
-    }
-};
 
 class ProfileManager
 {
@@ -747,10 +235,14 @@ private:
     PlayerProfile profiles[100];
     int count = 0;
     const char* file = "profiles.txt";
+    PersistenceWorker* persistence = nullptr;
 
 public:
     ProfileManager() { load(); }
 
+    // Saves are handed to the worker instead of written on this thread
+    void setPersistence(PersistenceWorker* worker) { persistence = worker; }
+
     void load()
     {
         ifstream f(file);
@@ -770,10 +262,14 @@ public:
 
     void save()
     {
-        ofstream f(file);
+        ostringstream f;
         for (int i = 0; i < count; i++)
             f << profiles[i].username << "," << profiles[i].totalPoints << ","
-            << profiles[i].wins << "," << profiles[i].losses << endl;
+            << profiles[i].wins << "," << profiles[i].losses << "\n";
+        if (persistence)
+            persistence->writeFile(file, f.str());
+        else
+            ofstream(file) << f.str();
     }
 
     PlayerProfile* getProfile(const string& username)
@@ -843,51 +339,6 @@ public:
     }
 };
 
-struct Enemy
-{
-    int posX, posY;
-    int velX, velY;
-    Enemy()
-    {
-        posX = posY = 300;
-        velX = 4 - rand() % 8;
-        velY = 4 - rand() % 8;
-    }
-    void move()
-    {
-        posX += velX;
-        if (tileGrid[posY / TILE_SIZE_PIXELS][posX / TILE_SIZE_PIXELS] == 1)
-        {
-            velX = -velX;
-            posX += velX;
-        }
-        posY += velY;
-        if (tileGrid[posY / TILE_SIZE_PIXELS][posX / TILE_SIZE_PIXELS] == 1)
-        {
-            velY = -velY;
-            posY += velY;
-        }
-    }
-};
-
-void floodFillMark(int row, int col)
-{
-    if (row < 0 || row >= ROWS || col < 0 || col >= COLS)
-        return;
-    if (tileGrid[row][col] == 0)
-    {
-        tileGrid[row][col] = -1;
-        if (row > 0 && tileGrid[row - 1][col] == 0)
-            floodFillMark(row - 1, col);
-        if (row < ROWS - 1 && tileGrid[row + 1][col] == 0)
-            floodFillMark(row + 1, col);
-        if (col > 0 && tileGrid[row][col - 1] == 0)
-            floodFillMark(row, col - 1);
-        if (col < COLS - 1 && tileGrid[row][col + 1] == 0)
-            floodFillMark(row, col + 1);
-    }
-}
-
 // Font loading helper
 bool loadFont(Font& font)
 {
@@ -899,15 +350,42 @@ bool loadFont(Font& font)
 
     return false;
 }
-int main()
+int main(int argc, char** argv)
 {
-    srand(time(0));
+    // Optional arena size and match server:
+    // xonix [rows cols] [--matchmaker host[:port]] [--net-latency ms] [--fps n]
+    vector<string> sizeArgs;
+    string matchmakerAddress;
+    float netLatency = 0;
+    int renderFps = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--matchmaker" && i + 1 < argc)
+            matchmakerAddress = argv[++i];
+        else if (arg == "--net-latency" && i + 1 < argc)
+            netLatency = (float)atof(argv[++i]) / 1000;
+        else if (arg == "--fps" && i + 1 < argc)
+            renderFps = atoi(argv[++i]);
+        else
+            sizeArgs.push_back(arg);
+    }
+    int boardRows = sizeArgs.size() >= 2 ? atoi(sizeArgs[0].c_str()) : DEFAULT_ROWS;
+    int boardCols = sizeArgs.size() >= 2 ? atoi(sizeArgs[1].c_str()) : DEFAULT_COLS;
+    GameSimulation sim(boardRows, boardCols, (uint64_t)time(0));
+    const int ROWS = sim.rows();
+    const int COLS = sim.cols();
 
     ContextSettings settings;
     settings.antialiasingLevel = 8;
 
     RenderWindow window(VideoMode(COLS * TILE_SIZE_PIXELS + 2 * HUD_PANEL_WIDTH, ROWS * TILE_SIZE_PIXELS + 60), "XONIX", Style::Default, settings);
-    window.setFramerateLimit(60);
+    // The simulation runs at SIM_TICKS_PER_SECOND whatever the display does,
+    // so frames come at the monitor's refresh rate, or --fps if given
+    if (renderFps > 0)
+        window.setFramerateLimit(renderFps);
+    else
+        window.setVerticalSyncEnabled(true);
 
     Font font;
     if (!loadFont(font))
@@ -918,12 +396,24 @@ int main()
         font.setSmooth(false);
     }
 
+    // Every label drawn below is retained here between frames
+    TextCache texts;
+    texts.setFont(font);
+
     Texture tiles, enemyTex, gameoverTex;
     tiles.loadFromFile("images/tiles.png");
     enemyTex.loadFromFile("images/enemy.png");
     gameoverTex.loadFromFile("images/gameover.png");
 
-    Sprite sTile(tiles), sEnemy(enemyTex), sGameover(gameoverTex);
+    TileMapRenderer tileMap;
+    tileMap.init(tiles, ROWS, COLS);
+    tileMap.setPosition(HUD_PANEL_WIDTH, 0);
+
+    // Frame timings: F3 shows the overlay, F4 starts/stops writing them to a CSV
+    FrameProfiler profiler;
+    sim.setProfiler(&profiler);
+
+    Sprite sEnemy(enemyTex), sGameover(gameoverTex);
     sEnemy.setOrigin(20, 20);
     FloatRect gameoverBounds = sGameover.getLocalBounds();
     sGameover.setOrigin(gameoverBounds.width / 2, gameoverBounds.height / 2);
@@ -931,9 +421,22 @@ int main()
     float gameAreaCenterY = (ROWS * TILE_SIZE_PIXELS) / 2;
     sGameover.setPosition(gameAreaCenterX, gameAreaCenterY);
 
+    // Account, leaderboard and profile files are written by this worker so
+    // the game-over saves don't stall a frame; declared first, it outlives them
+    PersistenceWorker persistence;
     AuthManager auth;
+    auth.setPersistence(&persistence);
     LeaderboardManager leaderboardManager;
+    leaderboardManager.setPersistence(&persistence);
+    // Rank every account that has scored, not just the top of the leaderboard
+    auth.forEachPlayer([&](const Player& p)
+    {
+        int best = max(p.topScore, p.totalScore);
+        if (best > 0)
+            leaderboardManager.seedBestScore(p.username, best);
+    });
     ProfileManager profileManager;
+    profileManager.setPersistence(&persistence);
     int state = LOGIN_SCREEN;
     float centerX = (COLS * TILE_SIZE_PIXELS + 2 * HUD_PANEL_WIDTH) / 2;
 
@@ -944,6 +447,10 @@ int main()
     };
     int selectedLevel = 0;
 
+    // Which board the leaderboard screen shows: 0 = all levels, else a levels[] id
+    int leaderboardLevel = 0;
+    LeaderboardWindow leaderboardWindow = WINDOW_ALL_TIME;
+
     InputField usernameInputLogin, passwordInputLogin, usernameInputRegister, passwordInputRegister;
     usernameInputLogin.init(centerX, 150, 300, 40, "Username", font);
     passwordInputLogin.init(centerX, 230, 300, 40, "Password", font, true);
@@ -971,6 +478,14 @@ int main()
     leaveQueueButton.init(centerX, 320, 200, 50, "Leave Queue", font);
 
     MatchmakingSystem matchmaking;
+    // With --matchmaker the queue screen also queues on the match server,
+    // and a match found there is played over the same connection, predicting
+    // the opponent's input and rolling back when the guess was wrong
+    MatchClient matchClient;
+    matchClient.setSimulatedLatency(netLatency);
+    RollbackSession netSession;
+    bool onlineMatch = false;
+    vector<uint8_t> netInputs;
     QueuePlayer player1Queue, player2Queue;
     string player2Username = "";
     bool player2LoggedIn = false;
@@ -1005,40 +520,22 @@ int main()
     profileBackButton.init(centerX, 450, 200, 50, "Back", font);
 
     // Game
-    int playerCol = 10, playerRow = 0, playerDirCol = 0, playerDirRow = 0;
-    bool running = true;
-    float timer = 0, delay = 0.07;
+    SimPlayer& player1 = sim.players[0];
+    SimPlayer& player2 = sim.players[1];
     Clock clock;
-    Enemy enemies[10];
+    FixedTimestep timestep;     // local matches; online ones keep their own clock
     int enemyCount = 4;
     int currentLevelId = 1;
     int gameMode = 1; // 1 = Single, 2 = Multiplayer
 
-    // Score / Power-ups
-    int score = 0, rewardComboCount = 0, availablePowerUps = 0, lastPowerUpAwardScore = 0;
-    bool isFreezeActive = false;
-    Clock freezeClock;
     string currentUser, errorMessage;
     Clock errorClock;
     bool isNewHighScore = false; // tracks if current game is a high score
 
-    // Multiplayer game variables
-    int player2Col = 15, player2Row = 0, player2DirCol = 0, player2DirRow = 0;
-    bool player2Running = true;
-    float player2Timer = 0;
-    int player2Score = 0, player2RewardComboCount = 0, player2AvailablePowerUps = 0, player2LastPowerUpAwardScore = 0;
-    bool player2FreezeActive = false;
-    Clock player2FreezeClock;
     // Track key states to prevent multiple triggers when held
     bool spaceWasPressed = false;
     bool enterWasPressed = false;
 
-    // Initialize game grid: surround with blue border tiles (safe zone)
-    for (int i = 0; i < ROWS; i++)
-        for (int j = 0; j < COLS; j++)
-            if (i == 0 || j == 0 || i == ROWS - 1 || j == COLS - 1)
-                tileGrid[i][j] = 1;  // 1 = blue tile (safe)
-
     // ============================================================================
     // MAIN GAME LOOP - Runs 60 times per second (60 FPS)
     // ============================================================================
@@ -1049,6 +546,10 @@ int main()
 
     while (window.isOpen())
     {
+        profiler.beginFrame();
+        float frameSeconds = clock.restart().asSeconds();
+        auth.update();      // a snapshot the worker finished writing
+        profiler.begin(PHASE_EVENTS);
         Vector2i mouse = Mouse::getPosition(window);  // Get current mouse position
         Event e;
 
@@ -1131,6 +632,7 @@ int main()
                 if (leaveQueueButton.isClicked(mouse, e))
                 {
                     matchmaking.removePlayer(currentUser);
+                    matchClient.disconnect();
                     leaveQueueButton.hovered = false;
                     matchmakingButton.hovered = false;
                     state = START_MENU;
@@ -1207,31 +709,21 @@ int main()
                     state = MULTIPLAYER;
                     currentLevelId = levels[selectedLevel].id;
                     enemyCount = levels[selectedLevel].initialEnemies;
-                    for (int i = 1; i < ROWS - 1; i++)
-                        for (int j = 1; j < COLS - 1; j++)
-                            tileGrid[i][j] = 0;
-                    playerCol = 10;
-                    playerRow = 0;
-                    playerDirCol = playerDirRow = 0;
-                    running = true;
-                    score = 0;
-                    rewardComboCount = 0;
-                    availablePowerUps = 0;
-                    lastPowerUpAwardScore = 0;
-                    player2Col = 15;
-                    player2Row = 0;
-                    player2DirCol = player2DirRow = 0;
-                    player2Running = true;
-                    player2Score = 0;
-                    player2RewardComboCount = 0;
-                    player2AvailablePowerUps = 0;
-                    player2LastPowerUpAwardScore = 0;
-                    for (int i = 0; i < enemyCount; i++)
-                        enemies[i] = Enemy();
+                    sim.reset(2, enemyCount);
                     continue;
                 }
             }
 
+            if (e.type == Event::KeyPressed && e.key.code == Keyboard::F3)
+                profiler.showOverlay = !profiler.showOverlay;
+            if (e.type == Event::KeyPressed && e.key.code == Keyboard::F4)
+            {
+                if (profiler.recordingCsv())
+                    profiler.stopCsv();
+                else if (!profiler.startCsv("frame_profile.csv"))
+                    cerr << "Could not open frame_profile.csv" << endl;
+            }
+
             // ============================================================================
             // ESC to return to menu
             // ============================================================================
@@ -1242,34 +734,18 @@ int main()
                     matchmaking.removePlayer(currentUser);
                     state = START_MENU;
                 }
+                else if (state == MULTIPLAYER && onlineMatch)
+                {
+                    matchClient.disconnect();
+                    onlineMatch = false;
+                    state = START_MENU;
+                }
                 else if (state == MULTIPLAYER)
                 {
                     state = GAME_ROOM;
                     player1Queue.score = auth.getPlayerScore(currentUser);
                     player2Queue.score = auth.getPlayerScore(player2Username);
-                    for (int i = 1; i < ROWS - 1; i++)
-                        for (int j = 1; j < COLS - 1; j++)
-                            tileGrid[i][j] = 0;
-                    playerCol = 10;
-                    playerRow = 0;
-                    playerDirCol = playerDirRow = 0;
-                    running = true;
-                    score = 0;
-                    rewardComboCount = 0;
-                    availablePowerUps = 0;
-                    lastPowerUpAwardScore = 0;
-                    player2Col = 15;
-                    player2Row = 0;
-                    player2DirCol = player2DirRow = 0;
-                    player2Running = true;
-                    player2Score = 0;
-                    player2RewardComboCount = 0;
-                    player2AvailablePowerUps = 0;
-                    player2LastPowerUpAwardScore = 0;
-                    for (int i = 0; i < enemyCount; i++)
-                    {
-                        enemies[i] = Enemy();
-                    }
+                    sim.reset(2, enemyCount);
                 }
             }
 
@@ -1323,19 +799,7 @@ int main()
                     currentLevelId = levels[selectedLevel].id;
                     enemyCount = levels[selectedLevel].initialEnemies;
                     // Reset
-                    for (int i = 1; i < ROWS - 1; i++)
-                        for (int j = 1; j < COLS - 1; j++)
-                            tileGrid[i][j] = 0;
-                    playerCol = 10;
-                    playerRow = 0;
-                    playerDirCol = playerDirRow = 0;
-                    running = true;
-                    score = 0;
-                    rewardComboCount = 0;
-                    availablePowerUps = 0;
-                    lastPowerUpAwardScore = 0;
-                    for (int i = 0; i < enemyCount; i++)
-                        enemies[i] = Enemy();
+                    sim.reset(1, enemyCount);
                     continue;
                 }
                 if (multiPlayerButton.isClicked(mouse, e))
@@ -1350,6 +814,13 @@ int main()
                     player1Queue.id = player1ID;
                     player1QueuePosition = matchmaking.getPlayerPosition(currentUser);
                     player1PlayersAbove = matchmaking.getPlayersAbove(currentUser);
+                    string host;
+                    unsigned short port;
+                    if (parseServerAddress(matchmakerAddress, host, port))
+                    {
+                        matchClient.connect(host, port);    // finished by update(), frames keep coming
+                        matchClient.join(currentUser, playerScore);
+                    }
                     state = MATCHMAKING_QUEUE;
                     continue;
                 }
@@ -1393,6 +864,19 @@ int main()
                     errorMessage = "";
                     continue;
                 }
+                // Left/Right pick the level, Up/Down the time window
+                if (e.type == Event::KeyPressed)
+                {
+                    int boards = leaderboardManager.levelCount() + 1;
+                    if (e.key.code == Keyboard::Left)
+                        leaderboardLevel = (leaderboardLevel + boards - 1) % boards;
+                    else if (e.key.code == Keyboard::Right)
+                        leaderboardLevel = (leaderboardLevel + 1) % boards;
+                    else if (e.key.code == Keyboard::Up)
+                        leaderboardWindow = (LeaderboardWindow)((leaderboardWindow + WINDOW_COUNT - 1) % WINDOW_COUNT);
+                    else if (e.key.code == Keyboard::Down)
+                        leaderboardWindow = (LeaderboardWindow)((leaderboardWindow + 1) % WINDOW_COUNT);
+                }
             }
 
             // PROFILE
@@ -1414,60 +898,36 @@ int main()
             {
                 if (restartButton.isClicked(mouse, e))
                 {
-                    if (gameMode == 2) // multiplayer
+                    if (onlineMatch) // back into the online queue
+                    {
+                        onlineMatch = false;
+                        player1Queue.score = auth.getPlayerScore(currentUser);
+                        matchClient.join(currentUser, player1Queue.score);
+                        state = MATCHMAKING_QUEUE;
+                    }
+                    else if (gameMode == 2) // multiplayer
                     {
                         state = MULTIPLAYER;
                         currentLevelId = levels[selectedLevel].id;
                         enemyCount = levels[selectedLevel].initialEnemies;
-                        for (int i = 1; i < ROWS - 1; i++)
-                            for (int j = 1; j < COLS - 1; j++)
-                                tileGrid[i][j] = 0;
-                        playerCol = 10;
-                        playerRow = 0;
-                        playerDirCol = playerDirRow = 0;
-                        running = true;
-                        score = 0;
-                        rewardComboCount = 0;
-                        availablePowerUps = 0;
-                        lastPowerUpAwardScore = 0;
-                        player2Col = 30;
-                        player2Row = 24;
-                        player2DirCol = player2DirRow = 0;
-                        player2Running = true;
-                        player2Score = 0;
-                        player2RewardComboCount = 0;
-                        player2AvailablePowerUps = 0;
-                        player2LastPowerUpAwardScore = 0;
-                        isFreezeActive = false;
-                        player2FreezeActive = false;
-                        freezeClock.restart();
-                        player2FreezeClock.restart();
-                        for (int i = 0; i < enemyCount; i++)
-                            enemies[i] = Enemy();
+                        sim.reset(2, enemyCount);
+                        player2.row = ROWS - 1;
+                        player2.col = min(30, COLS - 1);
                     }
                     else // single player
                     {
                         state = PLAYING;
                         currentLevelId = levels[selectedLevel].id;
                         enemyCount = levels[selectedLevel].initialEnemies;
-                        for (int i = 1; i < ROWS - 1; i++)
-                            for (int j = 1; j < COLS - 1; j++)
-                                tileGrid[i][j] = 0;
-                        playerCol = 10;
-                        playerRow = 0;
-                        playerDirCol = playerDirRow = 0;
-                        running = true;
-                        score = 0;
-                        rewardComboCount = 0;
-                        availablePowerUps = 0;
-                        lastPowerUpAwardScore = 0;
-                        for (int i = 0; i < enemyCount; i++)
-                            enemies[i] = Enemy();
+                        sim.reset(1, enemyCount);
                     }
                     continue;
                 }
                 if (mainMenuButton.isClicked(mouse, e))
                 {
+                    if (onlineMatch)
+                        matchClient.disconnect();
+                    onlineMatch = false;
                     state = START_MENU;
                     gameMode = 0;
                     continue;
@@ -1479,119 +939,57 @@ int main()
                 }
             }
         }
-        if (state == PLAYING && running)
+        matchClient.update();
+        if (state == MATCHMAKING_QUEUE && matchClient.status() == MatchClient::MATCHED)
         {
+            matchmaking.removePlayer(currentUser);
+            netSession.start(sim, matchClient.match().seat, matchClient.match().seed, LOCKSTEP_ENEMIES);
+            onlineMatch = true;
+            gameMode = 2;
+            state = MULTIPLAYER;
+        }
+        profiler.end(PHASE_EVENTS);
+
+        if (state == PLAYING && !sim.isOver())
+        {
+            profiler.begin(PHASE_INPUT);
             // Player movement
             if (Keyboard::isKeyPressed(Keyboard::Left))
-            {
-                playerDirCol = -1;
-                playerDirRow = 0;
-            }
+                sim.setDirection(0, 0, -1);
             if (Keyboard::isKeyPressed(Keyboard::Right))
-            {
-                playerDirCol = 1;
-                playerDirRow = 0;
-            }
+                sim.setDirection(0, 0, 1);
             if (Keyboard::isKeyPressed(Keyboard::Up))
-            {
-                playerDirCol = 0;
-                playerDirRow = -1;
-            }
+                sim.setDirection(0, -1, 0);
             if (Keyboard::isKeyPressed(Keyboard::Down))
-            {
-                playerDirCol = 0;
-                playerDirRow = 1;
-            }
+                sim.setDirection(0, 1, 0);
 
-            // Power-up
             // Power-up: only trigger on initial press, not when held
             bool spacePressed = Keyboard::isKeyPressed(Keyboard::Space);
-            if (spacePressed && !spaceWasPressed && availablePowerUps > 0 && !isFreezeActive)
-            {
-                isFreezeActive = true;
-                freezeClock.restart();
-                availablePowerUps--;
-            }
+            if (spacePressed && !spaceWasPressed)
+                sim.usePowerUp(0);
             spaceWasPressed = spacePressed;
 
-            if (isFreezeActive && freezeClock.getElapsedTime().asSeconds() > 3.0f)
-                isFreezeActive = false;
+            profiler.end(PHASE_INPUT);
 
-            timer += clock.restart().asSeconds();
-            if (timer > delay)
-            {
-                playerCol += playerDirCol;
-                playerRow += playerDirRow;
-                playerCol = max(0, min(COLS - 1, playerCol));
-                playerRow = max(0, min(ROWS - 1, playerRow));
-                if (tileGrid[playerRow][playerCol] == 2)
-                    running = false;
-                if (tileGrid[playerRow][playerCol] == 0)
-                    tileGrid[playerRow][playerCol] = 2;
-                timer = 0;
-            }
-
-            if (!isFreezeActive)
-                for (int i = 0; i < enemyCount; i++)
-                    enemies[i].move();
-
-            if (tileGrid[playerRow][playerCol] == 1)
-            {
-                playerDirCol = playerDirRow = 0;
-                int tilesCaptured = 0;
-
-                // Mark all areas with enemies (those are NOT capturable)
-                for (int i = 0; i < enemyCount; i++)
-                    floodFillMark(enemies[i].posY / TILE_SIZE_PIXELS, enemies[i].posX / TILE_SIZE_PIXELS);
-
-                // Convert all red tiles to blue (captured), empty spaces stay empty
-                for (int i = 0; i < ROWS; i++)
-                    for (int j = 0; j < COLS; j++)
-                    {
-                        if (tileGrid[i][j] == 2)
-                            tilesCaptured++;
-                        tileGrid[i][j] = (tileGrid[i][j] == -1 ? 0 : 1);  // Mark -1 as empty, else blue
-                    }
-
-                int multiplier = 1;
-                if (tilesCaptured > 10)
-                    multiplier = 2;
-                if (rewardComboCount >= 3 && tilesCaptured > 5)
-                    multiplier = 2;
-                if (rewardComboCount >= 5 && tilesCaptured > 5)
-                    multiplier = 4;
-                score += tilesCaptured * multiplier;
-
-                if (multiplier > 1)
-                    rewardComboCount++;  // Increase combo counter for bonus tiles
-
-                // Award power-up every 50 points
-                if (score - lastPowerUpAwardScore >= 50)
-                {
-                    availablePowerUps++;
-                    lastPowerUpAwardScore = score;
-                }
-            }
-
-            // Check if enemy stepped on player's constructing tiles (game over condition)
-            for (int i = 0; i < enemyCount; i++)
-                if (tileGrid[enemies[i].posY / TILE_SIZE_PIXELS][enemies[i].posX / TILE_SIZE_PIXELS] == 2)
-                    running = false;
+            // Movement, enemies, captures and eliminations
+            profiler.begin(PHASE_SIMULATION);
+            timestep.run(sim, frameSeconds);
+            profiler.end(PHASE_SIMULATION);
 
             // When game ends (player dies or grid filled)
-            if (!running)
+            if (sim.isOver())
             {
                 // Get player's previous best score
                 int playerTopScore = auth.getPlayerTopScore(currentUser);
 
                 // Check if current score is a new personal best
-                isNewHighScore = (score > playerTopScore);
+                isNewHighScore = (player1.score > playerTopScore);
 
                 // Update player's top score if needed
-                auth.updatePlayerTopScore(currentUser, score);
+                auth.updatePlayerTopScore(currentUser, player1.score);
 
                 // Add score to leaderboard (MinHeap keeps top 10)
-                leaderboardManager.addScore(currentUser, score, currentLevelId);
+                leaderboardManager.addScore(currentUser, player1.score, currentLevelId);
 
                 // Update player profile with match result
                 PlayerProfile* profile = profileManager.getProfile(currentUser);
@@ -1599,345 +997,103 @@ int main()
                     profileManager.createProfile(currentUser);
 
                 // Win condition: score >= 450 points
-                bool playerWon = (score >= 450);
-                profileManager.updateProfile(currentUser, score, playerWon);
-                profileManager.addMatch(currentUser, score, currentLevelId, playerWon);
+                bool playerWon = (player1.score >= 450);
+                profileManager.updateProfile(currentUser, player1.score, playerWon);
+                profileManager.addMatch(currentUser, player1.score, currentLevelId, playerWon);
 
                 state = END_MENU;
             }
         }
 
         // ============================================================================
-        // MULTIPLAYER GAME LOGIC
+        // ONLINE MULTIPLAYER: only inputs cross the network
         // ============================================================================
-        if (state == MULTIPLAYER && (running || player2Running))
+        if (state == MULTIPLAYER && onlineMatch && !netSession.over(sim))
         {
-            if (running)
-            {
-                if (Keyboard::isKeyPressed(Keyboard::Left))
-                {
-                    playerDirCol = -1;
-                    playerDirRow = 0;
-                }
-                if (Keyboard::isKeyPressed(Keyboard::Right))
-                {
-                    playerDirCol = 1;
-                    playerDirRow = 0;
-                }
-                if (Keyboard::isKeyPressed(Keyboard::Up))
-                {
-                    playerDirCol = 0;
-                    playerDirRow = -1;
-                }
-                if (Keyboard::isKeyPressed(Keyboard::Down))
-                {
-                    playerDirCol = 0;
-                    playerDirRow = 1;
-                }
-
-                bool enterPressed = Keyboard::isKeyPressed(Keyboard::Enter);
-                if (enterPressed && !enterWasPressed && availablePowerUps > 0 && !isFreezeActive)
-                {
-                    player2FreezeActive = true;
-                    player2FreezeClock.restart();
-                    availablePowerUps--;
-                }
-                enterWasPressed = enterPressed;
-            }
-
-            if (player2Running && running)
-            {
-                if (Keyboard::isKeyPressed(Keyboard::A))
-                {
-                    player2DirCol = -1;
-                    player2DirRow = 0;
-                }
-                if (Keyboard::isKeyPressed(Keyboard::D))
-                {
-                    player2DirCol = 1;
-                    player2DirRow = 0;
-                }
-                if (Keyboard::isKeyPressed(Keyboard::W))
-                {
-                    player2DirCol = 0;
-                    player2DirRow = -1;
-                }
-                if (Keyboard::isKeyPressed(Keyboard::S))
-                {
-                    player2DirCol = 0;
-                    player2DirRow = 1;
-                }
-
-                bool spacePressed = Keyboard::isKeyPressed(Keyboard::Space);
-                if (spacePressed && !spaceWasPressed && player2AvailablePowerUps > 0 && !player2FreezeActive)
-                {
-                    isFreezeActive = true;
-                    freezeClock.restart();
-                    player2AvailablePowerUps--;
-                }
-                spaceWasPressed = spacePressed;
-            }
-
-            if (isFreezeActive && freezeClock.getElapsedTime().asSeconds() > 3.0f)
-                isFreezeActive = false;
-            if (player2FreezeActive && player2FreezeClock.getElapsedTime().asSeconds() > 3.0f)
-                player2FreezeActive = false;
-
-            timer += clock.restart().asSeconds();
-            if (timer > delay)
-            {
-                bool p1Frozen = isFreezeActive;
-                bool p2Frozen = player2FreezeActive;
-                if (running && !p1Frozen)
-                {
-                    playerCol += playerDirCol;
-                    playerRow += playerDirRow;
-                    playerCol = max(0, min(COLS - 1, playerCol));
-                    playerRow = max(0, min(ROWS - 1, playerRow));
+            profiler.begin(PHASE_INPUT);
+            uint8_t input = INPUT_KEEP;
+            if (Keyboard::isKeyPressed(Keyboard::Left))
+                input = INPUT_LEFT;
+            if (Keyboard::isKeyPressed(Keyboard::Right))
+                input = INPUT_RIGHT;
+            if (Keyboard::isKeyPressed(Keyboard::Up))
+                input = INPUT_UP;
+            if (Keyboard::isKeyPressed(Keyboard::Down))
+                input = INPUT_DOWN;
 
-                    int prevTile = tileGrid[playerRow][playerCol];
-                    if (playerRow == player2Row && playerCol == player2Col)
-                    {
-                        bool p1Constructing = (playerDirCol != 0 || playerDirRow != 0);
-                        bool p2Constructing = (player2DirCol != 0 || player2DirRow != 0);
-                        bool p1OnBlue = (prevTile == 1);
-
-                        if (p1OnBlue && !p1Constructing && !p2Constructing)
-                        {
-                        }
-                        else if (p1Constructing && p2Constructing)
-                        {
-                            running = false;
-                            player2Running = false;
-                        }
-                        else if (p1Constructing && !p2Constructing)
-                        {
-                            running = false;
-                        }
-                        else if (!p1Constructing && p2Constructing)
-                        {
-                            player2Running = false;
-                        }
-                    }
+            bool enterPressed = Keyboard::isKeyPressed(Keyboard::Enter);
+            if (enterPressed && !enterWasPressed)
+                input |= INPUT_POWER_UP;
+            enterWasPressed = enterPressed;
+            netSession.setLocalInput(input);
 
-                    if (tileGrid[playerRow][playerCol] == 2)
-                    {
-                        running = false;
-                    }
-                    if (tileGrid[playerRow][playerCol] == 0)
-                        tileGrid[playerRow][playerCol] = 2;
-                }
+            uint32_t firstTick;
+            while (matchClient.receiveInputs(firstTick, netInputs))
+                netSession.receive(firstTick, netInputs.data(), netInputs.size());
+            profiler.end(PHASE_INPUT);
 
-                if (player2Running && running && !p2Frozen)
-                {
-                    player2Col += player2DirCol;
-                    player2Row += player2DirRow;
-                    player2Col = max(0, min(COLS - 1, player2Col));
-                    player2Row = max(0, min(ROWS - 1, player2Row));
+            profiler.begin(PHASE_SIMULATION);
+            netSession.update(sim, frameSeconds);
+            profiler.end(PHASE_SIMULATION);
 
-                    if (playerRow == player2Row && playerCol == player2Col)
-                    {
-                        bool p1Constructing = (playerDirCol != 0 || playerDirRow != 0);
-                        bool p2Constructing = (player2DirCol != 0 || player2DirRow != 0);
-                        bool p2OnBlue = (tileGrid[player2Row][player2Col] == 1);
-
-                        if (p2OnBlue && !p1Constructing && !p2Constructing)
-                        {
-                        }
-                        else if (p1Constructing && p2Constructing)
-                        {
-                            running = false;
-                            player2Running = false;
-                        }
-                        else if (p1Constructing && !p2Constructing)
-                        {
-                            running = false;
-                        }
-                        else if (!p1Constructing && p2Constructing)
-                        {
-                            player2Running = false;
-                        }
-                    }
+            if (netSession.takeOutgoing(firstTick, netInputs))
+                matchClient.sendInputs(firstTick, netInputs);
 
-                    if (tileGrid[player2Row][player2Col] == 2 || tileGrid[player2Row][player2Col] == 3)
-                    {
-                        player2Running = false;
-                    }
-                    if (tileGrid[player2Row][player2Col] == 0)
-                        tileGrid[player2Row][player2Col] = 3;
-                }
-
-                timer = 0;
-            }
-
-            if (!isFreezeActive && !player2FreezeActive && running && player2Running)
-                for (int i = 0; i < enemyCount; i++)
-                    enemies[i].move();
-
-            if (running && tileGrid[playerRow][playerCol] == 1)
+            if (netSession.over(sim))
             {
-                playerDirCol = playerDirRow = 0;
-                int pathTiles = 0;
-
-                for (int i = 0; i < ROWS; i++)
-                    for (int j = 0; j < COLS; j++)
-                        if (tileGrid[i][j] == 2)
-                            pathTiles++;
-
-                if (pathTiles > 0)
-                {
-                    for (int i = 0; i < enemyCount; i++)
-                    {
-                        int enemyRow = enemies[i].posY / TILE_SIZE_PIXELS;
-                        int enemyCol = enemies[i].posX / TILE_SIZE_PIXELS;
-                        floodFillMark(enemyRow, enemyCol);
-                    }
-
-                    int tilesCaptured = 0;
-                    for (int i = 0; i < ROWS; i++)
-                        for (int j = 0; j < COLS; j++)
-                        {
-                            if (tileGrid[i][j] == 2)
-                                tilesCaptured++;
-                            else if (tileGrid[i][j] == 0 && i > 0 && i < ROWS - 1 && j > 0 && j < COLS - 1)
-                                tilesCaptured++;
-                        }
-
-                    for (int i = 0; i < ROWS; i++)
-                        for (int j = 0; j < COLS; j++)
-                        {
-                            if (tileGrid[i][j] == -1)
-                                tileGrid[i][j] = 0;
-                            else if (tileGrid[i][j] == 2 || tileGrid[i][j] == 0)
-                                tileGrid[i][j] = 1;
-                        }
-
-                    int multiplier = 1;
-                    if (tilesCaptured > 10)
-                        multiplier = 2;
-                    if (rewardComboCount >= 3 && tilesCaptured > 5)
-                        multiplier = 2;
-                    if (rewardComboCount >= 5 && tilesCaptured > 5)
-                        multiplier = 4;
-                    score += tilesCaptured * multiplier;
-                    if (multiplier > 1)
-                        rewardComboCount++;
-
-                    if (score - lastPowerUpAwardScore >= 50)
-                    {
-                        availablePowerUps++;
-                        lastPowerUpAwardScore = score;
-                    }
-                }
+                int myScore = sim.players[netSession.localSeat()].score;
+                auth.updatePlayerScore(currentUser, myScore);
+                leaderboardManager.addScore(currentUser, myScore, currentLevelId);
+                state = END_MENU;
             }
+        }
 
-            if (player2Running && running && tileGrid[player2Row][player2Col] == 1)
-            {
-                player2DirCol = player2DirRow = 0;
-                int pathTiles = 0;
-
-                for (int i = 0; i < ROWS; i++)
-                    for (int j = 0; j < COLS; j++)
-                        if (tileGrid[i][j] == 3)
-                            pathTiles++;
-
-                if (pathTiles > 0)
-                {
-                    for (int i = 0; i < enemyCount; i++)
-                    {
-                        int enemyRow = enemies[i].posY / TILE_SIZE_PIXELS;
-                        int enemyCol = enemies[i].posX / TILE_SIZE_PIXELS;
-                        floodFillMark(enemyRow, enemyCol);
-                    }
+        // ============================================================================
+        // MULTIPLAYER GAME LOGIC
+        // ============================================================================
+        if (state == MULTIPLAYER && !onlineMatch && !sim.isOver())
+        {
+            profiler.begin(PHASE_INPUT);
+            if (Keyboard::isKeyPressed(Keyboard::Left))
+                sim.setDirection(0, 0, -1);
+            if (Keyboard::isKeyPressed(Keyboard::Right))
+                sim.setDirection(0, 0, 1);
+            if (Keyboard::isKeyPressed(Keyboard::Up))
+                sim.setDirection(0, -1, 0);
+            if (Keyboard::isKeyPressed(Keyboard::Down))
+                sim.setDirection(0, 1, 0);
+
+            bool enterPressed = Keyboard::isKeyPressed(Keyboard::Enter);
+            if (enterPressed && !enterWasPressed)
+                sim.usePowerUp(0);
+            enterWasPressed = enterPressed;
+
+            if (Keyboard::isKeyPressed(Keyboard::A))
+                sim.setDirection(1, 0, -1);
+            if (Keyboard::isKeyPressed(Keyboard::D))
+                sim.setDirection(1, 0, 1);
+            if (Keyboard::isKeyPressed(Keyboard::W))
+                sim.setDirection(1, -1, 0);
+            if (Keyboard::isKeyPressed(Keyboard::S))
+                sim.setDirection(1, 1, 0);
 
-                    int tilesCaptured = 0;
-                    for (int i = 0; i < ROWS; i++)
-                        for (int j = 0; j < COLS; j++)
-                        {
-                            if (tileGrid[i][j] == 3)
-                                tilesCaptured++;
-                            else if (tileGrid[i][j] == 0 && i > 0 && i < ROWS - 1 && j > 0 && j < COLS - 1)
-                                tilesCaptured++;
-                        }
-
-                    for (int i = 0; i < ROWS; i++)
-                        for (int j = 0; j < COLS; j++)
-                        {
-                            if (tileGrid[i][j] == -1)
-                                tileGrid[i][j] = 0;
-                            else if (tileGrid[i][j] == 3 || tileGrid[i][j] == 0)
-                                tileGrid[i][j] = 1;
-                        }
-
-                    int multiplier = 1;
-                    if (tilesCaptured > 10)
-                        multiplier = 2;
-                    if (player2RewardComboCount >= 3 && tilesCaptured > 5)
-                        multiplier = 2;
-                    if (player2RewardComboCount >= 5 && tilesCaptured > 5)
-                        multiplier = 4;
-                    player2Score += tilesCaptured * multiplier;
-                    if (multiplier > 1)
-                        player2RewardComboCount++;
-
-                    if (player2Score - player2LastPowerUpAwardScore >= 50)
-                    {
-                        player2AvailablePowerUps++;
-                        player2LastPowerUpAwardScore = player2Score;
-                    }
-                }
+            bool spacePressed = Keyboard::isKeyPressed(Keyboard::Space);
+            if (spacePressed && !spaceWasPressed)
+                sim.usePowerUp(1);
+            spaceWasPressed = spacePressed;
 
-                int emptyTiles = 0;
-                for (int i = 0; i < ROWS; i++)
-                    for (int j = 0; j < COLS; j++)
-                        if (tileGrid[i][j] == 0)
-                            emptyTiles++;
-                if (emptyTiles == 0)
-                {
-                    running = false;
-                    player2Running = false;
-                }
-            }
+            profiler.end(PHASE_INPUT);
 
-            for (int i = 0; i < enemyCount; i++)
-            {
-                int enemyRow = enemies[i].posY / TILE_SIZE_PIXELS;
-                int enemyCol = enemies[i].posX / TILE_SIZE_PIXELS;
-                if (enemyCol >= 0 && enemyCol < COLS && enemyRow >= 0 && enemyRow < ROWS)
-                {
-                    if (tileGrid[enemyRow][enemyCol] == 2)
-                    {
-                        running = false;
-                    }
-                    if (tileGrid[enemyRow][enemyCol] == 3)
-                    {
-                        player2Running = false;
-                    }
-                }
-            }
+            profiler.begin(PHASE_SIMULATION);
+            timestep.run(sim, frameSeconds);
+            profiler.end(PHASE_SIMULATION);
 
-            if (!running && player2Running)
-            {
-                auth.updatePlayerScore(currentUser, score);
-                auth.updatePlayerScore(player2Username, player2Score);
-                leaderboardManager.addScore(currentUser, score, currentLevelId);
-                leaderboardManager.addScore(player2Username, player2Score, currentLevelId);
-                state = END_MENU;
-            }
-            if (running && !player2Running)
-            {
-                auth.updatePlayerScore(currentUser, score);
-                auth.updatePlayerScore(player2Username, player2Score);
-                leaderboardManager.addScore(currentUser, score, currentLevelId);
-                leaderboardManager.addScore(player2Username, player2Score, currentLevelId);
-                state = END_MENU;
-            }
-            if (!running && !player2Running)
+            if (sim.isOver())
             {
-                auth.updatePlayerScore(currentUser, score);
-                auth.updatePlayerScore(player2Username, player2Score);
-                leaderboardManager.addScore(currentUser, score, currentLevelId);
-                leaderboardManager.addScore(player2Username, player2Score, currentLevelId);
+                auth.updatePlayerScore(currentUser, player1.score);
+                auth.updatePlayerScore(player2Username, player2.score);
+                leaderboardManager.addScore(currentUser, player1.score, currentLevelId);
+                leaderboardManager.addScore(player2Username, player2.score, currentLevelId);
                 state = END_MENU;
             }
         }
@@ -1945,13 +1101,14 @@ int main()
         // ============================================================================
         // DRAW
         // ============================================================================
+        profiler.begin(PHASE_DRAW);
         window.clear();
+        // Enemies are drawn this far between their last two ticks
+        float tickAlpha = onlineMatch ? netSession.tickFraction() : timestep.alpha();
 
         if (state == LOGIN_SCREEN)
         {
-            Text t("XONIX GAME", font, 40);
-            FloatRect b = t.getLocalBounds();
-            t.setOrigin(b.width / 2, b.height / 2);
+            Text& t = texts.centered("login_screen.t", "XONIX GAME", 40);
             t.setPosition(centerX, 80);
             window.draw(t);
             usernameInputLogin.draw(window);
@@ -1962,19 +1119,15 @@ int main()
             registerScreenButton.draw(window);
             if (!errorMessage.empty() && errorClock.getElapsedTime().asSeconds() < 3)
             {
-                Text e(errorMessage, font, 16);
+                Text& e = texts.centered("login_screen.e", errorMessage, 16);
                 e.setFillColor(Color::Red);
-                FloatRect eb = e.getLocalBounds();
-                e.setOrigin(eb.width / 2, eb.height / 2);
                 e.setPosition(centerX, 280);
                 window.draw(e);
             }
         }
         else if (state == REGISTER_SCREEN)
         {
-            Text t("CREATE ACCOUNT", font, 30);
-            FloatRect b = t.getLocalBounds();
-            t.setOrigin(b.width / 2, b.height / 2);
+            Text& t = texts.centered("register_screen.t", "CREATE ACCOUNT", 30);
             t.setPosition(centerX, 150);
             window.draw(t);
             usernameInputRegister.draw(window);
@@ -1985,19 +1138,15 @@ int main()
             backButton.draw(window);
             if (!errorMessage.empty() && errorClock.getElapsedTime().asSeconds() < 3)
             {
-                Text e(errorMessage, font, 16);
+                Text& e = texts.centered("register_screen.e", errorMessage, 16);
                 e.setFillColor(Color::Red);
-                FloatRect eb = e.getLocalBounds();
-                e.setOrigin(eb.width / 2, eb.height / 2);
                 e.setPosition(centerX, 330);
                 window.draw(e);
             }
         }
         else if (state == MAIN_MENU)
         {
-            Text t("WELCOME " + currentUser + "!", font, 40);
-            FloatRect b = t.getLocalBounds();
-            t.setOrigin(b.width / 2, b.height / 2);
+            Text& t = texts.centered("main_menu.t", "WELCOME " + currentUser + "!", 40);
             t.setPosition(centerX, ROWS * TILE_SIZE_PIXELS / 2 - 100);
             window.draw(t);
             playGameButton.update(mouse);
@@ -2005,15 +1154,11 @@ int main()
         }
         else if (state == START_MENU)
         {
-            Text t("WELCOME " + currentUser + "!", font, 40);
-            FloatRect b = t.getLocalBounds();
-            t.setOrigin(b.width / 2, b.height / 2);
+            Text& t = texts.centered("start_menu.t", "WELCOME " + currentUser + "!", 40);
             t.setPosition(centerX, 80);
             window.draw(t);
 
-            Text sub("Main Menu", font, 18);
-            FloatRect sb = sub.getLocalBounds();
-            sub.setOrigin(sb.width / 2, sb.height / 2);
+            Text& sub = texts.centered("start_menu.sub", "Main Menu", 18);
             sub.setPosition(centerX, 120);
             sub.setFillColor(Color::White);
             window.draw(sub);
@@ -2032,15 +1177,11 @@ int main()
         // MODE_SELECT - Choose Single or Multiplayer
         else if (state == MODE_SELECT)
         {
-            Text t("SELECT MODE", font, 40);
-            FloatRect b = t.getLocalBounds();
-            t.setOrigin(b.width / 2, b.height / 2);
+            Text& t = texts.centered("mode_select.t", "SELECT MODE", 40);
             t.setPosition(centerX, 80);
             window.draw(t);
 
-            Text info("Choose Single Player or Multiplayer", font, 18);
-            FloatRect ib = info.getLocalBounds();
-            info.setOrigin(ib.width / 2, ib.height / 2);
+            Text& info = texts.centered("mode_select.info", "Choose Single Player or Multiplayer", 18);
             info.setPosition(centerX, 130);
             info.setFillColor(Color::White);
             window.draw(info);
@@ -2055,26 +1196,47 @@ int main()
         // ============================================================================
         else if (state == MATCHMAKING_QUEUE)
         {
-            Text title("MATCHMAKING QUEUE", font, 40);
-            FloatRect b = title.getLocalBounds();
-            title.setOrigin(roundf(b.width / 2), roundf(b.height / 2));
+            Text& title = texts.centered("matchmaking_queue.title", "MATCHMAKING QUEUE", 40);
             setTextPosition(title, centerX, 80);
             window.draw(title);
 
             string statsText = "Your Score: " + to_string(player1Queue.score);
-            Text stats(statsText, font, 24);
-            FloatRect sb = stats.getLocalBounds();
-            stats.setOrigin(roundf(sb.width / 2), roundf(sb.height / 2));
+            Text& stats = texts.centered("matchmaking_queue.stats", statsText, 24);
             setTextPosition(stats, centerX, 150);
             window.draw(stats);
 
             string queueText = "Players in Queue: " + to_string(matchmaking.getQueueSize());
-            Text queue(queueText, font, 20);
-            FloatRect qb = queue.getLocalBounds();
-            queue.setOrigin(roundf(qb.width / 2), roundf(qb.height / 2));
+            Text& queue = texts.centered("matchmaking_queue.queue", queueText, 20);
             setTextPosition(queue, centerX, 200);
             window.draw(queue);
 
+            if (!matchmakerAddress.empty())
+            {
+                string onlineText;
+                Color onlineColor = Color::Yellow;
+                if (matchClient.status() == MatchClient::MATCHED)
+                {
+                    const MatchInfo& match = matchClient.match();
+                    onlineText = "Online: matched with " + match.opponent + " ( Score: " + to_string(match.opponentScore) + " )";
+                    onlineColor = Color::Green;
+                }
+                else if (matchClient.status() == MatchClient::QUEUED)
+                    onlineText = "Online: searching... " + to_string(matchClient.playersWaiting()) + " players waiting";
+                else if (matchClient.status() == MatchClient::FAILED)
+                {
+                    onlineText = "Online: " + matchClient.error();
+                    onlineColor = Color::Red;
+                }
+                else if (matchClient.status() == MatchClient::CONNECTING)
+                    onlineText = "Online: connecting to " + matchmakerAddress + "...";
+                else
+                    onlineText = "Online: joining the queue...";
+                Text& online = texts.centered("matchmaking_queue.online", onlineText, 16);
+                online.setFillColor(onlineColor);
+                setTextPosition(online, centerX, 380);
+                window.draw(online);
+            }
+
             addPlayer2Button.update(mouse);
             addPlayer2Button.draw(window);
             leaveQueueButton.update(mouse);
@@ -2085,32 +1247,24 @@ int main()
         // ============================================================================
         else if (state == GAME_ROOM)
         {
-            Text title("GAME ROOM", font, 40);
-            FloatRect b = title.getLocalBounds();
-            title.setOrigin(roundf(b.width / 2), roundf(b.height / 2));
+            Text& title = texts.centered("game_room.title", "GAME ROOM", 40);
             setTextPosition(title, centerX, 60);
             window.draw(title);
 
             string p1Text = "Player 1: " + currentUser + " ( Score: " + to_string(player1Queue.score) + " )";
-            Text p1(p1Text, font, 20);
-            FloatRect p1b = p1.getLocalBounds();
-            p1.setOrigin(roundf(p1b.width / 2), roundf(p1b.height / 2));
+            Text& p1 = texts.centered("game_room.p1", p1Text, 20);
             setTextPosition(p1, centerX, 110);
             window.draw(p1);
 
             if (player2LoggedIn)
             {
                 string p2Text = "Player 2: " + player2Username + " ( Score: " + to_string(player2Queue.score) + " )";
-                Text p2(p2Text, font, 20);
-                FloatRect p2b = p2.getLocalBounds();
-                p2.setOrigin(roundf(p2b.width / 2), roundf(p2b.height / 2));
+                Text& p2 = texts.centered("game_room.p2", p2Text, 20);
                 setTextPosition(p2, centerX, 140);
                 window.draw(p2);
 
-                Text statsTitle("--- MATCHMAKING STATS ---", font, 18);
+                Text& statsTitle = texts.centered("game_room.statsTitle", "--- MATCHMAKING STATS ---", 18);
                 statsTitle.setFillColor(Color::Yellow);
-                FloatRect stb = statsTitle.getLocalBounds();
-                statsTitle.setOrigin(roundf(stb.width / 2), roundf(stb.height / 2));
                 setTextPosition(statsTitle, centerX, 180);
                 window.draw(statsTitle);
 
@@ -2119,10 +1273,8 @@ int main()
                     p1QueueStats += " (" + to_string(player1PlayersAbove) + " players ahead)";
                 else if (player1PlayersAbove == 0)
                     p1QueueStats += " (Top Priority!)";
-                Text p1Stats(p1QueueStats, font, 16);
+                Text& p1Stats = texts.centered("game_room.p1Stats", p1QueueStats, 16);
                 p1Stats.setFillColor(Color::Cyan);
-                FloatRect p1sb = p1Stats.getLocalBounds();
-                p1Stats.setOrigin(roundf(p1sb.width / 2), roundf(p1sb.height / 2));
                 setTextPosition(p1Stats, centerX, 210);
                 window.draw(p1Stats);
 
@@ -2131,10 +1283,8 @@ int main()
                     p2QueueStats += " (" + to_string(player2PlayersAbove) + " players ahead)";
                 else if (player2PlayersAbove == 0)
                     p2QueueStats += " (Top Priority!)";
-                Text p2Stats(p2QueueStats, font, 16);
+                Text& p2Stats = texts.centered("game_room.p2Stats", p2QueueStats, 16);
                 p2Stats.setFillColor(Color(255, 200, 100));
-                FloatRect p2sb = p2Stats.getLocalBounds();
-                p2Stats.setOrigin(roundf(p2sb.width / 2), roundf(p2sb.height / 2));
                 setTextPosition(p2Stats, centerX, 235);
                 window.draw(p2Stats);
 
@@ -2155,10 +1305,8 @@ int main()
                     priorityText = "EQUAL PRIORITY (Both have score: " + to_string(player1Queue.score) + ")";
                     priorityColor = Color::Green;
                 }
-                Text priority(priorityText, font, 16);
+                Text& priority = texts.centered("game_room.priority", priorityText, 16);
                 priority.setFillColor(priorityColor);
-                FloatRect prb = priority.getLocalBounds();
-                priority.setOrigin(roundf(prb.width / 2), roundf(prb.height / 2));
                 setTextPosition(priority, centerX, 265);
                 window.draw(priority);
 
@@ -2169,19 +1317,15 @@ int main()
                     firstInQueue = player2Username + " joined queue first (Position #" + to_string(player2QueuePosition) + ")";
                 else
                     firstInQueue = "Both had same queue position";
-                Text firstQ(firstInQueue, font, 14);
+                Text& firstQ = texts.centered("game_room.firstQ", firstInQueue, 14);
                 firstQ.setFillColor(Color(180, 180, 180));
-                FloatRect fqb = firstQ.getLocalBounds();
-                firstQ.setOrigin(roundf(fqb.width / 2), roundf(fqb.height / 2));
                 setTextPosition(firstQ, centerX, 295);
                 window.draw(firstQ);
 
                 int scoreDiff = abs(player1Queue.score - player2Queue.score);
                 string diffText = "Score Difference: " + to_string(scoreDiff) + " points";
-                Text diff(diffText, font, 14);
+                Text& diff = texts.centered("game_room.diff", diffText, 14);
                 diff.setFillColor(Color(150, 150, 150));
-                FloatRect db = diff.getLocalBounds();
-                diff.setOrigin(roundf(db.width / 2), roundf(db.height / 2));
                 setTextPosition(diff, centerX, 320);
                 window.draw(diff);
 
@@ -2203,19 +1347,15 @@ int main()
 
             if (!errorMessage.empty() && errorClock.getElapsedTime().asSeconds() < 3)
             {
-                Text e(errorMessage, font, 16);
+                Text& e = texts.centered("game_room.e", errorMessage, 16);
                 e.setFillColor(Color::Red);
-                FloatRect eb = e.getLocalBounds();
-                e.setOrigin(eb.width / 2, eb.height / 2);
                 e.setPosition(centerX, 420);
                 window.draw(e);
             }
         }
         else if (state == SELECT_LEVEL)
         {
-            Text t("SELECT LEVEL", font, 40);
-            FloatRect b = t.getLocalBounds();
-            t.setOrigin(b.width / 2, b.height / 2);
+            Text& t = texts.centered("select_level.t", "SELECT LEVEL", 40);
             t.setPosition(centerX, 80);
             window.draw(t);
 
@@ -2233,7 +1373,7 @@ int main()
             bool backArrowHovered = (mouse.x >= 10 && mouse.x <= 60 &&
                 mouse.y >= 20 && mouse.y <= 70);
 
-            Text backArrow("<", font, 50);
+            Text& backArrow = texts.get("leaderboard.backArrow", "<", 50);
             backArrow.setFillColor(backArrowHovered ? Color(128, 128, 128) : Color::White);
             backArrow.setPosition(20, 30);
             window.draw(backArrow);
@@ -2242,26 +1382,32 @@ int main()
             backButtonArea.setPosition(10, 20);
             backButtonArea.setFillColor(Color::Transparent);
 
-            Text t("LEADERBOARD", font, 40);
-            FloatRect b = t.getLocalBounds();
-            t.setOrigin(b.width / 2, b.height / 2);
+            Text& t = texts.centered("leaderboard.t", "LEADERBOARD", 40);
             t.setPosition(centerX, 50);
             window.draw(t);
 
-            LeaderboardEntry* sorted = leaderboardManager.getLeaderboard();
-            int count = leaderboardManager.getCount();
+            static const char* windowLabels[WINDOW_COUNT] = { "All time", "This week", "Today" };
+            string boardName = leaderboardLevel == 0 ? "All levels" : levels[leaderboardLevel - 1].name;
+            Text& boardText = texts.topCentered("leaderboard.board",
+                "< " + boardName + " >   " + windowLabels[leaderboardWindow], 16);
+            boardText.setFillColor(Color::Yellow);
+            setTextPosition(boardText, centerX, 82);
+            window.draw(boardText);
+
+            const vector<LeaderboardEntry>& sorted = leaderboardManager.getLeaderboard(leaderboardLevel, leaderboardWindow);
+            int count = (int)sorted.size();
 
-            Text rankHeader("RANK", font, 14);
+            Text& rankHeader = texts.get("leaderboard.rankHeader", "RANK", 14);
             rankHeader.setFillColor(Color::Cyan);
             rankHeader.setPosition(centerX - 240, 120);
             window.draw(rankHeader);
 
-            Text playerHeader("PLAYER", font, 14);
+            Text& playerHeader = texts.get("leaderboard.playerHeader", "PLAYER", 14);
             playerHeader.setFillColor(Color::Cyan);
             playerHeader.setPosition(centerX - 100, 120);
             window.draw(playerHeader);
 
-            Text scoreHeader("SCORE", font, 14);
+            Text& scoreHeader = texts.get("leaderboard.scoreHeader", "SCORE", 14);
             scoreHeader.setFillColor(Color::Cyan);
             scoreHeader.setPosition(centerX + 200, 120);
             window.draw(scoreHeader);
@@ -2270,19 +1416,19 @@ int main()
             {
                 char rankStr[10];
                 snprintf(rankStr, sizeof(rankStr), "%d", i + 1);
-                Text rankText(rankStr, font, 14);
+                Text& rankText = texts.get("leaderboard.rankText", i, rankStr, 14);
                 rankText.setFillColor(i < 3 ? Color::Cyan : Color::White);
                 rankText.setPosition(centerX - 240, 160 + i * 28);
                 window.draw(rankText);
 
-                Text playerText(sorted[i].username, font, 14);
+                Text& playerText = texts.get("leaderboard.playerText", i, sorted[i].username, 14);
                 playerText.setFillColor(i < 3 ? Color::Cyan : Color::White);
                 playerText.setPosition(centerX - 100, 160 + i * 28);
                 window.draw(playerText);
 
                 char scoreStr[20];
                 snprintf(scoreStr, sizeof(scoreStr), "%d", sorted[i].score);
-                Text scoreText(scoreStr, font, 14);
+                Text& scoreText = texts.get("leaderboard.scoreText", i, scoreStr, 14);
                 scoreText.setFillColor(i < 3 ? Color::Cyan : Color::White);
                 scoreText.setPosition(centerX + 200, 160 + i * 28);
                 window.draw(scoreText);
@@ -2290,27 +1436,42 @@ int main()
 
             if (count == 0)
             {
-                Text empty("No scores yet!", font, 18);
+                Text& empty = texts.get("leaderboard.empty", "No scores yet!", 18);
                 empty.setFillColor(Color::White);
                 empty.setPosition(centerX - 100, 200);
                 window.draw(empty);
             }
 
-            leaderboardManager.freeLeaderboard(sorted);
+            // Where the logged-in player stands among everyone who has scored
+            int myRank = leaderboardManager.rankOf(currentUser);
+            if (myRank > 0)
+            {
+                int myBest = leaderboardManager.bestScore(currentUser);
+                char rankLine[96];
+                snprintf(rankLine, sizeof(rankLine), "Your best: %d  -  rank #%d of %d  -  better than %.1f%% of players",
+                    myBest, myRank, leaderboardManager.rankedPlayers(), leaderboardManager.percentile(myBest));
+                Text& myRankText = texts.topCentered("leaderboard.myRank", rankLine, 14);
+                myRankText.setFillColor(Color::Yellow);
+                setTextPosition(myRankText, centerX, 160 + 10 * 28 + 16);
+                window.draw(myRankText);
+            }
+
+            Text& hint = texts.topCentered("leaderboard.hint", "Left/Right: level   Up/Down: today, this week, all time", 12);
+            hint.setFillColor(Color(128, 128, 128));
+            setTextPosition(hint, centerX, 160 + 10 * 28 + 44);
+            window.draw(hint);
         }
         else if (state == PROFILE)
         {
             bool backArrowHovered = (mouse.x >= 10 && mouse.x <= 60 &&
                 mouse.y >= 20 && mouse.y <= 70);
 
-            Text backArrow("<", font, 50);
+            Text& backArrow = texts.get("profile.backArrow", "<", 50);
             backArrow.setFillColor(backArrowHovered ? Color(128, 128, 128) : Color::White);
             backArrow.setPosition(20, 30);
             window.draw(backArrow);
 
-            Text t("PLAYER PROFILE", font, 40);
-            FloatRect b = t.getLocalBounds();
-            t.setOrigin(b.width / 2, b.height / 2);
+            Text& t = texts.centered("profile.t", "PLAYER PROFILE", 40);
             t.setPosition(centerX, 50);
             window.draw(t);
 
@@ -2325,7 +1486,7 @@ int main()
                 window.draw(profileBox);
 
                 // Username
-                Text usernameLabel("Username: " + profile->username, font, 18);
+                Text& usernameLabel = texts.get("profile.usernameLabel", "Username: " + profile->username, 18);
                 usernameLabel.setFillColor(Color::White);
                 usernameLabel.setPosition(centerX - 230, 125);
                 window.draw(usernameLabel);
@@ -2335,24 +1496,24 @@ int main()
                 separator.setFillColor(Color::White);
                 window.draw(separator);
 
-                Text pointsLabel("Total Points: " + to_string(profile->totalPoints), font, 16);
+                Text& pointsLabel = texts.get("profile.pointsLabel", "Total Points: " + to_string(profile->totalPoints), 16);
                 pointsLabel.setFillColor(Color::White);
                 pointsLabel.setPosition(centerX - 230, 168);
                 window.draw(pointsLabel);
 
-                Text statsLabel("Wins: " + to_string(profile->wins) + "  |  Losses: " + to_string(profile->losses), font, 16);
+                Text& statsLabel = texts.get("profile.statsLabel", "Wins: " + to_string(profile->wins) + "  |  Losses: " + to_string(profile->losses), 16);
                 statsLabel.setFillColor(Color::Green);
                 statsLabel.setPosition(centerX - 230, 195);
                 window.draw(statsLabel);
 
-                Text friendsTitle("Friends", font, 15);
+                Text& friendsTitle = texts.get("profile.friendsTitle", "Friends", 15);
                 friendsTitle.setFillColor(Color::White);
                 friendsTitle.setPosition(centerX - 230, 225);
                 window.draw(friendsTitle);
 
                 for (int i = 0; i < profile->friendCount && i < 2; i++)
                 {
-                    Text friendText("  � " + profile->friends[i], font, 13);
+                    Text& friendText = texts.get("profile.friendText", i, "  � " + profile->friends[i], 13);
                     friendText.setFillColor(Color::White);
                     friendText.setPosition(centerX - 220, 243 + i * 16);
                     window.draw(friendText);
@@ -2360,7 +1521,7 @@ int main()
 
                 if (profile->friendCount == 0)
                 {
-                    Text noFriends("  (No friends)", font, 13);
+                    Text& noFriends = texts.get("profile.noFriends", "  (No friends)", 13);
                     noFriends.setFillColor(Color(150, 150, 150));
                     noFriends.setPosition(centerX - 220, 243);
                     window.draw(noFriends);
@@ -2371,9 +1532,15 @@ int main()
         {
             if (gameMode == 2) // Multiplayer END MENU
             {
-                Text resultTitle("GAME OVER", font, 40);
-                FloatRect rtitle = resultTitle.getLocalBounds();
-                resultTitle.setOrigin(rtitle.width / 2, rtitle.height / 2);
+                // Online, the left side is seat 0 whoever holds it
+                string p1Name = currentUser, p2Name = player2Username;
+                if (onlineMatch)
+                {
+                    p1Name = netSession.localSeat() == 0 ? currentUser : matchClient.match().opponent;
+                    p2Name = netSession.localSeat() == 1 ? currentUser : matchClient.match().opponent;
+                }
+
+                Text& resultTitle = texts.centered("end_menu.resultTitle", "GAME OVER", 40);
                 resultTitle.setPosition(centerX, 120);
                 resultTitle.setFillColor(Color::White);
                 window.draw(resultTitle);
@@ -2381,14 +1548,14 @@ int main()
                 // Determine winner
                 string winner = "";
                 Color winnerColor = Color::White;
-                if (score > player2Score)
+                if (player1.score > player2.score)
                 {
-                    winner = currentUser + " WINS!";
+                    winner = p1Name + " WINS!";
                     winnerColor = Color::Cyan;
                 }
-                else if (player2Score > score)
+                else if (player2.score > player1.score)
                 {
-                    winner = player2Username + " WINS!";
+                    winner = p2Name + " WINS!";
                     winnerColor = Color(255, 255, 0); // Yellow
                 }
                 else
@@ -2397,68 +1564,54 @@ int main()
                     winnerColor = Color::Green;
                 }
 
-                Text winnerText(winner, font, 36);
-                FloatRect wt = winnerText.getLocalBounds();
-                winnerText.setOrigin(wt.width / 2, wt.height / 2);
+                Text& winnerText = texts.centered("end_menu.winnerText", winner, 36);
                 winnerText.setPosition(centerX, 180);
                 winnerText.setFillColor(winnerColor);
                 window.draw(winnerText);
 
                 // Player 1 Score
-                Text p1Label(currentUser + "'s Score:", font, 20);
+                Text& p1Label = texts.get("end_menu.p1Label", p1Name + "'s Score:", 20);
                 p1Label.setFillColor(Color::Cyan);
                 p1Label.setPosition(centerX - 200, 250);
                 window.draw(p1Label);
 
-                Text p1Score(to_string(score), font, 32);
+                Text& p1Score = texts.topCentered("end_menu.p1Score", to_string(player1.score), 32);
                 p1Score.setFillColor(Color::Cyan);
-                FloatRect p1s = p1Score.getLocalBounds();
-                p1Score.setOrigin(p1s.width / 2, 0);
                 p1Score.setPosition(centerX - 200, 280);
                 window.draw(p1Score);
 
                 // Player 2 Score
-                Text p2Label(player2Username + "'s Score:", font, 20);
+                Text& p2Label = texts.get("end_menu.p2Label", p2Name + "'s Score:", 20);
                 p2Label.setFillColor(Color(255, 255, 0)); // Yellow
                 p2Label.setPosition(centerX + 50, 250);
                 window.draw(p2Label);
 
-                Text p2Score(to_string(player2Score), font, 32);
+                Text& p2Score = texts.topCentered("end_menu.p2Score", to_string(player2.score), 32);
                 p2Score.setFillColor(Color(255, 255, 0)); // Yellow
-                FloatRect p2s = p2Score.getLocalBounds();
-                p2Score.setOrigin(p2s.width / 2, 0);
                 p2Score.setPosition(centerX + 50, 280);
                 window.draw(p2Score);
             }
             else // Single Player END MENU
             {
-                Text resultTitle("GAME OVER", font, 40);
-                FloatRect rtitle = resultTitle.getLocalBounds();
-                resultTitle.setOrigin(rtitle.width / 2, rtitle.height / 2);
+                Text& resultTitle = texts.centered("end_menu.resultTitle2", "GAME OVER", 40);
                 resultTitle.setPosition(centerX, 120);
                 resultTitle.setFillColor(Color::White);
                 window.draw(resultTitle);
 
-                Text finalScoreLabel("FINAL SCORE", font, 20);
+                Text& finalScoreLabel = texts.centered("end_menu.finalScoreLabel", "FINAL SCORE", 20);
                 finalScoreLabel.setFillColor(Color::White);
-                FloatRect fsl = finalScoreLabel.getLocalBounds();
-                finalScoreLabel.setOrigin(fsl.width / 2, fsl.height / 2);
                 finalScoreLabel.setPosition(centerX, 200);
                 window.draw(finalScoreLabel);
 
-                Text finalScore(to_string(score), font, 48);
+                Text& finalScore = texts.centered("end_menu.finalScore", to_string(player1.score), 48);
                 finalScore.setFillColor(isNewHighScore ? Color::Cyan : Color::White);
-                FloatRect fs = finalScore.getLocalBounds();
-                finalScore.setOrigin(fs.width / 2, fs.height / 2);
                 finalScore.setPosition(centerX, 240);
                 window.draw(finalScore);
 
                 if (isNewHighScore)
                 {
-                    Text newHighScore("NEW HIGH SCORE!", font, 28);
+                    Text& newHighScore = texts.centered("end_menu.newHighScore", "NEW HIGH SCORE!", 28);
                     newHighScore.setFillColor(Color::Cyan);
-                    FloatRect nh = newHighScore.getLocalBounds();
-                    newHighScore.setOrigin(nh.width / 2, nh.height / 2);
                     newHighScore.setPosition(centerX, 300);
                     window.draw(newHighScore);
                 }
@@ -2476,6 +1629,14 @@ int main()
         // ============================================================================
         else if (state == MULTIPLAYER)
         {
+            // Online, the left panel is seat 0 whoever holds it
+            string p1Label = currentUser, p2Label = player2Username;
+            if (onlineMatch)
+            {
+                p1Label = netSession.localSeat() == 0 ? currentUser : matchClient.match().opponent;
+                p2Label = netSession.localSeat() == 1 ? currentUser : matchClient.match().opponent;
+            }
+
             RectangleShape leftPanel, rightPanel, bottomPanel;
             leftPanel.setSize({ (float)HUD_PANEL_WIDTH, (float)ROWS * TILE_SIZE_PIXELS });
             leftPanel.setPosition(0, 0);
@@ -2492,157 +1653,126 @@ int main()
             bottomPanel.setFillColor(Color(30, 30, 30));
             window.draw(bottomPanel);
 
-            for (int i = 0; i < ROWS; i++)
-                for (int j = 0; j < COLS; j++)
-                {
-                    if (tileGrid[i][j] == 0)
-                        continue;
-                    int tileType = 0;
-                    if (tileGrid[i][j] == 1)
-                        tileType = 0;
-                    else if (tileGrid[i][j] == 2)
-                        tileType = 54;
-                    else if (tileGrid[i][j] == 3)
-                        tileType = 72;
-                    sTile.setTextureRect(IntRect(tileType, 0, TILE_SIZE_PIXELS, TILE_SIZE_PIXELS));
-                    sTile.setPosition(HUD_PANEL_WIDTH + j * TILE_SIZE_PIXELS, i * TILE_SIZE_PIXELS);
-                    window.draw(sTile);
-                }
-
-            sTile.setTextureRect(IntRect(36, 0, TILE_SIZE_PIXELS, TILE_SIZE_PIXELS));
-            sTile.setPosition(HUD_PANEL_WIDTH + playerCol * TILE_SIZE_PIXELS, playerRow * TILE_SIZE_PIXELS);
-            window.draw(sTile);
-
-            sTile.setTextureRect(IntRect(18, 0, TILE_SIZE_PIXELS, TILE_SIZE_PIXELS));
-            sTile.setPosition(HUD_PANEL_WIDTH + player2Col * TILE_SIZE_PIXELS, player2Row * TILE_SIZE_PIXELS);
-            window.draw(sTile);
+            tileMap.update(sim);
+            sim.clearDirty();
+            window.draw(tileMap);
 
-            for (int i = 0; i < enemyCount; i++)
+            for (int i = 0; i < sim.enemyCount; i++)
             {
-                sEnemy.setPosition(HUD_PANEL_WIDTH + enemies[i].posX, enemies[i].posY);
-                if (running && player2Running)
-                    sEnemy.rotate(4);
+                sEnemy.setPosition(HUD_PANEL_WIDTH + sim.enemies[i].drawX(tickAlpha), sim.enemies[i].drawY(tickAlpha));
+                if (player1.running && player2.running)
+                    sEnemy.rotate(ENEMY_SPIN_DEGREES_PER_SECOND * frameSeconds);
                 else
                     sEnemy.setRotation(0);
                 window.draw(sEnemy);
             }
 
-            Text p1Title("PLAYER 1", font, 20);
+            Text& p1Title = texts.topCentered("multiplayer.p1Title", "PLAYER 1", 20);
             p1Title.setFillColor(Color::White);
-            FloatRect p1tb = p1Title.getLocalBounds();
-            p1Title.setOrigin(roundf(p1tb.width / 2), 0);
             setTextPosition(p1Title, HUD_PANEL_WIDTH / 2, 20);
             window.draw(p1Title);
 
-            Text p1Name(currentUser, font, 16);
+            Text& p1Name = texts.topCentered("multiplayer.p1Name", p1Label, 16);
             p1Name.setFillColor(Color::Cyan);
-            FloatRect p1nb = p1Name.getLocalBounds();
-            p1Name.setOrigin(roundf(p1nb.width / 2), 0);
             setTextPosition(p1Name, HUD_PANEL_WIDTH / 2, 50);
             window.draw(p1Name);
 
-            Text scoreText("Score: " + to_string(score), font, 18);
+            Text& scoreText = texts.topCentered("multiplayer.scoreText", "Score: " + to_string(player1.score), 18);
             scoreText.setFillColor(Color::White);
-            FloatRect stb = scoreText.getLocalBounds();
-            scoreText.setOrigin(roundf(stb.width / 2), 0);
             setTextPosition(scoreText, HUD_PANEL_WIDTH / 2, 80);
             window.draw(scoreText);
 
-            Text powerText("PowerUps: " + to_string(availablePowerUps), font, 18);
+            Text& powerText = texts.topCentered("multiplayer.powerText", "PowerUps: " + to_string(player1.availablePowerUps), 18);
             powerText.setFillColor(Color::White);
-            FloatRect ptb = powerText.getLocalBounds();
-            powerText.setOrigin(roundf(ptb.width / 2), 0);
             setTextPosition(powerText, HUD_PANEL_WIDTH / 2, 110);
             window.draw(powerText);
 
-            if (!running)
+            if (!player1.running)
             {
-                Text status("ELIMINATED", font, 18);
+                Text& status = texts.topCentered("multiplayer.status", "ELIMINATED", 18);
                 status.setFillColor(Color::Red);
-                FloatRect sb = status.getLocalBounds();
-                status.setOrigin(roundf(sb.width / 2), 0);
                 setTextPosition(status, HUD_PANEL_WIDTH / 2, 140);
                 window.draw(status);
             }
 
-            Text p2Title("PLAYER 2", font, 20);
+            Text& p2Title = texts.topCentered("multiplayer.p2Title", "PLAYER 2", 20);
             p2Title.setFillColor(Color::White);
-            FloatRect p2tb = p2Title.getLocalBounds();
-            p2Title.setOrigin(roundf(p2tb.width / 2), 0);
             setTextPosition(p2Title, COLS * TILE_SIZE_PIXELS + HUD_PANEL_WIDTH + HUD_PANEL_WIDTH / 2, 20);
             window.draw(p2Title);
 
-            Text p2Name(player2Username, font, 16);
+            Text& p2Name = texts.topCentered("multiplayer.p2Name", p2Label, 16);
             p2Name.setFillColor(Color::Yellow);
-            FloatRect p2nb = p2Name.getLocalBounds();
-            p2Name.setOrigin(roundf(p2nb.width / 2), 0);
             setTextPosition(p2Name, COLS * TILE_SIZE_PIXELS + HUD_PANEL_WIDTH + HUD_PANEL_WIDTH / 2, 50);
             window.draw(p2Name);
 
-            Text p2ScoreText("Score: " + to_string(player2Score), font, 18);
+            Text& p2ScoreText = texts.topCentered("multiplayer.p2ScoreText", "Score: " + to_string(player2.score), 18);
             p2ScoreText.setFillColor(Color::White);
-            FloatRect p2stb = p2ScoreText.getLocalBounds();
-            p2ScoreText.setOrigin(roundf(p2stb.width / 2), 0);
             setTextPosition(p2ScoreText, COLS * TILE_SIZE_PIXELS + HUD_PANEL_WIDTH + HUD_PANEL_WIDTH / 2, 80);
             window.draw(p2ScoreText);
 
-            Text p2PowerText("PowerUps: " + to_string(player2AvailablePowerUps), font, 18);
+            Text& p2PowerText = texts.topCentered("multiplayer.p2PowerText", "PowerUps: " + to_string(player2.availablePowerUps), 18);
             p2PowerText.setFillColor(Color::White);
-            FloatRect p2ptb = p2PowerText.getLocalBounds();
-            p2PowerText.setOrigin(roundf(p2ptb.width / 2), 0);
             setTextPosition(p2PowerText, COLS * TILE_SIZE_PIXELS + HUD_PANEL_WIDTH + HUD_PANEL_WIDTH / 2, 110);
             window.draw(p2PowerText);
 
-            if (!player2Running)
+            if (!player2.running)
             {
-                Text status("ELIMINATED", font, 18);
+                Text& status = texts.topCentered("multiplayer.status2", "ELIMINATED", 18);
                 status.setFillColor(Color::Red);
-                FloatRect sb = status.getLocalBounds();
-                status.setOrigin(roundf(sb.width / 2), 0);
                 setTextPosition(status, COLS * TILE_SIZE_PIXELS + HUD_PANEL_WIDTH + HUD_PANEL_WIDTH / 2, 140);
                 window.draw(status);
             }
 
-            if (!running && player2Running)
+            if (!player1.running && player2.running)
             {
-                Text winner(player2Username + " WINS!", font, 40);
+                Text& winner = texts.centered("multiplayer.winner", p2Label + " WINS!", 40);
                 winner.setFillColor(Color::Yellow);
-                FloatRect wb = winner.getLocalBounds();
-                winner.setOrigin(roundf(wb.width / 2), roundf(wb.height / 2));
                 setTextPosition(winner, centerX, ROWS * TILE_SIZE_PIXELS / 2);
                 window.draw(winner);
             }
-            else if (running && !player2Running)
+            else if (player1.running && !player2.running)
             {
-                Text winner(currentUser + " WINS!", font, 40);
+                Text& winner = texts.centered("multiplayer.winner2", p1Label + " WINS!", 40);
                 winner.setFillColor(Color::Yellow);
-                FloatRect wb = winner.getLocalBounds();
-                winner.setOrigin(roundf(wb.width / 2), roundf(wb.height / 2));
                 setTextPosition(winner, centerX, ROWS * TILE_SIZE_PIXELS / 2);
                 window.draw(winner);
             }
-            else if (!running && !player2Running)
+            else if (!player1.running && !player2.running)
             {
                 string winnerText;
-                if (score > player2Score)
-                    winnerText = currentUser + " WINS!";
-                else if (player2Score > score)
-                    winnerText = player2Username + " WINS!";
+                if (player1.score > player2.score)
+                    winnerText = p1Label + " WINS!";
+                else if (player2.score > player1.score)
+                    winnerText = p2Label + " WINS!";
                 else
                     winnerText = "TIE!";
 
-                Text winner(winnerText, font, 40);
+                Text& winner = texts.centered("multiplayer.winner3", winnerText, 40);
                 winner.setFillColor(Color::Yellow);
-                FloatRect wb = winner.getLocalBounds();
-                winner.setOrigin(roundf(wb.width / 2), roundf(wb.height / 2));
                 setTextPosition(winner, centerX, ROWS * TILE_SIZE_PIXELS / 2);
                 window.draw(winner);
             }
 
-            Text controls("P1: Arrow Keys - Move | Enter - Power-Up | P2: W/A/S/D - Move | Space - Power-Up | ESC - Exit", font, 14);
+            if (onlineMatch && !netSession.over(sim))
+            {
+                string netText;
+                if (matchClient.opponentLeft() || matchClient.status() == MatchClient::FAILED)
+                    netText = "OPPONENT DISCONNECTED";
+                else if (netSession.stalled())
+                    netText = "Waiting for " + matchClient.match().opponent + "...";
+                if (!netText.empty())
+                {
+                    Text& net = texts.centered("multiplayer.net", netText, 24);
+                    net.setFillColor(Color::Red);
+                    setTextPosition(net, centerX, ROWS * TILE_SIZE_PIXELS / 2 + 50);
+                    window.draw(net);
+                }
+            }
+
+            const char* controlsText = onlineMatch ? "Arrow Keys - Move | Enter - Power-Up | ESC - Leave Match"
+                                                   : "P1: Arrow Keys - Move | Enter - Power-Up | P2: W/A/S/D - Move | Space - Power-Up | ESC - Exit";
+            Text& controls = texts.topCentered(onlineMatch ? "multiplayer.onlineControls" : "multiplayer.controls", controlsText, 14);
             controls.setFillColor(Color(150, 150, 150));
-            FloatRect cb = controls.getLocalBounds();
-            controls.setOrigin(roundf(cb.width / 2), 0);
             setTextPosition(controls, centerX, ROWS * TILE_SIZE_PIXELS + 10);
             window.draw(controls);
         }
@@ -2664,66 +1794,55 @@ int main()
             bottomPanel.setFillColor(Color(30, 30, 30));
             window.draw(bottomPanel);
 
-            for (int i = 0; i < ROWS; i++)
-                for (int j = 0; j < COLS; j++)
-                {
-                    if (tileGrid[i][j] == 0)
-                        continue;
-                    sTile.setTextureRect(IntRect(tileGrid[i][j] == 1 ? 0 : 54, 0, TILE_SIZE_PIXELS, TILE_SIZE_PIXELS));
-                    sTile.setPosition(HUD_PANEL_WIDTH + j * TILE_SIZE_PIXELS, i * TILE_SIZE_PIXELS);
-                    window.draw(sTile);
-                }
-            sTile.setTextureRect(IntRect(36, 0, TILE_SIZE_PIXELS, TILE_SIZE_PIXELS));
-            sTile.setPosition(HUD_PANEL_WIDTH + playerCol * TILE_SIZE_PIXELS, playerRow * TILE_SIZE_PIXELS);
-            window.draw(sTile);
-            for (int i = 0; i < enemyCount; i++)
+            tileMap.update(sim);
+            sim.clearDirty();
+            window.draw(tileMap);
+            for (int i = 0; i < sim.enemyCount; i++)
             {
-                sEnemy.setPosition(HUD_PANEL_WIDTH + enemies[i].posX, enemies[i].posY);
-                if (running)
-                    sEnemy.rotate(4);
+                sEnemy.setPosition(HUD_PANEL_WIDTH + sim.enemies[i].drawX(tickAlpha), sim.enemies[i].drawY(tickAlpha));
+                if (player1.running)
+                    sEnemy.rotate(ENEMY_SPIN_DEGREES_PER_SECOND * frameSeconds);
                 window.draw(sEnemy);
             }
 
-            Text title("PLAYER INFO", font, 20);
+            Text& title = texts.topCentered("playing.title", "PLAYER INFO", 20);
             title.setFillColor(Color::White);
-            FloatRect tb = title.getLocalBounds();
-            title.setOrigin(roundf(tb.width / 2), 0);
             setTextPosition(title, HUD_PANEL_WIDTH / 2, 20);
             window.draw(title);
 
-            Text name(currentUser, font, 16);
+            Text& name = texts.topCentered("playing.name", currentUser, 16);
             name.setFillColor(Color::Cyan);
-            FloatRect nb = name.getLocalBounds();
-            name.setOrigin(roundf(nb.width / 2), 0);
             setTextPosition(name, HUD_PANEL_WIDTH / 2, 50);
             window.draw(name);
 
-            Text scoreText("Score: " + to_string(score), font, 18);
+            Text& scoreText = texts.topCentered("playing.scoreText", "Score: " + to_string(player1.score), 18);
             scoreText.setFillColor(Color::White);
-            FloatRect stb = scoreText.getLocalBounds();
-            scoreText.setOrigin(roundf(stb.width / 2), 0);
             setTextPosition(scoreText, HUD_PANEL_WIDTH / 2, 80);
             window.draw(scoreText);
 
-            Text powerText("PowerUps: " + to_string(availablePowerUps), font, 18);
+            Text& powerText = texts.topCentered("playing.powerText", "PowerUps: " + to_string(player1.availablePowerUps), 18);
             powerText.setFillColor(Color::White);
-            FloatRect ptb = powerText.getLocalBounds();
-            powerText.setOrigin(roundf(ptb.width / 2), 0);
             setTextPosition(powerText, HUD_PANEL_WIDTH / 2, 110);
             window.draw(powerText);
 
-            Text controls("Controls: Arrow Keys - Move | Enter - Power-Up | ESC - Exit", font, 14);
+            Text& controls = texts.topCentered("playing.controls", "Controls: Arrow Keys - Move | Enter - Power-Up | ESC - Exit", 14);
             controls.setFillColor(Color(150, 150, 150));
-            FloatRect cb = controls.getLocalBounds();
-            controls.setOrigin(roundf(cb.width / 2), 0);
             setTextPosition(controls, centerX, ROWS * TILE_SIZE_PIXELS + 10);
             window.draw(controls);
 
-            if (!running)
+            if (!player1.running)
                 window.draw(sGameover);
         }
 
+        if (profiler.showOverlay)
+            drawProfilerOverlay(window, texts, profiler, Vector2f(window.getSize().x - PROFILER_OVERLAY_WIDTH - 10, 10));
+        profiler.end(PHASE_DRAW);
+
         window.display();
+        profiler.endFrame();
     }
+
+    // The window is closed: everything queued must be on disk before exit
+    persistence.flush();
     return 0;
 }
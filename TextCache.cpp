@@ -0,0 +1,35 @@
+#include "TextCache.h"
+#include <cmath>
+
+using namespace std;
+using namespace sf;
+
+Text& TextCache::get(const char* slot, int index, string_view str, unsigned size, Origin origin)
+{
+    auto found = labels.find({ slot, index });
+    if (found == labels.end())
+    {
+        found = labels.emplace(Key{ slot, index }, Label()).first;
+        found->second.text.setFont(*font);
+        found->second.size = 0;     // forces the first layout below
+    }
+
+    Label& label = found->second;
+    if (label.size == size && label.origin == origin && label.str == str)
+        return label.text;
+
+    label.str.assign(str.data(), str.size());
+    label.size = size;
+    label.origin = origin;
+    label.text.setString(label.str);
+    label.text.setCharacterSize(size);
+
+    FloatRect bounds = label.text.getLocalBounds();
+    if (origin == CENTER)
+        label.text.setOrigin(roundf(bounds.width / 2), roundf(bounds.height / 2));
+    else if (origin == TOP_CENTER)
+        label.text.setOrigin(roundf(bounds.width / 2), 0);
+    else
+        label.text.setOrigin(0, 0);
+    return label.text;
+}
@@ -0,0 +1,60 @@
+// --- RETAINED TEXT LABELS: sf::Text OBJECTS THAT LIVE ACROSS FRAMES ---
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <SFML/Graphics.hpp>
+
+// Every label the draw code shows is kept between frames, keyed by a slot name
+// (a string literal naming the call site, e.g. "menu.title") and, for rows of
+// a list, an index. The string, size and origin are only pushed into the
+// sf::Text when they differ from last frame, so glyph geometry and bounds are
+// rebuilt when a label changes rather than every frame.
+class TextCache
+{
+public:
+    enum Origin
+    {
+        TOP_LEFT,
+        TOP_CENTER,     // horizontally centred, top aligned
+        CENTER
+    };
+
+    void setFont(const sf::Font& labelFont) { font = &labelFont; }
+
+    sf::Text& get(const char* slot, std::string_view str, unsigned size, Origin origin = TOP_LEFT)
+    {
+        return get(slot, 0, str, size, origin);
+    }
+    sf::Text& get(const char* slot, int index, std::string_view str, unsigned size, Origin origin = TOP_LEFT);
+
+    sf::Text& centered(const char* slot, std::string_view str, unsigned size) { return get(slot, 0, str, size, CENTER); }
+    sf::Text& topCentered(const char* slot, std::string_view str, unsigned size) { return get(slot, 0, str, size, TOP_CENTER); }
+
+    // Drops every label, e.g. after the font changed
+    void clear() { labels.clear(); }
+
+private:
+    struct Key
+    {
+        const char* slot;
+        int index;
+        bool operator==(const Key& other) const { return slot == other.slot && index == other.index; }
+    };
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const { return std::hash<const void*>()(key.slot) ^ (size_t)key.index * 0x9E3779B9u; }
+    };
+    struct Label
+    {
+        sf::Text text;
+        std::string str;
+        unsigned size = 0;
+        Origin origin = TOP_LEFT;
+    };
+
+    const sf::Font* font = nullptr;
+    std::unordered_map<Key, Label, KeyHash> labels;     // node based: references stay valid
+};
@@ -0,0 +1,97 @@
+#include "TileMapRenderer.h"
+
+using namespace std;
+using namespace sf;
+
+// -------------------------------------------------------------
+// TILES.PNG LAYOUT: 18px SQUARES SIDE BY SIDE
+// -------------------------------------------------------------
+const int TEXTURE_BLUE = 0;
+const int TEXTURE_PLAYER2 = 18;
+const int TEXTURE_PLAYER1 = 36;
+const int TEXTURE_TRAIL_P1 = 54;
+const int TEXTURE_TRAIL_P2 = 72;
+
+static int textureFor(int tile)
+{
+    if (tile == TILE_TRAIL_P1)
+        return TEXTURE_TRAIL_P1;
+    if (tile == TILE_TRAIL_P2)
+        return TEXTURE_TRAIL_P2;
+    return TEXTURE_BLUE;
+}
+
+void TileMapRenderer::init(const Texture& tileTexture, int boardRows, int boardCols)
+{
+    texture = &tileTexture;
+    rows = boardRows;
+    cols = boardCols;
+    vertices.setPrimitiveType(Quads);
+    vertices.resize((size_t)(rows * cols + MAX_PLAYERS) * 4);
+
+    // Every cell is written on the first update
+    shown.assign(rows * cols, -1);
+    rebuildAll = true;
+    for (int p = 0; p < MAX_PLAYERS; p++)
+        setQuad(rows * cols + p, 0, 0, TEXTURE_BLUE, false);
+}
+
+// Empty cells and absent players keep their quad but draw it fully transparent
+void TileMapRenderer::setQuad(int quad, int row, int col, int textureX, bool visible)
+{
+    Vertex* v = &vertices[(size_t)quad * 4];
+    float x = (float)(col * TILE_SIZE_PIXELS), y = (float)(row * TILE_SIZE_PIXELS);
+    float size = (float)TILE_SIZE_PIXELS;
+    v[0].position = Vector2f(x, y);
+    v[1].position = Vector2f(x + size, y);
+    v[2].position = Vector2f(x + size, y + size);
+    v[3].position = Vector2f(x, y + size);
+    v[0].texCoords = Vector2f((float)textureX, 0);
+    v[1].texCoords = Vector2f((float)textureX + size, 0);
+    v[2].texCoords = Vector2f((float)textureX + size, size);
+    v[3].texCoords = Vector2f((float)textureX, size);
+    Color color = visible ? Color::White : Color::Transparent;
+    for (int k = 0; k < 4; k++)
+        v[k].color = color;
+}
+
+void TileMapRenderer::updateCell(const GameSimulation& sim, int cell)
+{
+    int row = cell / cols, col = cell % cols;
+    int tile = sim.tileAt(row, col);
+    if (tile == shown[cell])
+        return;
+    shown[cell] = tile;
+    setQuad(cell, row, col, textureFor(tile), tile != TILE_EMPTY);
+}
+
+void TileMapRenderer::update(const GameSimulation& sim)
+{
+    if (sim.rows() != rows || sim.cols() != cols)
+        init(*texture, sim.rows(), sim.cols());
+
+    if (rebuildAll)
+    {
+        for (int cell = 0; cell < rows * cols; cell++)
+            updateCell(sim, cell);
+        rebuildAll = false;
+    }
+    else
+    {
+        changed.clear();
+        sim.getBoard().collectDirty(changed);
+        for (int cell : changed)
+            updateCell(sim, cell);
+    }
+
+    const int markers[MAX_PLAYERS] = { TEXTURE_PLAYER1, TEXTURE_PLAYER2 };
+    for (int p = 0; p < MAX_PLAYERS; p++)
+        setQuad(rows * cols + p, sim.players[p].row, sim.players[p].col, markers[p], p < sim.playerCount);
+}
+
+void TileMapRenderer::draw(RenderTarget& target, RenderStates states) const
+{
+    states.transform *= getTransform();
+    states.texture = texture;
+    target.draw(vertices, states);
+}
@@ -0,0 +1,32 @@
+// --- BATCHED BOARD RENDERING: EVERY TILE AND PLAYER MARKER IN ONE VERTEX ARRAY ---
+#pragma once
+
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include "GameSimulation.h"
+
+// Draws the board as one quad per cell against tiles.png, followed by one quad
+// per player marker, so the whole board costs a single draw call. update()
+// only rewrites the quads of the cells the board reports as dirty.
+// Position the map with setPosition() (e.g. past the left HUD panel).
+class TileMapRenderer : public sf::Drawable, public sf::Transformable
+{
+public:
+    void init(const sf::Texture& tileTexture, int rows, int cols);
+
+    // Brings the quads in line with the simulation's board and players.
+    // Does not clear the board's dirty set; the caller does that.
+    void update(const GameSimulation& sim);
+
+private:
+    const sf::Texture* texture = nullptr;
+    sf::VertexArray vertices;
+    std::vector<int> shown;     // tile value each cell's quad currently shows
+    std::vector<int> changed;   // dirty cells of the current update
+    bool rebuildAll = true;
+    int rows = 0, cols = 0;
+
+    void setQuad(int quad, int row, int col, int textureX, bool visible);
+    void updateCell(const GameSimulation& sim, int cell);
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+};
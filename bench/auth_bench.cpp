@@ -0,0 +1,139 @@
+// --- ACCOUNT BENCHMARK: LINEAR SCAN VS HASH INDEX, CSV PARSING VS MAPPED STORE AT STARTUP ---
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "AuthManager.h"
+
+using namespace std;
+
+const int LOOKUPS = 200000;
+
+// The original lookup: lower-case and compare every stored name in turn
+static string toLower(const string& s)
+{
+    string result = s;
+    for (char& c : result)
+        if (c >= 'A' && c <= 'Z')
+            c = c - 'A' + 'a';
+    return result;
+}
+
+static int linearFind(const vector<Player>& players, const string& username)
+{
+    string uLower = toLower(username);
+    for (size_t i = 0; i < players.size(); i++)
+        if (toLower(players[i].username) == uLower)
+            return (int)i;
+    return -1;
+}
+
+static string nameFor(int i)
+{
+    return "Player" + to_string(i);
+}
+
+static double msSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Startup with `count` accounts: parsing players.txt against opening players.dat
+static void startupBenchmark(int count)
+{
+    const string csvFile = "auth_bench_players.txt";
+    const string storeFile = "auth_bench_players.dat";
+    string msg;
+    {
+        AuthManager source("");
+        source.reserve(count);
+        for (int i = 0; i < count; i++)
+            source.registerPlayer(nameFor(i), "password", msg);
+        source.exportCsv(csvFile);
+    }
+    remove(storeFile.c_str());
+    {
+        AuthManager importer(storeFile, csvFile);   // imports and writes the store
+    }
+
+    auto start = chrono::steady_clock::now();
+    {
+        AuthManager parsed("");
+        parsed.importCsv(csvFile);
+    }
+    double csvMs = msSince(start);
+
+    start = chrono::steady_clock::now();
+    int score;
+    {
+        AuthManager mapped(storeFile, "");
+        score = mapped.getPlayerScore(nameFor(count / 2));
+    }
+    double storeMs = msSince(start);
+
+    cout << endl << "startup with " << count << " players: CSV parse " << fixed << setprecision(1) << csvMs
+         << " ms, mapped store " << setprecision(3) << storeMs << " ms (first lookup included)" << endl;
+    if (score != 0)
+        cout << "unexpected score" << endl;
+    remove(csvFile.c_str());
+    remove(storeFile.c_str());
+    remove((storeFile + ".journal").c_str());
+}
+
+int main(int argc, char** argv)
+{
+    int maxPlayers = argc > 1 ? atoi(argv[1]) : 1000000;
+    string msg;
+
+    cout << setw(10) << "players" << setw(16) << "register ms" << setw(16) << "indexed ns/op"
+         << setw(16) << "linear ns/op" << endl;
+    for (int count = 100; count <= maxPlayers; count *= 10)
+    {
+        AuthManager auth("");   // in memory only
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < count; i++)
+            auth.registerPlayer(nameFor(i), "password", msg);
+        double registerMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        srand(count);
+        vector<string> queries(LOOKUPS);
+        for (string& q : queries)
+            q = toLower(nameFor(rand() % count));
+
+        long long found = 0;
+        start = chrono::steady_clock::now();
+        for (const string& q : queries)
+        {
+            found += auth.loginPlayer(q, "password", msg);
+            auth.updatePlayerScore(q, (int)found);
+        }
+        double indexedNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / LOOKUPS;
+
+        cout << setw(10) << count << setw(16) << fixed << setprecision(1) << registerMs
+             << setw(16) << indexedNs;
+
+        // The scan is quadratic in spirit; only time it while it finishes quickly
+        if (count <= 10000)
+        {
+            vector<Player> players(count);
+            for (int i = 0; i < count; i++)
+                auth.findPlayer(nameFor(i), players[i]);
+            int linearLookups = LOOKUPS / max(1, count / 100);
+            start = chrono::steady_clock::now();
+            for (int i = 0; i < linearLookups; i++)
+                found += linearFind(players, queries[i]) >= 0;
+            cout << setw(16) << chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / linearLookups;
+        }
+        else
+            cout << setw(16) << "-";
+        cout << endl;
+        if (found == 0)
+            cout << "no lookups succeeded" << endl;
+    }
+
+    startupBenchmark(maxPlayers);
+    return 0;
+}
@@ -0,0 +1,110 @@
+// --- BOARD SIZE SCALING: TICK AND CAPTURE COST FROM THE CLASSIC ARENA TO STRESS BOARDS ---
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include "GameSimulation.h"
+
+using namespace std;
+
+const int CAPTURES_PER_RUN = 20;
+const long long MAX_TICKS_PER_RUN = 4000000;
+
+// Scripted bot: walks down, right and back up to the top border, closing a
+// square box every lap, then slides along the border to the next one. The box
+// size does not grow with the board, so the area that changes per capture
+// stays the same and only the board-size dependent cost varies.
+const int BOX_SIDE = 16;
+
+struct BoxBot
+{
+    int side, phase = 0, stepsInPhase = 0, lastRow = 0, lastCol = 0;
+    int across = 1;     // +1 while working rightwards, -1 leftwards
+
+    void drive(GameSimulation& sim)
+    {
+        const SimPlayer& pl = sim.players[0];
+        if (pl.row != lastRow || pl.col != lastCol)
+            stepsInPhase++;
+        lastRow = pl.row;
+        lastCol = pl.col;
+
+        bool phaseDone;
+        if (phase == 2)
+            phaseDone = stepsInPhase > 0 && !pl.isConstructing();   // back on blue
+        else
+            phaseDone = stepsInPhase >= (phase == 3 ? 2 : side);
+        if (phaseDone)
+        {
+            phase = (phase + 1) % 4;
+            stepsInPhase = 0;
+            int nextBox = pl.col + across * (side + 2);
+            if (phase == 3 && (nextBox < 1 || nextBox > sim.cols() - 2))
+                across = -across;
+        }
+
+        // Down, across, up, then slide along the border
+        static const int rowDirs[4] = { 1, 0, -1, 0 };
+        sim.setDirection(0, rowDirs[phase], phase % 2 ? across : 0);
+    }
+};
+
+struct Result
+{
+    long long ticks = 0;
+    int captures = 0;
+    double tickSeconds = 0, captureSeconds = 0;
+};
+
+Result run(int rows, int cols, CaptureMode mode)
+{
+    GameSimulation sim(rows, cols, 2024);
+    sim.setCaptureMode(mode);
+    Result r;
+    while (r.captures < CAPTURES_PER_RUN && r.ticks < MAX_TICKS_PER_RUN)
+    {
+        sim.reset(1, 4);
+        BoxBot bot;
+        bot.side = max(2, min(BOX_SIDE, min(rows, cols) / 4));
+        while (!sim.isOver() && r.captures < CAPTURES_PER_RUN && r.ticks < MAX_TICKS_PER_RUN)
+        {
+            bot.drive(sim);
+            int before = sim.players[0].score;
+            auto start = chrono::steady_clock::now();
+            sim.tick();
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            r.ticks++;
+            if (sim.players[0].score != before)
+            {
+                r.captures++;
+                r.captureSeconds += seconds;
+            }
+            else
+                r.tickSeconds += seconds;
+        }
+    }
+    return r;
+}
+
+int main()
+{
+    const int sizes[][2] = { { 25, 40 }, { 100, 160 }, { 500, 500 }, { 1000, 1000 }, { 2000, 2000 } };
+
+    cout << left << setw(12) << "size" << setw(13) << "capture" << setw(10) << "captures"
+         << setw(16) << "us/plain tick" << "us/capture" << endl;
+    for (const auto& s : sizes)
+    {
+        for (CaptureMode mode : { CAPTURE_FULL_SCAN, CAPTURE_INCREMENTAL })
+        {
+            Result r = run(s[0], s[1], mode);
+            long long plainTicks = max(1LL, r.ticks - r.captures);
+            cout << left << setw(12) << (to_string(s[0]) + "x" + to_string(s[1]))
+                 << setw(13) << (mode == CAPTURE_FULL_SCAN ? "full scan" : "incremental")
+                 << setw(10) << r.captures << fixed << setprecision(3)
+                 << setw(16) << r.tickSeconds * 1e6 / plainTicks
+                 << (r.captures ? r.captureSeconds * 1e6 / r.captures : 0.0) << endl;
+        }
+    }
+    return 0;
+}
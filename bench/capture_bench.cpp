@@ -0,0 +1,239 @@
+// --- CAPTURE KERNEL MICRO-BENCHMARK: THREE INT-GRID PASSES VS FUSED BIT-PLANE KERNELS ---
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "Board.h"
+#include "CaptureKernel.h"
+
+using namespace std;
+
+// One board in both layouts: the original int grid (-1 marked, 0 empty,
+// 1 blue, 2/3 trails) and the bit planes the kernels work on
+struct Scenario
+{
+    int rows, cols, wordsPerRow;
+    vector<int> grid;
+    vector<uint64_t> blue, own, other, reach;
+};
+
+Scenario makeScenario(int rows, int cols)
+{
+    Scenario s;
+    s.rows = rows;
+    s.cols = cols;
+    s.wordsPerRow = (cols + 63) / 64;
+    s.grid.assign(rows * cols, 0);
+    size_t words = (size_t)rows * s.wordsPerRow;
+    s.blue.assign(words, 0);
+    s.own.assign(words, 0);
+    s.other.assign(words, 0);
+    s.reach.assign(words, 0);
+
+    srand(rows * 7919 + cols);
+    for (int i = 0; i < rows; i++)
+    {
+        for (int j = 0; j < cols; j++)
+        {
+            int tile;
+            int roll = rand() % 100;
+            if (i == 0 || j == 0 || i == rows - 1 || j == cols - 1 || roll < 30)
+                tile = 1;
+            else if (roll < 35)
+                tile = 2;
+            else if (roll < 37)
+                tile = 3;
+            else if (roll < 80)
+                tile = -1;
+            else
+                tile = 0;
+            s.grid[i * cols + j] = tile;
+
+            size_t w = (size_t)i * s.wordsPerRow + j / 64;
+            uint64_t bit = uint64_t(1) << (j % 64);
+            if (tile == 1)
+                s.blue[w] |= bit;
+            else if (tile == 2)
+                s.own[w] |= bit;
+            else if (tile == 3)
+                s.other[w] |= bit;
+            else if (tile == -1)
+                s.reach[w] |= bit;
+        }
+        for (int j = cols; j < s.wordsPerRow * 64; j++)
+            s.blue[(size_t)i * s.wordsPerRow + j / 64] |= uint64_t(1) << (j % 64);
+    }
+    return s;
+}
+
+// The capture as the game originally did it: count, count, convert
+int threePass(int* grid, int rows, int cols, int trail, int& emptyLeft)
+{
+    int captured = 0;
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+        {
+            int t = grid[i * cols + j];
+            if (t == trail)
+                captured++;
+            else if (t == 0 && i > 0 && i < rows - 1 && j > 0 && j < cols - 1)
+                captured++;
+        }
+    for (int i = 0; i < rows * cols; i++)
+    {
+        if (grid[i] == -1)
+            grid[i] = 0;
+        else if (grid[i] == trail || grid[i] == 0)
+            grid[i] = 1;
+    }
+    emptyLeft = 0;
+    for (int i = 0; i < rows * cols; i++)
+        if (grid[i] == 0)
+            emptyLeft++;
+    return captured;
+}
+
+template <typename Reset, typename Run>
+double timePerCapture(int iterations, Reset reset, Run run)
+{
+    auto start = chrono::steady_clock::now();
+    for (int it = 0; it < iterations; it++)
+    {
+        reset();
+        run();
+    }
+    return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / iterations;
+}
+
+void run(int rows, int cols)
+{
+    const Scenario s = makeScenario(rows, cols);
+    int iterations = max(20, 50000000 / (rows * cols));
+    string size = to_string(rows) + "x" + to_string(cols);
+
+    vector<int> grid;
+    int expectCaptured = 0, expectLeft = 0;
+    double gridCopy = timePerCapture(iterations, [&] { grid = s.grid; }, [] {});
+    double gridUs = timePerCapture(iterations, [&] { grid = s.grid; }, [&] {
+        expectCaptured = threePass(grid.data(), rows, cols, 2, expectLeft);
+    }) - gridCopy;
+    cout << left << setw(12) << size << setw(12) << "int x3" << fixed << setprecision(3)
+         << setw(14) << gridUs << "captured " << expectCaptured << endl;
+
+    const pair<const char*, CaptureKernelFn> kernels[] = {
+        { "scalar", captureKernelScalar }, { "sse2", captureKernelSSE2() }, { "avx2", captureKernelAVX2() }
+    };
+    vector<uint64_t> blue, own, reach, dirty;
+    auto reset = [&] { blue = s.blue; own = s.own; reach = s.reach; dirty.assign(blue.size(), 0); };
+    double planeCopy = timePerCapture(iterations, reset, [] {});
+    for (const auto& k : kernels)
+    {
+        cout << left << setw(12) << size << setw(12) << k.first;
+        if (!k.second)
+        {
+            cout << "unsupported" << endl;
+            continue;
+        }
+        int captured = 0, emptyLeft = 0;
+        double us = timePerCapture(iterations, reset, [&] {
+            captured = k.second(blue.data(), own.data(), s.other.data(), reach.data(), dirty.data(), blue.size(), emptyLeft);
+        }) - planeCopy;
+        cout << setw(14) << us << setprecision(1) << gridUs / us << "x";
+        if (captured != expectCaptured || emptyLeft != expectLeft)
+            cout << "  MISMATCH (" << captured << ", " << emptyLeft << ")";
+        cout << setprecision(3) << endl;
+    }
+}
+
+// The same capture in the Board's layout, rows padded to a cache line:
+// one kernel call per row (n = the words holding columns, 1 on 25x40, so
+// the vector loops never start) against one call over the whole plane
+void runPadded(int rows, int cols)
+{
+    const Scenario s = makeScenario(rows, cols);
+    int iterations = max(20, 50000000 / (rows * cols));
+    string size = to_string(rows) + "x" + to_string(cols);
+    int stride = (s.wordsPerRow + Board::WORDS_PER_LINE - 1) / Board::WORDS_PER_LINE * Board::WORDS_PER_LINE;
+    size_t words = (size_t)rows * stride;
+
+    auto pad = [&](const vector<uint64_t>& packed, uint64_t padding) {
+        vector<uint64_t> out(words, padding);
+        for (int i = 0; i < rows; i++)
+            for (int w = 0; w < s.wordsPerRow; w++)
+                out[(size_t)i * stride + w] = packed[(size_t)i * s.wordsPerRow + w];
+        return out;
+    };
+    const vector<uint64_t> paddedBlue = pad(s.blue, ~uint64_t(0)), paddedOwn = pad(s.own, 0);
+    const vector<uint64_t> paddedOther = pad(s.other, 0), paddedReach = pad(s.reach, 0);
+
+    vector<uint64_t> blue, own, reach, dirty;
+    auto reset = [&] { blue = paddedBlue; own = paddedOwn; reach = paddedReach; dirty.assign(words, 0); };
+    double planeCopy = timePerCapture(iterations, reset, [] {});
+    const pair<const char*, CaptureKernelFn> kernels[] = {
+        { "scalar", captureKernelScalar }, { "sse2", captureKernelSSE2() }, { "avx2", captureKernelAVX2() }
+    };
+    for (const auto& k : kernels)
+    {
+        if (!k.second)
+            continue;
+        int captured = 0, emptyLeft = 0;
+        double perRow = timePerCapture(iterations, reset, [&] {
+            captured = emptyLeft = 0;
+            for (int i = 0; i < rows; i++)
+            {
+                size_t at = (size_t)i * stride;
+                int rowLeft = 0;
+                captured += k.second(blue.data() + at, own.data() + at, paddedOther.data() + at, reach.data() + at,
+                                     dirty.data() + at, s.wordsPerRow, rowLeft);
+                emptyLeft += rowLeft;
+            }
+        }) - planeCopy;
+        int planeCaptured = 0, planeLeft = 0;
+        double plane = timePerCapture(iterations, reset, [&] {
+            planeCaptured = k.second(blue.data(), own.data(), paddedOther.data(), reach.data(), dirty.data(), words,
+                                     planeLeft);
+        }) - planeCopy;
+        cout << left << setw(12) << size << setw(12) << k.first << setw(14) << perRow << setw(14) << plane;
+        if (captured != planeCaptured || emptyLeft != planeLeft)
+            cout << "MISMATCH (" << captured << " vs " << planeCaptured << ")";
+        cout << endl;
+    }
+
+    // And through the Board itself, trail 1 around a region the enemy can't reach
+    Board start(rows, cols);
+    start.clear();
+    for (int i = 1; i < rows - 1; i++)
+        for (int j = 1; j < cols - 1; j++)
+        {
+            int roll = (i * 31 + j * 17) % 100;
+            if (roll < 30)
+                start.set(i, j, TILE_BLUE);
+            else if (roll < 35)
+                start.set(i, j, TILE_TRAIL_P1);
+        }
+    start.clearDirty();
+    Board board = start;
+    int captured = 0, emptyLeft = 0;
+    double us = timePerCapture(iterations, [&] { board = start; board.markReachable(rows / 2, cols / 2); }, [&] {
+        captured = board.captureEnclosed(TILE_TRAIL_P1, emptyLeft);
+    });
+    double reachOnly = timePerCapture(iterations, [&] { board = start; board.markReachable(rows / 2, cols / 2); }, [] {});
+    cout << left << setw(12) << size << setw(12) << "Board" << setw(14) << "" << setw(14) << us - reachOnly
+         << "captured " << captured << endl;
+}
+
+int main()
+{
+    cout << "dispatch: " << captureKernelName() << endl;
+    cout << left << setw(12) << "size" << setw(12) << "kernel" << setw(14) << "us/capture" << "speedup" << endl;
+    run(25, 40);
+    run(1000, 1000);
+    cout << endl << left << setw(12) << "padded" << setw(12) << "kernel" << setw(14) << "us per row" << "us per plane"
+         << endl;
+    runPadded(25, 40);
+    runPadded(1000, 1000);
+    return 0;
+}
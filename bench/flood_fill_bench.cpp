@@ -0,0 +1,108 @@
+// --- FLOOD FILL MICRO-BENCHMARK: RECURSIVE floodFillMark VS SCANLINE ---
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "FloodFill.h"
+
+using namespace std;
+
+// Largest board the recursive fill is run on; beyond this it needs more
+// stack frames than a default 8 MB thread stack can hold
+const int RECURSIVE_CELL_LIMIT = 64 * 1024;
+
+// The original recursive floodFillMark, parameterised on the board size
+void recursiveFill(int* cells, int rows, int cols, int row, int col)
+{
+    if (row < 0 || row >= rows || col < 0 || col >= cols)
+        return;
+    if (cells[row * cols + col] == 0)
+    {
+        cells[row * cols + col] = -1;
+        if (row > 0 && cells[(row - 1) * cols + col] == 0)
+            recursiveFill(cells, rows, cols, row - 1, col);
+        if (row < rows - 1 && cells[(row + 1) * cols + col] == 0)
+            recursiveFill(cells, rows, cols, row + 1, col);
+        if (col > 0 && cells[row * cols + col - 1] == 0)
+            recursiveFill(cells, rows, cols, row, col - 1);
+        if (col < cols - 1 && cells[row * cols + col + 1] == 0)
+            recursiveFill(cells, rows, cols, row, col + 1);
+    }
+}
+
+// Blue border with an empty interior (the start of a match)
+vector<int> openBoard(int rows, int cols)
+{
+    vector<int> cells(rows * cols, 0);
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            if (i == 0 || j == 0 || i == rows - 1 || j == cols - 1)
+                cells[i * cols + j] = 1;
+    return cells;
+}
+
+// Vertical walls every other column with alternating gaps: one long
+// serpentine corridor, the worst case for both span count and recursion depth
+vector<int> serpentineBoard(int rows, int cols)
+{
+    vector<int> cells = openBoard(rows, cols);
+    for (int j = 2; j < cols - 2; j += 2)
+        for (int i = 1; i < rows - 1; i++)
+            if (i != ((j / 2) % 2 == 0 ? rows - 2 : 1))
+                cells[i * cols + j] = 1;
+    return cells;
+}
+
+template <typename F>
+double timePerFill(const vector<int>& board, vector<int>& work, int iterations, F fill)
+{
+    auto start = chrono::steady_clock::now();
+    for (int it = 0; it < iterations; it++)
+    {
+        work = board;
+        fill(work.data());
+    }
+    return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / iterations;
+}
+
+void run(const string& name, const vector<int>& board, int rows, int cols)
+{
+    int cells = rows * cols;
+    int iterations = max(3, 20000000 / cells);
+    vector<int> work;
+    ScanlineFill filler;
+    filler.reserve(rows, cols);
+
+    double copyUs = timePerFill(board, work, iterations, [](int*) {});
+    double scanUs = timePerFill(board, work, iterations, [&](int* c) {
+        filler.fill(c, rows, cols, rows / 2, 1, 0, -1);
+    }) - copyUs;
+
+    cout << left << setw(12) << name << setw(12) << (to_string(rows) + "x" + to_string(cols));
+    cout << fixed << setprecision(2) << setw(16) << scanUs;
+    if (cells <= RECURSIVE_CELL_LIMIT)
+    {
+        double recUs = timePerFill(board, work, iterations, [&](int* c) {
+            recursiveFill(c, rows, cols, rows / 2, 1);
+        }) - copyUs;
+        cout << setw(16) << recUs << setprecision(1) << recUs / scanUs << "x";
+    }
+    else
+        cout << setw(16) << "skipped" << "(stack)";
+    cout << endl;
+}
+
+int main()
+{
+    const int sizes[][2] = { { 25, 40 }, { 100, 160 }, { 250, 250 }, { 1000, 1000 }, { 3000, 3000 } };
+
+    cout << left << setw(12) << "board" << setw(12) << "size" << setw(16) << "scanline (us)"
+         << setw(16) << "recursive (us)" << "speedup" << endl;
+    for (const auto& s : sizes)
+    {
+        run("open", openBoard(s[0], s[1]), s[0], s[1]);
+        run("serpentine", serpentineBoard(s[0], s[1]), s[0], s[1]);
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+// --- FRAME RATE INDEPENDENCE: THE SAME MATCH DRAWN AT 30, 60, 144, 240 AND 1000 FPS ---
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include "GameSimulation.h"
+#include "FixedTimestep.h"
+
+using namespace std;
+
+const int SIM_SECONDS = 60;
+const uint64_t BENCH_SEED = 2024;
+
+// A reference run ticks the simulation directly and keeps the checksum after
+// every tick. Each frame rate then feeds FixedTimestep with frames of that
+// length (or jittery ones) and every frame it would draw must show a state
+// the reference had at the same tick; the enemies, which used to move once
+// per drawn frame, are what this exercises.
+int main()
+{
+    const int totalTicks = SIM_SECONDS * SIM_TICKS_PER_SECOND;
+    GameSimulation reference(DEFAULT_ROWS, DEFAULT_COLS, BENCH_SEED);
+    vector<uint32_t> checksums(1, reference.checksum());
+    auto start = chrono::steady_clock::now();
+    for (int t = 0; t < totalTicks; t++)
+    {
+        reference.tick();
+        checksums.push_back(reference.checksum());
+    }
+    double headless = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "headless: " << totalTicks << " ticks in " << fixed << setprecision(2) << headless * 1000
+         << " ms, " << setprecision(0) << totalTicks / headless << " ticks/s (checksum every tick)" << endl;
+
+    const double rates[] = { 30, 60, 144, 240, 1000, 0 };      // 0: 2-50 ms frames at random
+    cout << left << setw(10) << "fps" << setw(9) << "frames" << setw(8) << "ticks" << setw(12) << "ticks/sec"
+         << setw(17) << "max ticks/frame" << "mismatched frames" << endl;
+    int failures = 0;
+    for (double fps : rates)
+    {
+        GameSimulation sim(DEFAULT_ROWS, DEFAULT_COLS, BENCH_SEED);
+        FixedTimestep timestep;
+        mt19937 rng(7);
+        uniform_real_distribution<float> jitter(0.002f, 0.050f);
+        int ticks = 0, frames = 0, mostTicks = 0, mismatched = 0;
+        float seconds = 0;
+        while (ticks < totalTicks)
+        {
+            float dt = fps > 0 ? (float)(1 / fps) : jitter(rng);
+            int ran = timestep.run(sim, dt);
+            ticks += ran;
+            seconds += dt;
+            frames++;
+            mostTicks = max(mostTicks, ran);
+            if (ticks <= totalTicks && sim.checksum() != checksums[ticks])
+                mismatched++;
+        }
+        failures += mismatched;
+        cout << left << setw(10) << (fps > 0 ? to_string((int)fps) : string("jitter")) << setw(9) << frames
+             << setw(8) << ticks << setprecision(2) << setw(12) << ticks / seconds << setw(17) << mostTicks
+             << mismatched << endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+// --- LEADERBOARD BENCHMARK: TOP-K INSERTS, THE PER-FRAME SORTED VIEW AND RANK QUERIES ---
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Leaderboard.h"
+#include "RankIndex.h"
+
+using namespace std;
+
+const int INSERTS = 1000000;
+const int FRAMES = 1000;
+const int RANKED_PLAYERS = 1000000;
+const int QUERIES = 200000;
+
+static double nsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+// What the leaderboard screen used to do every frame: copy the heap to a
+// new[] array and bubble sort it
+static long long bubbleSortFrame(const vector<LeaderboardEntry>& heap)
+{
+    int size = (int)heap.size();
+    LeaderboardEntry* sorted = new LeaderboardEntry[size];
+    for (int i = 0; i < size; i++)
+        sorted[i] = heap[i];
+    for (int i = 0; i < size - 1; i++)
+        for (int j = 0; j < size - i - 1; j++)
+            if (sorted[j].score < sorted[j + 1].score)
+                swap(sorted[j], sorted[j + 1]);
+    long long top = size > 0 ? sorted[0].score : 0;
+    delete[] sorted;
+    return top;
+}
+
+int main()
+{
+    srand(2024);
+    vector<LeaderboardEntry> entries(INSERTS);
+    for (int i = 0; i < INSERTS; i++)
+        entries[i] = { "Player" + to_string(rand() % 100000), rand() % 5000, 1 + rand() % 3 };
+
+    cout << setw(8) << "K" << setw(14) << "insert ns" << setw(18) << "cached view ns"
+         << setw(18) << "view after add us" << setw(18) << "old frame us" << endl;
+    for (int k : { 10, 1000, 10000 })
+    {
+        TopKLeaderboard board(k);
+        auto start = chrono::steady_clock::now();
+        for (const LeaderboardEntry& entry : entries)
+            board.insert(entry);
+        double insertNs = nsSince(start) / INSERTS;
+
+        long long checksum = board.sorted().front().score;     // sorts once
+        start = chrono::steady_clock::now();
+        for (int f = 0; f < FRAMES; f++)
+            checksum += board.sorted().front().score;
+        double cachedNs = nsSince(start) / FRAMES;
+
+        start = chrono::steady_clock::now();
+        for (int f = 0; f < FRAMES / 10; f++)
+        {
+            board.insert({ "Newcomer", 5000 + f, 1 });
+            checksum += board.sorted().front().score;
+        }
+        double afterAddUs = nsSince(start) / (FRAMES / 10) / 1000;
+
+        cout << setw(8) << k << setw(14) << fixed << setprecision(1) << insertNs << setw(18) << cachedNs
+             << setw(18) << setprecision(2) << afterAddUs;
+        if (k <= 1000)
+        {
+            vector<LeaderboardEntry> heap = board.sorted();
+            start = chrono::steady_clock::now();
+            for (int f = 0; f < FRAMES / 10; f++)
+                checksum += bubbleSortFrame(heap);
+            cout << setw(18) << nsSince(start) / (FRAMES / 10) / 1000;
+        }
+        else
+            cout << setw(18) << "-";
+        cout << endl;
+        if (checksum == 0)
+            cout << "empty board" << endl;
+    }
+
+    // Every player's best score: first scores, then a round of improvements
+    RankIndex ranks;
+    ranks.reserve(RANKED_PLAYERS);
+    vector<string> names(RANKED_PLAYERS);
+    for (int i = 0; i < RANKED_PLAYERS; i++)
+        names[i] = "Player" + to_string(i);
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < RANKED_PLAYERS; i++)
+        ranks.update(names[i], rand() % 5000);
+    for (int i = 0; i < RANKED_PLAYERS; i++)
+        ranks.update(names[rand() % RANKED_PLAYERS], rand() % 6000);
+    double updateNs = nsSince(start) / (2 * RANKED_PLAYERS);
+
+    long long checksum = 0;
+    start = chrono::steady_clock::now();
+    for (int q = 0; q < QUERIES; q++)
+        checksum += ranks.rankOf(names[rand() % RANKED_PLAYERS]);
+    double rankNs = nsSince(start) / QUERIES;
+
+    start = chrono::steady_clock::now();
+    for (int q = 0; q < QUERIES; q++)
+        checksum += (long long)ranks.percentile(rand() % 6000);
+    double percentileNs = nsSince(start) / QUERIES;
+
+    start = chrono::steady_clock::now();
+    for (int q = 0; q < QUERIES / 10; q++)
+        checksum += ranks.topRange(rand() % RANKED_PLAYERS, 10).size();
+    double pageNs = nsSince(start) / (QUERIES / 10);
+
+    cout << endl << "rank index, " << ranks.size() << " players: update " << setprecision(0) << updateNs
+         << " ns, rankOf " << rankNs << " ns, percentile " << percentileNs << " ns, page of 10 " << pageNs << " ns" << endl;
+    if (checksum == 0)
+        cout << "no ranks" << endl;
+    return 0;
+}
@@ -0,0 +1,352 @@
+// --- LOCKSTEP / ROLLBACK LOOPBACK BENCHMARK: TWO BOTS PLAY NETWORKED MATCHES THROUGH THE MATCH SERVER ---
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "Lockstep.h"
+#include "Rollback.h"
+#include "MatchServer.h"
+
+using namespace std;
+
+const double LATENCY_MS = 40;       // one way, added to everything a peer receives
+const double JITTER_MS = 10;        // plus up to this much, without reordering
+const double RUN_SECONDS = 30;     // a match lasts 5 to 40 s, so several fit
+const double MATCH_TIMEOUT = 60;    // seconds before a match that never ends is a failure
+
+// One side of the match: a socket to the server, a delay line standing in
+// for a long network path, and that side's own copy of the simulation
+template <typename Session>
+struct Peer
+{
+    int socket = -1;
+    string name;
+    FrameBuffer in;
+    struct Delayed
+    {
+        double releaseAt;
+        MessageType type;
+        string payload;
+    };
+    deque<Delayed> delayLine;
+
+    GameSimulation sim;
+    Session session;
+    bool matched = false, opponentLeft = false;
+    uint32_t seed = 0;
+    int seat = 0;
+    unordered_map<uint32_t, uint32_t> checksums;   // by tick, for confirmed ticks only
+    vector<uint8_t> inputs;
+    mt19937 bot;
+    uint32_t nextStep = 0;
+    int leg = -1, stepsLeft = 0, depth = 0;
+    int lastScore = 0, lastFrozen = 0;     // at the last confirmed tick
+    int captures = 0, freezes = 0;
+    long long bytesSent = 0;
+
+    explicit Peer(int inputDelay) : session(inputDelay) {}
+};
+
+static int rollbackCount(const LockstepSession&) { return 0; }
+static int rollbackCount(const RollbackSession& session) { return session.rollbackCount(); }
+static long long resimulatedTicks(const LockstepSession&) { return 0; }
+static long long resimulatedTicks(const RollbackSession& session) { return session.resimulatedTicks(); }
+
+static int connectLoopback(unsigned short port)
+{
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (s < 0 || connect(s, (sockaddr*)&address, sizeof(address)) != 0)
+    {
+        if (s >= 0)
+            close(s);
+        return -1;
+    }
+    int noDelay = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+    return s;
+}
+
+template <typename Session>
+static void sendFrame(Peer<Session>& peer, const string& frame)
+{
+    size_t sent = 0;
+    while (sent < frame.size())
+    {
+        ssize_t count = send(peer.socket, frame.data() + sent, frame.size() - sent, 0);
+        if (count > 0)
+            sent += (size_t)count;
+    }
+    peer.bytesSent += (long long)frame.size();
+}
+
+template <typename Session>
+static void join(Peer<Session>& peer)
+{
+    string frame;
+    MessageWriter(frame, MSG_JOIN).i32(1000).str(peer.name).finish();
+    sendFrame(peer, frame);
+    peer.matched = false;
+    peer.opponentLeft = false;
+}
+
+// Reads the socket into the delay line, then acts on what has come out of it
+template <typename Session>
+static void receive(Peer<Session>& peer, double now, double latency, double jitter, mt19937& rng)
+{
+    char chunk[4096];
+    ssize_t received;
+    while ((received = recv(peer.socket, chunk, sizeof(chunk), 0)) > 0)
+        peer.in.append(chunk, (size_t)received);
+
+    uniform_real_distribution<double> extra(0, jitter);
+    MessageType type;
+    const char* payload;
+    size_t size;
+    while (peer.in.next(type, payload, size))
+    {
+        // TCP never reorders, so neither does the delay line
+        double releaseAt = now + latency + extra(rng);
+        if (!peer.delayLine.empty())
+            releaseAt = max(releaseAt, peer.delayLine.back().releaseAt);
+        peer.delayLine.push_back({ releaseAt, type, string(payload, size) });
+    }
+
+    while (!peer.delayLine.empty() && peer.delayLine.front().releaseAt <= now)
+    {
+        typename Peer<Session>::Delayed message = peer.delayLine.front();
+        peer.delayLine.pop_front();
+        MessageReader reader(message.payload.data(), message.payload.size());
+        if (message.type == MSG_MATCHED)
+        {
+            reader.u32();
+            peer.seat = reader.u8();
+            peer.seed = reader.u32();
+            peer.matched = true;
+            peer.opponentLeft = false;
+            peer.session.start(peer.sim, peer.seat, peer.seed, LOCKSTEP_ENEMIES);
+            peer.checksums.clear();
+            peer.nextStep = 0;
+            peer.leg = -1;
+            peer.stepsLeft = peer.depth = 0;
+            peer.lastScore = peer.lastFrozen = 0;
+        }
+        else if (message.type == MSG_PEER_INPUT && peer.matched)
+        {
+            uint32_t firstTick = reader.u32();
+            size_t count;
+            const uint8_t* bytes = (const uint8_t*)reader.rest(count);
+            peer.session.receive(firstTick, bytes, count);
+        }
+        else if (message.type == MSG_PEER_LEFT)
+            peer.opponentLeft = true;
+    }
+}
+
+// Capture bot: walks rectangles, out from the border 1 to 3 steps, along
+// it 1 to 12, back as far as it went out, then along again, so it closes
+// thin strips and lives for a while among the enemies. Seat 0 starts left
+// of seat 1 and circles the other way round, away from it. Keys are held
+// down like a player would, one input per tick, and power-ups are tried
+// now and then, freezing the opponent once one is earned.
+template <typename Session>
+static void play(Peer<Session>& peer, float dt)
+{
+    static const int sides[4][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+    bool power = false;
+    if (peer.session.tick() >= peer.nextStep)
+    {
+        if (peer.stepsLeft-- <= 0)
+        {
+            peer.leg++;
+            if (peer.leg % 4 == 0)
+                peer.depth = 1 + peer.bot() % 3;
+            peer.stepsLeft = peer.leg % 2 == 0 ? peer.depth : 1 + peer.bot() % 12;
+        }
+        power = peer.bot() % 40 == 0;
+        peer.nextStep = peer.session.tick() + PLAYER_STEP_TICKS;
+    }
+    int side = peer.seat == 0 ? (4 - peer.leg % 4) % 4 : peer.leg % 4;
+    uint8_t input = directionInput(sides[side][0], sides[side][1]);
+    if (power)
+        input |= INPUT_POWER_UP;
+    peer.session.setLocalInput(input);
+
+    // Predicted states can't be compared, only confirmed ones
+    peer.session.update(peer.sim, dt);
+    if (peer.session.confirmedTick() == peer.session.tick())
+    {
+        peer.checksums[peer.session.tick()] = peer.sim.checksum();
+
+        // What the match went through, seen at confirmed ticks only
+        int score = peer.sim.players[0].score + peer.sim.players[1].score;
+        int frozen = max(peer.sim.players[0].frozenTicks, peer.sim.players[1].frozenTicks);
+        if (score > peer.lastScore)
+            peer.captures++;
+        if (frozen > peer.lastFrozen)
+            peer.freezes++;
+        peer.lastScore = score;
+        peer.lastFrozen = frozen;
+    }
+
+    uint32_t firstTick;
+    if (peer.session.takeOutgoing(firstTick, peer.inputs))
+    {
+        string frame;
+        MessageWriter(frame, MSG_INPUT).u32(firstTick).bytes(peer.inputs.data(), peer.inputs.size()).finish();
+        sendFrame(peer, frame);
+    }
+}
+
+template <typename Session>
+static int run(const char* mode, double latency, double jitter, int inputDelay, double runSeconds)
+{
+    MatchServer server;
+    server.setMatchInterval(0.01);
+    if (!server.listen(0, true))
+    {
+        cerr << "could not listen on loopback" << endl;
+        return 1;
+    }
+    thread serverThread([&server]() { server.run(); });
+
+    Peer<Session> peers[2] = { Peer<Session>(inputDelay), Peer<Session>(inputDelay) };
+    for (int i = 0; i < 2; i++)
+    {
+        peers[i].socket = connectLoopback(server.port());
+        peers[i].name = "Bot" + to_string(i);
+        peers[i].bot.seed(1234 + i);
+        if (peers[i].socket < 0)
+        {
+            cerr << "could not connect to the server" << endl;
+            server.stop();
+            serverThread.join();
+            return 1;
+        }
+        join(peers[i]);
+    }
+
+    mt19937 rng(99);
+    auto start = chrono::steady_clock::now();
+    auto elapsed = [&start]() { return chrono::duration<double>(chrono::steady_clock::now() - start).count(); };
+    int matches = 0, desyncs = 0, failures = 0, stalls = 0, rollbacks = 0, headOn = 0;
+    long long ticks = 0, comparedTicks = 0, resimulated = 0;
+    double playSeconds = 0, matchStart = -1, last = 0;
+
+    pollfd fds[2] = { { peers[0].socket, POLLIN, 0 }, { peers[1].socket, POLLIN, 0 } };
+    while (elapsed() < runSeconds || matchStart >= 0)
+    {
+        ::poll(fds, 2, 1);
+        double now = elapsed();
+        float dt = (float)(now - last);
+        last = now;
+        for (Peer<Session>& peer : peers)
+            receive(peer, now, latency, jitter, rng);
+        if (!peers[0].matched || !peers[1].matched)
+            continue;
+        if (matchStart < 0)
+            matchStart = now;
+
+        for (Peer<Session>& peer : peers)
+            if (!peer.session.over(peer.sim))
+                play(peer, dt);
+
+        bool over = peers[0].session.over(peers[0].sim) && peers[1].session.over(peers[1].sim);
+        bool stuck = now - matchStart > MATCH_TIMEOUT || peers[0].opponentLeft || peers[1].opponentLeft;
+        if (!over && !stuck)
+            continue;
+
+        // Both sides must have seen exactly the same match
+        if (over)
+        {
+            for (const auto& entry : peers[0].checksums)
+            {
+                auto other = peers[1].checksums.find(entry.first);
+                if (other == peers[1].checksums.end())
+                    continue;
+                comparedTicks++;
+                if (other->second != entry.second)
+                {
+                    desyncs++;
+                    break;
+                }
+            }
+            if (peers[0].session.tick() != peers[1].session.tick() ||
+                peers[0].sim.checksum() != peers[1].sim.checksum())
+                desyncs++;
+            matches++;
+            for (const SimPlayer& player : peers[0].sim.players)
+                if (player.deathReason.compare(0, 8, "Collided") == 0)
+                {
+                    headOn++;
+                    break;
+                }
+        }
+        else
+            failures++;
+        ticks += peers[0].session.tick();
+        for (Peer<Session>& peer : peers)
+        {
+            stalls += peer.session.stallCount();
+            rollbacks += rollbackCount(peer.session);
+            resimulated += resimulatedTicks(peer.session);
+        }
+        playSeconds += now - matchStart;
+        matchStart = -1;
+        if (elapsed() < runSeconds)
+            for (Peer<Session>& peer : peers)
+                join(peer);
+        else
+            break;
+    }
+
+    long long bytes = peers[0].bytesSent + peers[1].bytesSent;
+    cout << fixed << setprecision(1) << mode << ": latency " << latency * 1000 << " ms + up to " << jitter * 1000
+         << " ms jitter each way, input delay " << inputDelay << " ticks ("
+         << inputDelay * LOCKSTEP_TICK_SECONDS * 1000 << " ms)" << endl;
+    cout << matches << " matches, " << ticks << " ticks, " << failures << " failed, " << desyncs << " desynced ("
+         << comparedTicks << " tick checksums compared)" << endl;
+    cout << setprecision(1) << (matches + failures > 0 ? (double)ticks / (matches + failures) : 0.0)
+         << " ticks per match, " << peers[0].captures << " captures, " << peers[0].freezes << " power-up freezes, "
+         << headOn << " head-on collisions" << endl;
+    cout << setprecision(2) << "tick rate " << (playSeconds > 0 ? ticks / playSeconds : 0.0) << "/s (nominal "
+         << 1 / LOCKSTEP_TICK_SECONDS << "), " << stalls << " stalls, " << rollbacks << " rollbacks replaying "
+         << resimulated << " ticks" << endl;
+    cout << "client -> server bytes per tick per player: " << (ticks > 0 ? (double)bytes / 2 / ticks : 0.0) << endl;
+
+    for (Peer<Session>& peer : peers)
+        close(peer.socket);
+    server.stop();
+    serverThread.join();
+    return desyncs == 0 && failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    double latency = (argc > 1 ? atof(argv[1]) : LATENCY_MS) / 1000;
+    double jitter = (argc > 2 ? atof(argv[2]) : JITTER_MS) / 1000;
+    bool rollback = argc > 5 && string(argv[5]) == "rollback";
+    int inputDelay = argc > 3 ? atoi(argv[3]) : (rollback ? DEFAULT_ROLLBACK_DELAY : DEFAULT_INPUT_DELAY);
+    double runSeconds = argc > 4 ? atof(argv[4]) : RUN_SECONDS;
+    if (rollback)
+        return run<RollbackSession>("rollback", latency, jitter, inputDelay, runSeconds);
+    return run<LockstepSession>("lockstep", latency, jitter, inputDelay, runSeconds);
+}
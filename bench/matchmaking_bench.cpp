@@ -0,0 +1,88 @@
+// --- MATCHMAKING BENCHMARK: SKILL-BRACKETED BATCH PASSES OVER A LARGE QUEUE ---
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "Matchmaking.h"
+
+using namespace std;
+
+const int QUEUED_PLAYERS = 100000;
+const int ARRIVALS_PER_SECOND = 20000;
+const int SIM_SECONDS = 60;
+const double BATCH_INTERVAL = 1.0;     // simulated seconds between passes
+
+static double secondsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    int queued = argc > 1 ? atoi(argv[1]) : QUEUED_PLAYERS;
+
+    // Most players near the middle, a thin tail of strong ones who are
+    // the hard case for a score window
+    mt19937 rng(2024);
+    normal_distribution<double> skill(2000, 600);
+    exponential_distribution<double> tail(1.0 / 3000);
+    auto drawScore = [&]() {
+        double score = (rng() % 20 == 0) ? 4000 + tail(rng) : skill(rng);
+        return (int)max(0.0, score);
+    };
+
+    SkillMatchmaker matchmaker;
+    matchmaker.reserve(queued + ARRIVALS_PER_SECOND * 2);
+    vector<MatchPair> matches;
+    long long nextName = 0;
+
+    for (int i = 0; i < queued; i++, nextName++)
+        matchmaker.enqueue("Player" + to_string(nextName), drawScore(), (int)nextName, 0.0);
+
+    auto start = chrono::steady_clock::now();
+    int made = matchmaker.runBatch(0.0, matches);
+    double firstPass = secondsSince(start);
+    cout << "first pass over " << queued << " queued: " << made << " matches in " << fixed << setprecision(1)
+         << firstPass * 1000 << " ms (" << setprecision(0) << made / firstPass << " matches/sec), "
+         << matchmaker.waiting() << " still waiting" << endl;
+    long long gapTotal = 0;
+    for (const MatchPair& pair : matches)
+        gapTotal += abs(pair.first.score - pair.second.score);
+    cout << "mean score gap " << setprecision(1) << (made ? (double)gapTotal / made : 0.0) << endl;
+
+    // Steady state: a wave of arrivals, then a pass, every simulated second
+    matchmaker.resetStats();
+    matches.clear();
+    double batchSeconds = 0;
+    gapTotal = 0;
+    int largestWaiting = 0;
+    for (int second = 1; second <= SIM_SECONDS; second++)
+    {
+        double now = second * BATCH_INTERVAL;
+        for (int i = 0; i < ARRIVALS_PER_SECOND; i++, nextName++)
+            matchmaker.enqueue("Player" + to_string(nextName), drawScore(), (int)nextName,
+                now - BATCH_INTERVAL * (i + 1) / ARRIVALS_PER_SECOND);
+        largestWaiting = max(largestWaiting, matchmaker.waiting());
+
+        matches.clear();
+        start = chrono::steady_clock::now();
+        matchmaker.runBatch(now, matches);
+        batchSeconds += secondsSince(start);
+        for (const MatchPair& pair : matches)
+            gapTotal += abs(pair.first.score - pair.second.score);
+    }
+
+    long long total = matchmaker.matchesMade();
+    cout << SIM_SECONDS << " passes, " << ARRIVALS_PER_SECOND << " arrivals/sec, up to " << largestWaiting
+         << " waiting: " << total << " matches, " << setprecision(0) << total / batchSeconds
+         << " matches/sec of batch time, " << setprecision(2) << batchSeconds / SIM_SECONDS * 1000
+         << " ms per pass" << endl;
+    cout << "mean score gap " << setprecision(1) << (total ? (double)gapTotal / total : 0.0) << endl;
+    cout << "wait p50 " << setprecision(2) << matchmaker.waitPercentile(50) << " s, p90 "
+         << matchmaker.waitPercentile(90) << " s, p99 " << matchmaker.waitPercentile(99) << " s, max "
+         << matchmaker.waitPercentile(100) << " s" << endl;
+    return 0;
+}
@@ -0,0 +1,319 @@
+// --- MATCHMAKING LOAD GENERATOR: ARRIVALS, ABANDONMENT AND MATCH PASSES AGAINST EACH QUEUE ---
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Matchmaking.h"
+
+using namespace std;
+
+const double ARRIVALS_PER_SECOND = 5000;
+const double SIM_SECONDS = 120;
+const double MEAN_PATIENCE = 20;       // seconds before a player gives up, exponential
+const double STEP = 0.01;              // simulated seconds between arrival batches
+const double MATCH_INTERVAL = 1.0;     // simulated seconds between match passes
+
+// -------------------------------------------------------------
+// HEAP ACCOUNTING
+// -------------------------------------------------------------
+// Every allocation carries its size in front, so the bench knows how
+// many bytes are live at any moment without platform allocator hooks
+static size_t liveBytes = 0;
+const size_t ALLOC_HEADER = alignof(max_align_t);
+
+void* operator new(size_t size)
+{
+    char* block = (char*)malloc(size + ALLOC_HEADER);
+    if (!block)
+        throw bad_alloc();
+    *(size_t*)block = size;
+    liveBytes += size;
+    return block + ALLOC_HEADER;
+}
+
+void operator delete(void* p) noexcept
+{
+    if (!p)
+        return;
+    char* block = (char*)p - ALLOC_HEADER;
+    liveBytes -= *(size_t*)block;
+    free(block);
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+
+// -------------------------------------------------------------
+// LATENCY HISTOGRAM
+// -------------------------------------------------------------
+// Power-of-two buckets of nanoseconds: bucket b holds [2^b, 2^(b+1))
+struct Histogram
+{
+    static const int BUCKETS = 40;
+    long long counts[BUCKETS] = {};
+    long long total = 0;
+    double totalNs = 0;
+
+    void add(double ns)
+    {
+        int b = 0;
+        while (b + 1 < BUCKETS && ns >= (double)(2ull << b))
+            b++;
+        counts[b]++;
+        total++;
+        totalNs += ns;
+    }
+
+    // Upper edge of the bucket holding this percentile
+    double percentile(double percent) const
+    {
+        long long target = (long long)(percent / 100.0 * total);
+        long long seen = 0;
+        for (int b = 0; b < BUCKETS; b++)
+        {
+            seen += counts[b];
+            if (seen > target)
+                return (double)(2ull << b);
+        }
+        return 0;
+    }
+
+    void print(const char* name) const
+    {
+        cout << "  " << left << setw(8) << name << right << setw(10) << total << " ops, "
+             << setw(12) << fixed << setprecision(0) << (totalNs > 0 ? total / (totalNs * 1e-9) : 0.0)
+             << " ops/sec, p50 < " << setw(8) << percentile(50) << " ns, p99 < " << setw(9) << percentile(99)
+             << " ns" << endl;
+        int first = BUCKETS, last = -1;
+        for (int b = 0; b < BUCKETS; b++)
+            if (counts[b])
+            {
+                first = min(first, b);
+                last = b;
+            }
+        for (int b = first; b <= last; b++)
+        {
+            int bar = (int)(50.0 * counts[b] / total + 0.5);
+            cout << "    < " << setw(10) << (2ull << b) << " ns " << setw(10) << counts[b] << " "
+                 << string(bar, '#') << endl;
+        }
+    }
+};
+
+// -------------------------------------------------------------
+// QUEUES UNDER TEST
+// -------------------------------------------------------------
+struct QueueUnderTest
+{
+    virtual ~QueueUnderTest() {}
+    virtual const char* name() const = 0;
+    virtual void enqueue(const string& username, int score, int id, double now) = 0;
+    virtual void leave(const string& username, int id) = 0;
+    // One match pass; pairs go to `matches`
+    virtual void match(double now, vector<MatchPair>& matches) = 0;
+    virtual int waiting() const = 0;
+};
+
+// What MatchmakingSystem did before skill brackets: pair off the two
+// highest scores whenever two players are queued
+struct HighestScoreQueue : QueueUnderTest
+{
+    PriorityQueue queue;
+    unordered_map<int, double> since;   // queue time by player id
+
+    const char* name() const override { return "highest score first (PriorityQueue)"; }
+
+    void enqueue(const string& username, int score, int id, double now) override
+    {
+        since[id] = now;
+        queue.push(username, score, id);
+    }
+
+    void leave(const string& username, int id) override
+    {
+        queue.removePlayer(username);
+        since.erase(id);
+    }
+
+    void match(double now, vector<MatchPair>& matches) override
+    {
+        MatchPair pair;
+        while (queue.getSize() >= 2)
+        {
+            queue.pop(pair.first);
+            queue.pop(pair.second);
+            pair.firstWait = (float)(now - since[pair.first.id]);
+            pair.secondWait = (float)(now - since[pair.second.id]);
+            since.erase(pair.first.id);
+            since.erase(pair.second.id);
+            matches.push_back(pair);
+        }
+    }
+
+    int waiting() const override { return queue.getSize(); }
+};
+
+struct SkillQueue : QueueUnderTest
+{
+    SkillMatchmaker matchmaker;
+
+    const char* name() const override { return "skill buckets (SkillMatchmaker)"; }
+    void enqueue(const string& username, int score, int id, double now) override { matchmaker.enqueue(username, score, id, now); }
+    void leave(const string& username, int) override { matchmaker.leave(username); }
+    void match(double now, vector<MatchPair>& matches) override { matchmaker.runBatch(now, matches); }
+    int waiting() const override { return matchmaker.waiting(); }
+};
+
+// -------------------------------------------------------------
+// LOAD GENERATOR
+// -------------------------------------------------------------
+struct Abandon
+{
+    double time;
+    int id;
+    bool operator>(const Abandon& other) const { return time > other.time; }
+};
+
+static double nsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+static float percentileOf(vector<float>& values, double percent)
+{
+    if (values.empty())
+        return 0;
+    size_t k = min(values.size() - 1, (size_t)(percent / 100.0 * values.size()));
+    nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+// Same seed for every queue, so each sees the same players arrive and
+// run out of patience at the same moments
+static void run(QueueUnderTest& queue, double arrivalRate, double seconds, double meanPatience)
+{
+    mt19937 rng(2024);
+    poisson_distribution<int> arrivals(arrivalRate * STEP);
+    exponential_distribution<double> patience(1.0 / meanPatience);
+    normal_distribution<double> skill(2000, 600);
+    exponential_distribution<double> tail(1.0 / 3000);
+
+    vector<string> names;
+    vector<char> matched;
+    priority_queue<Abandon, vector<Abandon>, greater<Abandon>> abandons;
+    vector<MatchPair> matches;
+    vector<float> waits;
+    Histogram enqueueTimes, leaveTimes, matchTimes;
+    long long abandoned = 0, gapTotal = 0;
+    int peakWaiting = 0;
+    double bytesPerPlayer = 0;
+
+    // Bytes the queue holds: what its own calls allocated and didn't free
+    long long queueBytes = 0;
+    size_t before = 0;
+    double nextMatch = MATCH_INTERVAL;
+    for (double now = 0; now < seconds; now += STEP)
+    {
+        int count = arrivals(rng);
+        for (int i = 0; i < count; i++)
+        {
+            int id = (int)names.size();
+            names.push_back("Player" + to_string(id));
+            matched.push_back(0);
+            double score = (rng() % 20 == 0) ? 4000 + tail(rng) : skill(rng);
+            abandons.push({ now + patience(rng), id });
+
+            before = liveBytes;
+            auto start = chrono::steady_clock::now();
+            queue.enqueue(names[id], (int)max(0.0, score), id, now);
+            enqueueTimes.add(nsSince(start));
+            queueBytes += (long long)liveBytes - (long long)before;
+        }
+
+        while (!abandons.empty() && abandons.top().time <= now)
+        {
+            int id = abandons.top().id;
+            abandons.pop();
+            if (matched[id])
+                continue;
+            before = liveBytes;
+            auto start = chrono::steady_clock::now();
+            queue.leave(names[id], id);
+            leaveTimes.add(nsSince(start));
+            queueBytes += (long long)liveBytes - (long long)before;
+            matched[id] = 1;
+            abandoned++;
+        }
+
+        if (now + STEP / 2 >= nextMatch)
+        {
+            nextMatch += MATCH_INTERVAL;
+
+            // Sampled at the largest queue, before the pass shrinks it
+            int waitingNow = queue.waiting();
+            if (waitingNow > peakWaiting)
+            {
+                peakWaiting = waitingNow;
+                bytesPerPlayer = (double)queueBytes / waitingNow;
+            }
+
+            matches.clear();
+            size_t matchesBytes = matches.capacity() * sizeof(MatchPair);
+            before = liveBytes;
+            auto start = chrono::steady_clock::now();
+            queue.match(now, matches);
+            matchTimes.add(nsSince(start));
+            queueBytes += (long long)liveBytes - (long long)before
+                - (long long)(matches.capacity() * sizeof(MatchPair) - matchesBytes);
+            for (const MatchPair& pair : matches)
+            {
+                matched[pair.first.id] = matched[pair.second.id] = 1;
+                waits.push_back(pair.firstWait);
+                waits.push_back(pair.secondWait);
+                gapTotal += abs(pair.first.score - pair.second.score);
+            }
+        }
+    }
+
+    long long pairs = (long long)waits.size() / 2;
+    cout << queue.name() << endl;
+    cout << "  " << names.size() << " arrivals, " << pairs << " matches, " << abandoned << " gave up, "
+         << queue.waiting() << " still waiting, peak " << peakWaiting << " waiting" << endl;
+    cout << "  mean score gap " << fixed << setprecision(1) << (pairs ? (double)gapTotal / pairs : 0.0)
+         << ", wait p50 " << setprecision(2) << percentileOf(waits, 50) << " s, p99 " << percentileOf(waits, 99)
+         << " s, memory " << setprecision(0) << bytesPerPlayer << " bytes per queued player" << endl;
+    enqueueTimes.print("enqueue");
+    leaveTimes.print("leave");
+    matchTimes.print("match");
+    cout << endl;
+}
+
+int main(int argc, char** argv)
+{
+    double arrivalRate = argc > 1 ? atof(argv[1]) : ARRIVALS_PER_SECOND;
+    double seconds = argc > 2 ? atof(argv[2]) : SIM_SECONDS;
+    double meanPatience = argc > 3 ? atof(argv[3]) : MEAN_PATIENCE;
+    cout << arrivalRate << " arrivals/sec for " << seconds << " s, mean patience " << meanPatience
+         << " s, a match pass every " << MATCH_INTERVAL << " s" << endl << endl;
+
+    {
+        HighestScoreQueue queue;
+        run(queue, arrivalRate, seconds, meanPatience);
+    }
+    {
+        SkillQueue queue;
+        run(queue, arrivalRate, seconds, meanPatience);
+    }
+    return 0;
+}
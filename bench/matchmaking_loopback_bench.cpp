@@ -0,0 +1,199 @@
+// --- MATCH SERVER LOOPBACK BENCHMARK: N FAKE CLIENTS QUEUE OVER TCP AND WAIT FOR A MATCH ---
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "MatchServer.h"
+
+using namespace std;
+
+const int CLIENTS = 2000;
+const double JOIN_SPREAD = 2.0;     // seconds over which the clients queue
+const double PASS_INTERVAL = 0.05;  // seconds between the server's match passes
+const float MAX_WAIT = 5;           // seconds before anyone is accepted as an opponent
+const double TIMEOUT = 20;          // seconds before unmatched clients are given up on
+
+struct FakeClient
+{
+    int socket = -1;
+    string name;
+    int score = 0;
+    double joinAt = 0;      // seconds after the start
+    bool joined = false, queued = false, matched = false;
+    double queuedAfter = 0, matchedAfter = 0;
+    int opponentScore = 0;
+    FrameBuffer in;
+};
+
+static float percentileOf(vector<float> values, double percent)
+{
+    if (values.empty())
+        return 0;
+    size_t k = min(values.size() - 1, (size_t)(percent / 100.0 * values.size()));
+    nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+static int connectLoopback(unsigned short port)
+{
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (s < 0 || connect(s, (sockaddr*)&address, sizeof(address)) != 0)
+    {
+        if (s >= 0)
+            close(s);
+        return -1;
+    }
+    int noDelay = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+    return s;
+}
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? atoi(argv[1]) : CLIENTS;
+    double passInterval = argc > 2 ? atof(argv[2]) / 1000 : PASS_INTERVAL;
+
+    MatchmakingRules rules;
+    rules.maxWait = MAX_WAIT;
+    MatchServer server(rules);
+    server.setMatchInterval(passInterval);
+    if (!server.listen(0, true))
+    {
+        cerr << "could not listen on loopback" << endl;
+        return 1;
+    }
+    thread serverThread([&server]() { server.run(); });
+
+    mt19937 rng(2024);
+    normal_distribution<double> skill(2000, 600);
+    uniform_real_distribution<double> joinTime(0, JOIN_SPREAD);
+    vector<FakeClient> clients(count);
+
+    auto start = chrono::steady_clock::now();
+    auto elapsed = [&start]() { return chrono::duration<double>(chrono::steady_clock::now() - start).count(); };
+    for (int i = 0; i < count; i++)
+    {
+        clients[i].socket = connectLoopback(server.port());
+        if (clients[i].socket < 0)
+        {
+            cerr << "connect failed after " << i << " clients (raise ulimit -n?)" << endl;
+            server.stop();
+            serverThread.join();
+            return 1;
+        }
+        clients[i].name = "Bot" + to_string(i);
+        clients[i].score = (int)max(0.0, skill(rng));
+    }
+    double connectSeconds = elapsed();
+
+    start = chrono::steady_clock::now();
+    for (FakeClient& client : clients)
+        client.joinAt = joinTime(rng);
+
+    vector<pollfd> fds(count);
+    for (int i = 0; i < count; i++)
+        fds[i] = { clients[i].socket, POLLIN, 0 };
+
+    int matched = 0, errors = 0;
+    char chunk[4096];
+    while (matched < count - count % 2 && elapsed() < TIMEOUT)
+    {
+        double now = elapsed();
+        for (FakeClient& client : clients)
+            if (!client.joined && client.joinAt <= now)
+            {
+                string frame;
+                MessageWriter(frame, MSG_JOIN).i32(client.score).str(client.name).finish();
+                if (send(client.socket, frame.data(), frame.size(), 0) == (ssize_t)frame.size())
+                    client.joined = true;
+                client.joinAt = now;
+            }
+
+        if (::poll(fds.data(), fds.size(), 5) <= 0)
+            continue;
+        for (int i = 0; i < count; i++)
+        {
+            if (!(fds[i].revents & POLLIN))
+                continue;
+            FakeClient& client = clients[i];
+            ssize_t received = recv(client.socket, chunk, sizeof(chunk), 0);
+            if (received <= 0)
+                continue;
+            client.in.append(chunk, (size_t)received);
+
+            MessageType type;
+            const char* payload;
+            size_t size;
+            double at = elapsed();
+            while (client.in.next(type, payload, size))
+            {
+                MessageReader reader(payload, size);
+                if (type == MSG_QUEUED && !client.queued)
+                {
+                    client.queued = true;
+                    client.queuedAfter = at - client.joinAt;
+                }
+                else if (type == MSG_MATCHED && !client.matched)
+                {
+                    reader.u32();
+                    reader.u8();
+                    reader.u32();
+                    client.opponentScore = reader.i32();
+                    client.matched = true;
+                    client.matchedAfter = at - client.joinAt;
+                    matched++;
+                }
+                else if (type == MSG_ERROR)
+                    errors++;
+            }
+        }
+    }
+    double runSeconds = elapsed();
+
+    vector<float> queuedLatency, matchLatency;
+    long long gapTotal = 0;
+    for (const FakeClient& client : clients)
+    {
+        if (client.queued)
+            queuedLatency.push_back((float)client.queuedAfter * 1000);
+        if (client.matched)
+        {
+            matchLatency.push_back((float)client.matchedAfter * 1000);
+            gapTotal += abs(client.score - client.opponentScore);
+        }
+    }
+
+    cout << count << " clients connected in " << fixed << setprecision(1) << connectSeconds * 1000 << " ms, "
+         << "joined over " << JOIN_SPREAD << " s, server pass every " << passInterval * 1000 << " ms, max wait "
+         << MAX_WAIT << " s" << endl;
+    cout << matched << " matched (" << matched / 2 << " matches) in " << setprecision(2) << runSeconds << " s, "
+         << errors << " errors, mean score gap " << setprecision(1) << (matched ? (double)gapTotal / matched : 0.0)
+         << endl;
+    cout << "join -> queued  p50 " << setprecision(3) << percentileOf(queuedLatency, 50) << " ms, p99 "
+         << percentileOf(queuedLatency, 99) << " ms" << endl;
+    cout << "join -> matched p50 " << percentileOf(matchLatency, 50) << " ms, p99 " << percentileOf(matchLatency, 99)
+         << " ms, max " << percentileOf(matchLatency, 100) << " ms" << endl;
+
+    for (FakeClient& client : clients)
+        close(client.socket);
+    server.stop();
+    serverThread.join();
+    return 0;
+}
@@ -0,0 +1,60 @@
+// --- HEADLESS MATCH THROUGHPUT: RUNS MANY BOT MATCHES WITHOUT A WINDOW ---
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include "GameSimulation.h"
+
+using namespace std;
+
+const int MAX_TICKS_PER_MATCH = 20000;
+const uint64_t BENCH_SEED = 12345;
+
+// Random-walk bot: picks a new direction every few ticks. It draws from its
+// own seeded generator, so every platform plays exactly the same matches.
+void botInput(GameSimulation& sim, SimRandom& random, int player, int tick)
+{
+    if ((tick + player) % 12 != 0)
+        return;
+    static const int dirs[4][2] = { { 0, 1 }, { 0, -1 }, { 1, 0 }, { -1, 0 } };
+    int d = random.below(4);
+    sim.setDirection(player, dirs[d][0], dirs[d][1]);
+    if (random.below(50) == 0)
+        sim.usePowerUp(player);
+}
+
+int main(int argc, char** argv)
+{
+    int matches = argc > 1 ? atoi(argv[1]) : 2000;
+    int players = argc > 2 ? atoi(argv[2]) : 1;
+    bool fullScan = !(argc > 3 && string(argv[3]) == "incremental");
+    GameSimulation sim(DEFAULT_ROWS, DEFAULT_COLS, BENCH_SEED);
+    SimRandom bot(BENCH_SEED);
+    sim.setCaptureMode(fullScan ? CAPTURE_FULL_SCAN : CAPTURE_INCREMENTAL);
+    long long totalTicks = 0, totalScore = 0;
+    auto start = chrono::steady_clock::now();
+    for (int m = 0; m < matches; m++)
+    {
+        sim.reset(players, 4);
+        int tick = 0;
+        while (!sim.isOver() && tick < MAX_TICKS_PER_MATCH)
+        {
+            for (int p = 0; p < players; p++)
+                botInput(sim, bot, p, tick);
+            sim.tick();
+            tick++;
+        }
+        totalTicks += tick;
+        for (int p = 0; p < players; p++)
+            totalScore += sim.players[p].score;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "matches:        " << matches << " (" << players << " player, "
+         << (fullScan ? "full scan" : "incremental") << " capture)" << endl;
+    cout << "ticks:          " << totalTicks << endl;
+    cout << "avg score:      " << (double)totalScore / (matches * players) << endl;
+    cout << "matches/sec:    " << matches / seconds << endl;
+    cout << "ticks/sec:      " << totalTicks / seconds << endl;
+    return 0;
+}
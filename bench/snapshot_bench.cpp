@@ -0,0 +1,142 @@
+// --- SNAPSHOT BENCHMARK: WHAT A ROLLBACK COSTS, FROM THE CLASSIC ARENA TO STRESS BOARDS ---
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <string>
+#include "GameSimulation.h"
+#include "Lockstep.h"
+#include "Rollback.h"
+
+using namespace std;
+
+const int WARMUP_TICKS = 600;       // ten seconds in, so trails and captures exist
+const int ROLLBACK_TICKS = 8;       // a typical correction at ~70 ms round trip
+const int REPS = 200;
+
+// Two random-walk players, as in sim_bench, driven through the same input
+// bytes a networked match uses
+static void play(GameSimulation& sim, mt19937& rng)
+{
+    static const uint8_t dirs[4] = { INPUT_UP, INPUT_DOWN, INPUT_LEFT, INPUT_RIGHT };
+    for (int player = 0; player < 2; player++)
+        if (rng() % 12 == 0)
+            applyInput(sim, player, dirs[rng() % 4]);
+    sim.tick();
+    if (sim.isOver())
+        sim.reset(2, LOCKSTEP_ENEMIES);
+}
+
+static double secondsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static size_t snapshotBytes(const SimSnapshot& snapshot)
+{
+    size_t bytes = sizeof(snapshot) + snapshot.tiles.size() * sizeof(Board::Word);
+    for (const vector<int>& trail : snapshot.trailCells)
+        bytes += trail.size() * sizeof(int);
+    return bytes;
+}
+
+// A snapshot of another board must be refused and change nothing, including
+// one with the same rows and other columns: padded to whole cache lines,
+// 25x40 and 25x400 rows take the same number of words
+static int checkSizeMismatch()
+{
+    const int others[][2] = { { 25, 400 }, { 25, 41 }, { 26, 40 }, { 40, 25 } };
+    int failures = 0;
+    for (const auto& o : others)
+    {
+        mt19937 rng(3);
+        GameSimulation sim(25, 40, 2024), other(o[0], o[1], 2024);
+        other.reset(2, LOCKSTEP_ENEMIES);
+        for (int i = 0; i < WARMUP_TICKS; i++)
+            play(other, rng);
+        SimSnapshot foreign, own;
+        other.save(foreign);
+        sim.save(own);
+        uint32_t before = sim.checksum();
+        bool refused = !sim.restore(foreign) && sim.checksum() == before;
+        bool ownRestored = sim.restore(own) && sim.checksum() == before;
+        if (!refused || !ownRestored)
+        {
+            cout << "25x40 restoring a " << o[0] << "x" << o[1] << " snapshot: "
+                 << (refused ? "refused" : "NOT refused") << ", own snapshot "
+                 << (ownRestored ? "restored" : "NOT restored") << endl;
+            failures++;
+        }
+    }
+    cout << "size mismatch checks: " << failures << " failed" << endl;
+    return failures;
+}
+
+int main()
+{
+    if (checkSizeMismatch() > 0)
+        return 1;
+
+    const int sizes[][2] = { { 25, 40 }, { 100, 160 }, { 500, 800 }, { 2000, 2000 } };
+
+    cout << left << setw(12) << "size" << setw(13) << "capture" << setw(14) << "KB/snapshot"
+         << setw(10) << "us/save" << setw(13) << "us/restore" << setw(10) << "us/tick"
+         << "us/" << ROLLBACK_TICKS << "-tick rollback" << endl;
+    for (const auto& s : sizes)
+    {
+        for (CaptureMode mode : { CAPTURE_FULL_SCAN, CAPTURE_INCREMENTAL })
+        {
+            mt19937 rng(7);
+            GameSimulation sim(s[0], s[1], 2024);
+            sim.setCaptureMode(mode);
+            sim.reset(2, LOCKSTEP_ENEMIES);
+            for (int i = 0; i < WARMUP_TICKS; i++)
+                play(sim, rng);
+
+            // Two states ROLLBACK_TICKS apart, so each restore has a real diff to apply
+            SimSnapshot before, after;
+            sim.save(before);
+            for (int i = 0; i < ROLLBACK_TICKS; i++)
+                play(sim, rng);
+            sim.save(after);
+
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < REPS; i++)
+                sim.save(i % 2 ? after : before);
+            double saveSeconds = secondsSince(start);
+
+            start = chrono::steady_clock::now();
+            for (int i = 0; i < REPS; i++)
+                sim.restore(i % 2 ? after : before);
+            double restoreSeconds = secondsSince(start);
+
+            // What RollbackSession does on a misprediction: restore, then
+            // replay each tick and save the state that follows it
+            SimSnapshot ring[ROLLBACK_TICKS];
+            for (SimSnapshot& snapshot : ring)
+                sim.save(snapshot);
+            double tickSeconds = 0;
+            start = chrono::steady_clock::now();
+            for (int i = 0; i < REPS; i++)
+            {
+                sim.restore(before);
+                mt19937 replay(i);
+                for (int t = 0; t < ROLLBACK_TICKS; t++)
+                {
+                    auto tick = chrono::steady_clock::now();
+                    play(sim, replay);
+                    tickSeconds += secondsSince(tick);
+                    sim.save(ring[t]);
+                }
+            }
+            double rollbackSeconds = secondsSince(start);
+
+            cout << left << setw(12) << (to_string(s[0]) + "x" + to_string(s[1]))
+                 << setw(13) << (mode == CAPTURE_FULL_SCAN ? "full scan" : "incremental")
+                 << fixed << setprecision(1) << setw(14) << snapshotBytes(before) / 1024.0 << setprecision(2)
+                 << setw(10) << saveSeconds * 1e6 / REPS << setw(13) << restoreSeconds * 1e6 / REPS
+                 << setw(10) << tickSeconds * 1e6 / REPS / ROLLBACK_TICKS << rollbackSeconds * 1e6 / REPS << endl;
+        }
+    }
+    return 0;
+}
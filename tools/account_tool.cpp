@@ -0,0 +1,43 @@
+// --- ACCOUNT STORE CONVERTER: players.txt (CSV) <-> players.dat (BINARY) ---
+#include <iostream>
+#include <string>
+#include "AuthManager.h"
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+    string command = argc > 1 ? argv[1] : "";
+    if (argc != 4 || (command != "import" && command != "export"))
+    {
+        cerr << "usage: account_tool import players.txt players.dat" << endl;
+        cerr << "       account_tool export players.dat players.txt" << endl;
+        return 1;
+    }
+
+    if (command == "import")
+    {
+        // Adds the CSV rows whose names the store doesn't have yet
+        AuthManager accounts(argv[3], "");
+        int added = accounts.importCsv(argv[2]);
+        cout << "imported " << added << " players, " << accounts.playerCount() << " in " << argv[3] << endl;
+        return 0;
+    }
+
+    AccountStore store;
+    if (!store.open(argv[2]))
+    {
+        cerr << argv[2] << " is not an account store" << endl;
+        return 1;
+    }
+    store.close();
+
+    AuthManager accounts(argv[2], "");
+    if (!accounts.exportCsv(argv[3]))
+    {
+        cerr << "could not write " << argv[3] << endl;
+        return 1;
+    }
+    cout << "exported " << accounts.playerCount() << " players to " << argv[3] << endl;
+    return 0;
+}
@@ -0,0 +1,59 @@
+// --- MATCH SERVER DAEMON: SERVES THE MATCHMAKING QUEUE OVER TCP ---
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include "MatchServer.h"
+
+using namespace std;
+
+const double STATS_INTERVAL = 10;  // seconds between status lines
+
+static MatchServer* running = nullptr;
+
+static void stopServer(int)
+{
+    if (running)
+        running->stop();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 3)
+    {
+        cerr << "usage: match_server [port] [pass interval ms]" << endl;
+        return 1;
+    }
+    unsigned short port = argc > 1 ? (unsigned short)atoi(argv[1]) : DEFAULT_MATCH_PORT;
+
+    MatchServer server;
+    if (argc > 2)
+        server.setMatchInterval(atof(argv[2]) / 1000);
+    if (!server.listen(port))
+    {
+        cerr << "could not listen on port " << port << endl;
+        return 1;
+    }
+    running = &server;
+    signal(SIGINT, stopServer);
+    signal(SIGTERM, stopServer);
+    cout << "match server listening on port " << server.port() << endl;
+
+    // run() in slices so a status line can go out every STATS_INTERVAL
+    auto lastStats = chrono::steady_clock::now();
+    while (!server.stopRequested())
+    {
+        server.poll(1000);
+        if (chrono::steady_clock::now() - lastStats >= chrono::duration<double>(STATS_INTERVAL))
+        {
+            lastStats = chrono::steady_clock::now();
+            const SkillMatchmaker& matchmaker = server.getMatchmaker();
+            cout << server.connections() << " connected, " << server.waiting() << " waiting, "
+                 << matchmaker.matchesMade() << " matches, wait p50 " << fixed << setprecision(2)
+                 << matchmaker.waitPercentile(50) << " s, p99 " << matchmaker.waitPercentile(99) << " s" << endl;
+        }
+    }
+    running = nullptr;
+    return 0;
+}